@@ -0,0 +1,341 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+ * This code benchmarks the DCRTPoly operations offloaded to the UPMEM DPUs
+ * against the host. It sweeps the ring dimension, the number of towers and
+ * the number of DPUs, with the operands either resident on the DPUs or pushed
+ * and pulled back around every operation. The time of the transfers and of
+ * the launches, and the DPU cycles of the kernels, are reported as counters
+ * per iteration next to the wall time.
+ *
+ * Without UPMEM hardware the DPUs are emulated on the host (see PimBackend).
+ */
+
+#define _USE_MATH_DEFINES
+#include "vechelper.h"
+#include "lattice/lat-hal.h"
+#include "pim/PimPlanner.h"
+#include "pim/PimPool.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace lbcrypto;
+
+static std::vector<usint> ring_dim_log_args({10, 12, 14});
+static std::vector<usint> tow_args({2, 4, 8});
+// Ranks of the DPU partitions, whole ranks of 64 DPUs on the hardware
+static std::vector<usint> rank_args({1, 2, 4});
+
+static const usint DCRTBITS     = MAX_MODULUS_SIZE;
+static const size_t POLY_NUM    = 4;
+static const size_t POLY_NUM_M1 = (POLY_NUM - 1);
+
+// Keyed by the log of the ring dimension and the number of towers
+using DCRTKey = std::pair<usint, usint>;
+
+static DCRTPoly makeElement(std::shared_ptr<ILDCRTParams<BigInteger>> p, Format format) {
+    auto params   = std::make_shared<ILParams>(p->GetCyclotomicOrder(), p->GetModulus(), 1);
+    BigVector vec = makeVector<BigVector>(params->GetRingDimension(), params->GetModulus());
+
+    DCRTPoly::PolyLargeType bigE(params);
+    bigE.SetValues(vec, format);
+
+    DCRTPoly elem(bigE, p);
+    return elem;
+}
+
+static void GenerateDCRTParms(std::map<DCRTKey, std::shared_ptr<ILDCRTParams<BigInteger>>>& parmArray) {
+    for (usint l : ring_dim_log_args) {
+        for (usint t : tow_args) {
+            uint32_t m = (1 << (l + 1));
+
+            std::vector<NativeInteger> moduli(t);
+            std::vector<NativeInteger> roots(t);
+
+            NativeInteger firstInteger = FirstPrime<NativeInteger>(DCRTBITS, m);
+            moduli[0]                  = PreviousPrime<NativeInteger>(firstInteger, m);
+            roots[0]                   = RootOfUnity<NativeInteger>(m, moduli[0]);
+
+            for (size_t i = 1; i < t; i++) {
+                moduli[i] = PreviousPrime<NativeInteger>(moduli[i - 1], m);
+                roots[i]  = RootOfUnity<NativeInteger>(m, moduli[i]);
+            }
+
+            ChineseRemainderTransformFTT<NativeVector>().PreCompute(roots, m, moduli);
+
+            parmArray[{l, t}] = std::make_shared<ILDCRTParams<BigInteger>>(m, moduli, roots);
+        }
+    }
+}
+
+static void GenerateDCRTPolys(std::map<DCRTKey, std::shared_ptr<ILDCRTParams<BigInteger>>>& parmArray,
+                              std::map<DCRTKey, std::shared_ptr<std::vector<DCRTPoly>>>& polyArrayEval,
+                              std::map<DCRTKey, std::shared_ptr<std::vector<DCRTPoly>>>& polyArrayCoef) {
+    for (auto& pair : parmArray) {
+        std::vector<DCRTPoly> vecEval;
+        for (size_t i = 0; i < POLY_NUM; i++) {
+            vecEval.push_back(makeElement(pair.second, Format::EVALUATION));
+        }
+        polyArrayEval[pair.first] = std::make_shared<std::vector<DCRTPoly>>(std::move(vecEval));
+        std::vector<DCRTPoly> vecCoef;
+        for (size_t i = 0; i < POLY_NUM; i++) {
+            vecCoef.push_back(makeElement(pair.second, Format::COEFFICIENT));
+        }
+        polyArrayCoef[pair.first] = std::make_shared<std::vector<DCRTPoly>>(std::move(vecCoef));
+    }
+}
+
+std::map<DCRTKey, std::shared_ptr<ILDCRTParams<BigInteger>>> DCRTparms;
+
+std::map<DCRTKey, std::shared_ptr<std::vector<DCRTPoly>>> DCRTpolysEval;
+
+std::map<DCRTKey, std::shared_ptr<std::vector<DCRTPoly>>> DCRTpolysCoef;
+
+class Setup {
+public:
+    Setup() {
+        GenerateDCRTParms(DCRTparms);
+        std::cerr << "Generating polynomials for the benchmark..." << std::endl;
+        GenerateDCRTPolys(DCRTparms, DCRTpolysEval, DCRTpolysCoef);
+        std::cerr << "Polynomials for the benchmark are generated" << std::endl;
+    }
+} TestParameters;
+
+static void HostArguments(benchmark::internal::Benchmark* b) {
+    for (usint l : ring_dim_log_args) {
+        for (usint t : tow_args) {
+            b->ArgNames({"ringdim_log", "towers"})->Args({l, t});
+        }
+    }
+}
+
+// resident=1 keeps the operands on the DPUs, resident=0 pushes them and pulls
+// the result back around every operation
+static void PimArguments(benchmark::internal::Benchmark* b) {
+    for (usint l : ring_dim_log_args) {
+        for (usint t : tow_args) {
+            for (usint r : rank_args) {
+                for (usint resident : {1, 0}) {
+                    b->ArgNames({"ringdim_log", "towers", "ranks", "resident"})->Args({l, t, r, resident});
+                }
+            }
+        }
+    }
+}
+
+static DCRTPoly Add(const DCRTPoly& a, const DCRTPoly& b) {
+    return a.Plus(b);
+}
+
+static DCRTPoly Sub(const DCRTPoly& a, const DCRTPoly& b) {
+    return a.Minus(b);
+}
+
+static DCRTPoly Mul(const DCRTPoly& a, const DCRTPoly& b) {
+    return a.Times(b);
+}
+
+// The NTT from the coefficient format, the inverse NTT from the evaluation one
+static DCRTPoly SwitchFormat(const DCRTPoly& a, const DCRTPoly&) {
+    DCRTPoly c = a;
+    c.SwitchFormat();
+    return c;
+}
+
+static void RunOnHost(benchmark::State& state, Format format, DCRTPoly (*op)(const DCRTPoly&, const DCRTPoly&)) {
+    DCRTKey key(state.range(0), state.range(1));
+    std::shared_ptr<std::vector<DCRTPoly>> polys =
+        (format == Format::EVALUATION ? DCRTpolysEval : DCRTpolysCoef)[key];
+    DCRTPoly *a, *b, c;
+    size_t i = 0;
+
+    while (state.KeepRunning()) {
+        a = &(polys->operator[](i));
+        b = &(polys->operator[](i + 1));
+        i += 2;
+        i = i & POLY_NUM_M1;
+        c = op(*a, *b);
+    }
+}
+
+// Splits the time of the iterations between the transfers and the launches,
+// from the telemetry of the partition
+static void ReportPim(benchmark::State& state, PimManager* pim) {
+    PimStats stats  = pim->get_stats();
+    uint64_t cycles = 0;
+    for (const PimKernelStats& k : stats.kernels)
+        cycles += k.max_cycles;
+
+    const PimCounters& c = stats.counters;
+    state.SetLabel(stats.backend);
+    state.counters["dpus"]        = stats.nr_dpus;
+    state.counters["to_pim_us"]   = benchmark::Counter(c.to_pim_ns / 1e3, benchmark::Counter::kAvgIterations);
+    state.counters["from_pim_us"] = benchmark::Counter(c.from_pim_ns / 1e3, benchmark::Counter::kAvgIterations);
+    state.counters["launch_us"]   = benchmark::Counter(c.launch_ns / 1e3, benchmark::Counter::kAvgIterations);
+    state.counters["dpu_cycles"]  = benchmark::Counter(cycles, benchmark::Counter::kAvgIterations);
+    state.counters["xfer_bytes"] =
+        benchmark::Counter(c.bytes_to_pim + c.bytes_from_pim, benchmark::Counter::kAvgIterations);
+}
+
+static void RunOnPim(benchmark::State& state, Format format, DCRTPoly (*op)(const DCRTPoly&, const DCRTPoly&)) {
+    DCRTKey key(state.range(0), state.range(1));
+    bool resident = state.range(3) != 0;
+
+    PimLease pim;
+    try {
+        pim = PimPool::get().lease(state.range(2));
+    }
+    catch (const std::runtime_error& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    PimBinding binding(pim.get());
+    pim->set_timing(true);
+
+    // Copies of the operands, materialized on the leased partition and
+    // destroyed before the lease
+    std::vector<DCRTPoly> polys = *(format == Format::EVALUATION ? DCRTpolysEval : DCRTpolysCoef)[key];
+    if (resident) {
+        for (auto& p : polys)
+            p.PinToPim();
+    }
+    DCRTPoly *a, *b, c;
+    size_t i = 0;
+
+    pim->reset_stats();
+    while (state.KeepRunning()) {
+        a = &polys[i];
+        b = &polys[i + 1];
+        i += 2;
+        i = i & POLY_NUM_M1;
+        if (resident) {
+            c = op(*a, *b);
+            pim->sync();
+        }
+        else {
+            a->PinToPim();
+            b->PinToPim();
+            c = op(*a, *b);
+            c.UnpinFromPim();
+            a->UnpinFromPim();
+            b->UnpinFromPim();
+        }
+    }
+    ReportPim(state, pim.get());
+}
+
+static void DCRT_add(benchmark::State& state) {  // benchmark
+    RunOnHost(state, Format::EVALUATION, Add);
+}
+
+BENCHMARK(DCRT_add)->Unit(benchmark::kMicrosecond)->Apply(HostArguments);
+
+static void PIM_add(benchmark::State& state) {  // benchmark
+    RunOnPim(state, Format::EVALUATION, Add);
+}
+
+BENCHMARK(PIM_add)->Unit(benchmark::kMicrosecond)->Apply(PimArguments);
+
+static void DCRT_sub(benchmark::State& state) {  // benchmark
+    RunOnHost(state, Format::EVALUATION, Sub);
+}
+
+BENCHMARK(DCRT_sub)->Unit(benchmark::kMicrosecond)->Apply(HostArguments);
+
+static void PIM_sub(benchmark::State& state) {  // benchmark
+    RunOnPim(state, Format::EVALUATION, Sub);
+}
+
+BENCHMARK(PIM_sub)->Unit(benchmark::kMicrosecond)->Apply(PimArguments);
+
+static void DCRT_mul(benchmark::State& state) {
+    RunOnHost(state, Format::EVALUATION, Mul);
+}
+
+BENCHMARK(DCRT_mul)->Unit(benchmark::kMicrosecond)->Apply(HostArguments);
+
+static void PIM_mul(benchmark::State& state) {
+    RunOnPim(state, Format::EVALUATION, Mul);
+}
+
+BENCHMARK(PIM_mul)->Unit(benchmark::kMicrosecond)->Apply(PimArguments);
+
+static void DCRT_ntt(benchmark::State& state) {
+    RunOnHost(state, Format::COEFFICIENT, SwitchFormat);
+}
+
+BENCHMARK(DCRT_ntt)->Unit(benchmark::kMicrosecond)->Apply(HostArguments);
+
+static void PIM_ntt(benchmark::State& state) {
+    RunOnPim(state, Format::COEFFICIENT, SwitchFormat);
+}
+
+BENCHMARK(PIM_ntt)->Unit(benchmark::kMicrosecond)->Apply(PimArguments);
+
+static void DCRT_intt(benchmark::State& state) {
+    RunOnHost(state, Format::EVALUATION, SwitchFormat);
+}
+
+BENCHMARK(DCRT_intt)->Unit(benchmark::kMicrosecond)->Apply(HostArguments);
+
+static void PIM_intt(benchmark::State& state) {
+    RunOnPim(state, Format::EVALUATION, SwitchFormat);
+}
+
+BENCHMARK(PIM_intt)->Unit(benchmark::kMicrosecond)->Apply(PimArguments);
+
+int main(int argc, char** argv) {
+    // The host baseline stays on the host whatever the offload planner says
+    PimPlanner::get().enable(false);
+    // Fall back to the emulator when no DPU can be allocated
+    if (std::getenv("PIM_BACKEND") == nullptr) {
+        try {
+            PimPool::get().lease(rank_args[0]);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "No DPUs available (" << e.what() << "), emulating them on the host" << std::endl;
+            setenv("PIM_BACKEND", "emulator", 1);
+        }
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
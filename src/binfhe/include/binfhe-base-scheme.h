@@ -114,6 +114,23 @@ public:
     LWECiphertext EvalBinGate(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate, const RingGSWBTKey& EK,
                               const std::vector<LWECiphertext>& ctvector) const;
 
+    /**
+   * Evaluates a binary gate on pairs of ciphertexts, ct1[i] with ct2[i]. With the CGGI accumulator
+   * and Q below 2^32 the blind rotations run on the DPUs of the current PIM set, one bootstrap per
+   * DPU; the bootstrapping key stays in their MRAM across calls and only the LWE ciphertexts move.
+   * Otherwise the pairs are evaluated one by one on the host.
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param gate the gate; can be AND, OR, NAND, NOR, XOR, or XNOR
+   * @param EK a shared pointer to the bootstrapping keys
+   * @param ct1 first ciphertexts
+   * @param ct2 second ciphertexts, as many as ct1
+   * @return the resulting ciphertexts
+   */
+    std::vector<LWECiphertext> EvalBinGate(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
+                                           const RingGSWBTKey& EK, const std::vector<LWECiphertext>& ct1,
+                                           const std::vector<LWECiphertext>& ct2) const;
+
     /**
    * Evaluates NOT gate
    *
@@ -201,6 +218,20 @@ private:
     RLWECiphertext BootstrapGateCore(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
                                      ConstRingGSWACCKey& ek, ConstLWECiphertext& ct) const;
 
+    /**
+   * Core bootstrapping operation of a batch on the DPUs, followed by the extraction of EvalBinGate
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param gate the gate; can be AND, OR, NAND, NOR, XOR_FAST, or XNOR_FAST
+   * @param ek a shared pointer to the bootstrapping keys
+   * @param ct input ciphertexts
+   * @param ctExt the extracted ciphertexts modulo Q, under the original secret key
+   * @return false if the accumulator or the parameters do not fit the DPU kernel, nothing ran then
+   */
+    bool BootstrapGateCoreOnPim(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
+                                ConstRingGSWACCKey& ek, const std::vector<LWECiphertext>& ct,
+                                std::vector<LWECiphertext>& ctExt) const;
+
     // Arbitrary function evaluation purposes
 
     /**
@@ -313,6 +313,19 @@ public:
    */
     LWECiphertext EvalBinGate(BINGATE gate, const std::vector<LWECiphertext>& ctvector) const;
 
+    /**
+   * Evaluates a binary gate on pairs of ciphertexts (calls bootstrapping as a subroutine). With the
+   * GINX method and Q below 2^32 the bootstrappings of the batch run on the DPUs, see
+   * BinFHEScheme::EvalBinGate
+   *
+   * @param gate the gate; can be AND, OR, NAND, NOR, XOR, or XNOR
+   * @param ct1 first ciphertexts
+   * @param ct2 second ciphertexts, as many as ct1
+   * @return the resulting ciphertexts, the gate of ct1[i] and ct2[i] at i
+   */
+    std::vector<LWECiphertext> EvalBinGate(BINGATE gate, const std::vector<LWECiphertext>& ct1,
+                                           const std::vector<LWECiphertext>& ct2) const;
+
     /**
    * Bootstraps a ciphertext (without peforming any operation)
    *
@@ -31,7 +31,11 @@
 
 #include "binfhe-base-scheme.h"
 
+#include "pim/PimBlindRotate.h"
+#include "pim/PimManager.h"
+
 #include <string>
+#include <unordered_map>
 
 namespace lbcrypto {
 
@@ -122,6 +126,74 @@ LWECiphertext BinFHEScheme::EvalBinGate(const std::shared_ptr<BinFHECryptoParams
     return LWEscheme->ModSwitch(ct1->GetModulus(), ctKS);
 }
 
+// Full evaluation of a batch of gates, the blind rotations on the DPUs when they can run there
+std::vector<LWECiphertext> BinFHEScheme::EvalBinGate(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
+                                                     const RingGSWBTKey& EK, const std::vector<LWECiphertext>& ct1,
+                                                     const std::vector<LWECiphertext>& ct2) const {
+    if (ct1.size() != ct2.size())
+        OPENFHE_THROW(config_error, "Input vectors should have the same length");
+    for (size_t i = 0; i < ct1.size(); ++i) {
+        if (ct1[i] == ct2[i])
+            OPENFHE_THROW(config_error, "Input ciphertexts should be independant");
+    }
+
+    // XOR/XNOR as for a single pair, the two AND gates of every pair go in the same batch
+    if ((gate == XOR) || (gate == XNOR)) {
+        size_t size = ct1.size();
+        std::vector<LWECiphertext> lhs(ct1), rhs;
+        for (size_t i = 0; i < size; ++i)
+            rhs.push_back(EvalNOT(params, ct2[i]));
+        for (size_t i = 0; i < size; ++i) {
+            lhs.push_back(EvalNOT(params, ct1[i]));
+            rhs.push_back(ct2[i]);
+        }
+        auto ctAND = EvalBinGate(params, AND, EK, lhs, rhs);
+        std::vector<LWECiphertext> ctAND1(ctAND.begin(), ctAND.begin() + size);
+        std::vector<LWECiphertext> ctAND2(ctAND.begin() + size, ctAND.end());
+        auto ctOR = EvalBinGate(params, OR, EK, ctAND1, ctAND2);
+
+        // NOT is free so there is not cost to do it an extra time for XNOR
+        if (gate == XNOR) {
+            for (auto& ct : ctOR)
+                ct = EvalNOT(params, ct);
+        }
+        return ctOR;
+    }
+
+    std::vector<LWECiphertext> ctprep;
+    ctprep.reserve(ct1.size());
+    for (size_t i = 0; i < ct1.size(); ++i) {
+        ctprep.push_back(std::make_shared<LWECiphertextImpl>(*ct1[i]));
+        if ((gate == XOR_FAST) || (gate == XNOR_FAST)) {
+            LWEscheme->EvalSubEq(ctprep[i], ct2[i]);
+            LWEscheme->EvalAddEq(ctprep[i], ctprep[i]);
+        }
+        else {
+            LWEscheme->EvalAddEq(ctprep[i], ct2[i]);
+        }
+    }
+
+    std::vector<LWECiphertext> ctExt;
+    std::vector<LWECiphertext> result;
+    result.reserve(ct1.size());
+    if (!BootstrapGateCoreOnPim(params, gate, EK.BSkey, ctprep, ctExt)) {
+        for (size_t i = 0; i < ct1.size(); ++i)
+            result.push_back(EvalBinGate(params, gate, EK, ct1[i], ct2[i]));
+        return result;
+    }
+
+    const auto& LWEParams = params->GetLWEParams();
+    for (size_t i = 0; i < ct1.size(); ++i) {
+        // Modulus switching to a middle step Q'
+        auto ctMS = LWEscheme->ModSwitch(LWEParams->GetqKS(), ctExt[i]);
+        // Key switching
+        auto ctKS = LWEscheme->KeySwitch(LWEParams, EK.KSkey, ctMS);
+        // Modulus switching
+        result.push_back(LWEscheme->ModSwitch(ct1[i]->GetModulus(), ctKS));
+    }
+    return result;
+}
+
 // Full evaluation as described in https://eprint.iacr.org/2020/086
 LWECiphertext BinFHEScheme::EvalBinGate(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
                                         const RingGSWBTKey& EK, const std::vector<LWECiphertext>& ctvector) const {
@@ -545,6 +617,89 @@ RLWECiphertext BinFHEScheme::BootstrapGateCore(const std::shared_ptr<BinFHECrypt
     return acc;
 }
 
+// The blind rotations of BootstrapGateCore with RingGSWAccumulatorCGGI::EvalAcc, one bootstrap per
+// DPU, and the extraction of EvalBinGate. The key image the DPUs keep has the rows of the key as
+// 32-bit words and the monomials X^e - 1 as a table of their values at the first slot, from which
+// the DPUs evaluate them at every slot.
+bool BinFHEScheme::BootstrapGateCoreOnPim(const std::shared_ptr<BinFHECryptoParams>& params, BINGATE gate,
+                                          ConstRingGSWACCKey& ek, const std::vector<LWECiphertext>& ct,
+                                          std::vector<LWECiphertext>& ctExt) const {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        return false;
+    if (ek == nullptr || ct.empty() || std::dynamic_pointer_cast<RingGSWAccumulatorCGGI>(ACCscheme) == nullptr)
+        return false;
+
+    auto& RGSWParams = params->GetRingGSWParams();
+    NativeInteger Q  = RGSWParams->GetQ();
+    uint32_t N       = RGSWParams->GetN();
+    uint32_t M       = 2 * N;
+    if (Q.GetMSB() > 32)
+        return false;
+
+    PimBootKey key;
+    key.modulus = Q.ConvertToInt();
+    key.N       = N;
+    key.n       = (*ek)[0][0].size();
+    key.digits  = (RGSWParams->GetDigitsG() - 1) << 1;
+    key.g_bits  = __builtin_ctz(RGSWParams->GetBaseG());
+    key.ntt     = ChineseRemainderTransformFTT<NativeVector>::PimTables(Q, N);
+
+    // X at the slot j is X^e_j at the first slot, e_j is found in the table of the monomials
+    std::unordered_map<uint64_t, uint32_t> logs;
+    for (uint32_t e = 0; e < M; ++e) {
+        key.monomials.push_back(RGSWParams->GetMonomial(e)[0].ConvertToInt());
+        logs[key.monomials.back()] = e;
+    }
+    const NativePoly& x = RGSWParams->GetMonomial(1);
+    for (uint32_t j = 0; j < N; ++j) {
+        auto it = logs.find(x[j].ConvertToInt());
+        if (it == logs.end())
+            return false;
+        key.exponents.push_back(it->second);
+    }
+    key.rows = [&ek, &key](uint32_t i, uint32_t* rows) {
+        for (uint32_t secret = 0; secret < 2; ++secret) {
+            const auto& ev = (*ek)[0][secret][i]->GetElements();
+            for (uint32_t d = 0; d < key.digits; ++d) {
+                for (uint32_t c = 0; c < 2; ++c) {
+                    for (uint32_t j = 0; j < key.N; ++j)
+                        rows[j] = ev[d][c][j].ConvertToInt<uint32_t>();
+                    rows += key.N;
+                }
+            }
+        }
+    };
+
+    std::vector<PimGateInput> inputs(ct.size());
+    for (size_t k = 0; k < ct.size(); ++k) {
+        NativeInteger Q2p    = Q / NativeInteger(2 * ct[k]->GetptModulus()) + 1;
+        NativeInteger q      = ct[k]->GetModulus();
+        NativeInteger q1     = RGSWParams->GetGateConst()[static_cast<size_t>(gate)];
+        NativeInteger MbyMod = NativeInteger(M) / q;
+        const NativeVector& a = ct[k]->GetA();
+        PimGateInput& in      = inputs[k];
+        for (size_t i = 0; i < a.GetLength(); ++i)
+            in.index.push_back((NativeInteger(0).ModSubFast(a[i], q) * MbyMod).ConvertToInt<uint32_t>());
+        in.b   = ct[k]->GetB().ConvertToInt();
+        in.q   = q.ConvertToInt();
+        in.q1  = q1.ConvertToInt();
+        in.q2  = q1.ModAddFast(NativeInteger(q.ConvertToInt() >> 1), q).ConvertToInt();
+        in.q2p = Q2p.ConvertToInt();
+    }
+
+    std::vector<PimGateOutput> outputs;
+    if (!pim_blind_rotate(*PimManager::current(), ek, key, inputs, outputs))
+        return false;
+    ctExt.clear();
+    for (auto& out : outputs) {
+        NativeVector a(N, Q);
+        for (uint32_t j = 0; j < N; ++j)
+            a[j] = out.a[j];
+        ctExt.push_back(std::make_shared<LWECiphertextImpl>(std::move(a), NativeInteger(out.b)));
+    }
+    return true;
+}
+
 // Functions below are for large-precision sign evaluation,
 // flooring, homomorphic digit decomposition, and arbitrary
 // funciton evaluation, from https://eprint.iacr.org/2021/1337
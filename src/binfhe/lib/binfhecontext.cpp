@@ -306,6 +306,11 @@ LWECiphertext BinFHEContext::EvalBinGate(const BINGATE gate, const std::vector<L
     return m_binfhescheme->EvalBinGate(m_params, gate, m_BTKey, ctvector);
 }
 
+std::vector<LWECiphertext> BinFHEContext::EvalBinGate(const BINGATE gate, const std::vector<LWECiphertext>& ct1,
+                                                      const std::vector<LWECiphertext>& ct2) const {
+    return m_binfhescheme->EvalBinGate(m_params, gate, m_BTKey, ct1, ct2);
+}
+
 LWECiphertext BinFHEContext::Bootstrap(ConstLWECiphertext& ct) const {
     return m_binfhescheme->Bootstrap(m_params, m_BTKey, ct);
 }
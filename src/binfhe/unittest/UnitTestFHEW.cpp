@@ -34,6 +34,7 @@
  */
 
 #include "binfhecontext.h"
+#include "pim/PimManager.h"
 #include "utils/demangle.h"
 
 #include "gtest/gtest.h"
@@ -597,3 +598,45 @@ TEST_P(UTGENERAL_FHEW, BINFHE) {
 }
 
 INSTANTIATE_TEST_SUITE_P(UnitTests, UTGENERAL_FHEW, ::testing::ValuesIn(testCasesUTGENERAL_FHEW), testName);
+
+// The batch of gates runs its bootstrappings on the DPUs (on the emulator without the UPMEM SDK), one per
+// DPU and launch: a batch larger than the DPU set takes several launches
+TEST(UnitTestFHEW, BATCH_GATES_GINX) {
+    auto cc = BinFHEContext();
+    cc.GenerateBinFHEContext(TOY, GINX);
+
+    auto sk = cc.KeyGen();
+    cc.BTKeyGen(sk);
+
+    PimManager* pim    = PimManager::current();
+    uint32_t dpus      = pim->getNumDpus();
+    unsigned int count = dpus + 3;
+    std::vector<LWECiphertext> ct1, ct2;
+    for (unsigned int i = 0; i < count; ++i) {
+        ct1.push_back(cc.Encrypt(sk, i & 1));
+        ct2.push_back(cc.Encrypt(sk, (i >> 1) & 1));
+    }
+
+    for (BINGATE gate : {AND, OR, NAND, NOR, XOR, XNOR}) {
+        pim->reset_stats();
+        auto result = cc.EvalBinGate(gate, ct1, ct2);
+        // XOR and XNOR bootstrap the two AND gates of every pair in one batch, then an OR gate
+        uint64_t launches = DIVROUNDUP(count, dpus);
+        if (gate == XOR || gate == XNOR)
+            launches += DIVROUNDUP(2 * count, dpus);
+        EXPECT_EQ(launches, pim->get_stats().kernels[OP_BLIND_ROTATE].launches) << "Failed batch gate " << gate;
+        ASSERT_EQ(ct1.size(), result.size());
+        for (unsigned int i = 0; i < count; ++i) {
+            bool a = i & 1, b = (i >> 1) & 1;
+            bool expected = gate == AND  ? a && b :
+                            gate == OR   ? a || b :
+                            gate == NAND ? !(a && b) :
+                            gate == NOR  ? !(a || b) :
+                            gate == XOR  ? a != b :
+                                           a == b;
+            LWEPlaintext res;
+            cc.Decrypt(sk, result[i], &res);
+            EXPECT_EQ(LWEPlaintext(expected), res) << "Failed batch gate " << gate << " on " << a << ", " << b;
+        }
+    }
+}
@@ -346,6 +346,8 @@ std::vector<DCRTPolyImpl<VecType>> DCRTPolyImpl<VecType>::PowersOfBase(usint bas
     return result;
 }
 
+// The towers of a pinned polynomial are permuted on the DPUs, see
+// PolyImpl::AutomorphismOnPim
 template <typename VecType>
 DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::AutomorphismTransform(uint32_t i) const {
     DCRTPolyImpl<VecType> result;
@@ -626,6 +628,48 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Times(const std::vector<NativeInteg
     return tmp;
 }
 
+template <typename VecType>
+bool DCRTPolyImpl<VecType>::LinearWSumOnPim(const std::vector<const DCRTPolyImpl*>& in,
+                                            const std::vector<std::vector<Integer>>& weights,
+                                            DCRTPolyImpl& result) {
+    if (in.empty() || in.size() != weights.size())
+        return false;
+    size_t towers{in[0]->m_vectors.size()};
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (!in[i]->IsPinned() || in[i] == &result || in[i]->m_format != in[0]->m_format ||
+            in[i]->m_vectors.size() != towers || weights[i].size() < towers)
+            return false;
+    }
+
+    DCRTPolyImpl<VecType> ans(in[0]->m_params, in[0]->m_format, true);
+    std::vector<const PolyType*> terms(in.size());
+    std::vector<NativeInteger> w(in.size());
+    for (size_t t = 0; t < towers; ++t) {
+        for (size_t i = 0; i < in.size(); ++i) {
+            terms[i] = &in[i]->m_vectors[t];
+            w[i]     = NativeInteger(weights[i][t]);
+        }
+        if (!PolyType::MacOnPim(terms, w, ans.m_vectors[t]))
+            return false;
+    }
+    result = std::move(ans);
+    return true;
+}
+
+template <typename VecType>
+bool DCRTPolyImpl<VecType>::UniformOnPim(const PimUniformSeed& seed, uint32_t id) {
+    std::vector<uint64_t> streams(m_vectors.size());
+    for (size_t i = 0; i < streams.size(); ++i)
+        streams[i] = (static_cast<uint64_t>(id) << 32) + i;
+    return PolyType::UniformOnPim(seed, m_vectors, streams);
+}
+
+template <typename VecType>
+void DCRTPolyImpl<VecType>::UniformFromSeed(const PimUniformSeed& seed, uint32_t id) {
+    for (size_t i = 0; i < m_vectors.size(); ++i)
+        m_vectors[i].UniformFromSeed(seed, (static_cast<uint64_t>(id) << 32) + i);
+}
+
 template <typename VecType>
 DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::TimesNoCheck(const std::vector<NativeInteger>& rhs) const {
     size_t vecSize = m_vectors.size() < rhs.size() ? m_vectors.size() : rhs.size();
@@ -674,6 +718,7 @@ void DCRTPolyImpl<VecType>::SetValuesModSwitch(const DCRTPolyImpl& element, cons
 
     auto input{element.GetElementAtIndex(0)};
     input.SetFormat(Format::COEFFICIENT);
+    input.SyncToHost();
 
     size_t size{m_vectors.size()};
     size_t N_elem(element.m_params->GetRingDimension());
@@ -753,6 +798,16 @@ void DCRTPolyImpl<VecType>::DropLastElementAndScale(const std::vector<NativeInte
     this->DropLastElement();
     size_t size{m_vectors.size()};
 
+    // Pinned towers are rescaled by the DPU holding them, which lifts the last
+    // tower to their moduli
+    if (IsPinned() && PolyType::RescaleOnPim(lastPoly, m_vectors, QlQlInvModqlDivqlModq, qlInvModq)) {
+        if (m_format == Format::COEFFICIENT) {
+            for (auto& v : m_vectors)
+                v.SwitchFormat();
+        }
+        return;
+    }
+
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
     for (size_t i = 0; i < size; ++i) {
         auto tmp = lastPoly;
@@ -800,6 +855,18 @@ void DCRTPolyImpl<VecType>::ModReduce(const NativeInteger& t, const std::vector<
     this->DropLastElement();
     size_t size{m_vectors.size()};
 
+    // Pinned towers are reduced on the DPUs, (x_i + t delta) q_l^-1 taken as
+    // x_i q_l^-1 + delta [t q_l^-1]_{q_i}
+    if (IsPinned()) {
+        std::vector<NativeInteger> scale(size);
+        for (size_t i = 0; i < size; ++i) {
+            const auto& qi{m_vectors[i].GetModulus()};
+            scale[i] = t.Mod(qi).ModMul(qlInvModq[i], qi);
+        }
+        if (PolyType::RescaleOnPim(delta, m_vectors, scale, qlInvModq))
+            return;
+    }
+
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
     for (size_t i = 0; i < size; ++i) {
         auto tmp{delta};
@@ -883,6 +950,8 @@ typename DCRTPolyImpl<VecType>::PolyLargeType DCRTPolyImpl<VecType>::CRTInterpol
         }
         vecs = std::move(&coeffVecs);
     }
+    for (const auto& v : *vecs)
+        v.SyncToHost();
 
     // Precompute the Barrett mu parameter
     Integer mu = bigModulus.ComputeMu();
@@ -949,6 +1018,8 @@ typename DCRTPolyImpl<VecType>::PolyLargeType DCRTPolyImpl<VecType>::CRTInterpol
         }
         vecs = &coeffVecs;
     }
+    for (const auto& v : *vecs)
+        v.SyncToHost();
 
     // Precompute the Barrett mu parameter
     Integer mu = bigModulus.ComputeMu();
@@ -1015,6 +1086,7 @@ template <typename VecType>
 void DCRTPolyImpl<VecType>::TimesQovert(const std::shared_ptr<Params>& paramsQ,
                                         const std::vector<NativeInteger>& tInvModq, const NativeInteger& t,
                                         const NativeInteger& NegQModt, const NativeInteger& NegQModtPrecon) {
+    PrepareHostWrite();
     if (tInvModq.size() < m_vectors.size())
         OPENFHE_THROW(math_error, "Sizes of vectors do not match.");
     uint32_t size(m_vectors.size());
@@ -1042,6 +1114,27 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxSwitchCRTBasis(
     usint sizeQ   = (m_vectors.size() > paramsQ->GetParams().size()) ? paramsQ->GetParams().size() : m_vectors.size();
     usint sizeP   = ans.m_vectors.size();
 
+    // Pinned towers are converted on the DPUs, each of them converting its
+    // slice of coefficients of all the towers
+    if (IsPinned()) {
+        PimBaseConvTables tables;
+        for (usint i = 0; i < sizeQ; i++) {
+            tables.q.push_back(m_vectors[i].GetModulus().ConvertToInt());
+            tables.q_hat_inv.push_back(QHatInvModq[i].ConvertToInt());
+            tables.q_hat_inv_precon.push_back(QHatInvModqPrecon[i].ConvertToInt());
+            for (usint j = 0; j < sizeP; j++)
+                tables.q_hat_modp.push_back(QHatModp[i][j].ConvertToInt());
+        }
+        for (usint j = 0; j < sizeP; j++) {
+            tables.p.push_back(ans.m_vectors[j].GetModulus().ConvertToInt());
+            tables.p_mu.push_back(modpBarrettMu[j]);
+        }
+        if (PolyType::BaseConvOnPim(m_vectors, sizeQ, ans.m_vectors, tables))
+            return ans;
+    }
+    // Pulled once here, the loop below reads the towers element-wise
+    SyncToHost();
+
     #pragma omp parallel for
     for (usint ri = 0; ri < ringDim; ri++) {
         std::vector<DoubleNativeInt> sum(sizeP);
@@ -1154,6 +1247,7 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxModDown(
     }
     partP.OverrideFormat(Format::COEFFICIENT);
 
+    // Copies of pinned towers stay pinned, partP is then converted on the DPUs
     DCRTPolyImpl<VecType> partPSwitchedToQ =
         partP.ApproxSwitchCRTBasis(paramsP, paramsQ, PHatInvModp, PHatInvModpPrecon, PHatModq, modqBarrettMu);
 
@@ -1182,6 +1276,7 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::SwitchCRTBasis(const std::shared_pt
                                                             const std::vector<std::vector<NativeInteger>>& alphaQModp,
                                                             const std::vector<DoubleNativeInt>& modpBarrettMu,
                                                             const std::vector<double>& qInv) const {
+    SyncToHost();
 #if defined(HAVE_INT128) && NATIVEINT == 64
     DCRTPolyImpl<VecType> ans(paramsP, m_format, true);
     usint ringDim = m_params->GetRingDimension();
@@ -1411,6 +1506,7 @@ void DCRTPolyImpl<VecType>::ExpandCRTBasisReverseOrder(
 
 template <typename VecType>
 void DCRTPolyImpl<VecType>::FastExpandCRTBasisPloverQ(const Precomputations& precomputed) {
+    SyncToHost();
     usint ringDim = m_params->GetRingDimension();
     size_t sizeQ  = m_vectors.size();
     DCRTPolyImpl<VecType> partPl(precomputed.paramsPl, m_format, true);
@@ -1514,6 +1610,7 @@ template <typename VecType>
 void DCRTPolyImpl<VecType>::ExpandCRTBasisQlHat(const std::shared_ptr<Params>& paramsQ,
                                                 const std::vector<NativeInteger>& QlHatModq,
                                                 const std::vector<NativeInteger>& QlHatModqPrecon, const usint sizeQ) {
+    PrepareHostWrite();
     size_t sizeQl(m_vectors.size());
     usint ringDim(m_params->GetRingDimension());
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(sizeQl))
@@ -1540,6 +1637,7 @@ typename DCRTPolyImpl<VecType>::PolyType DCRTPolyImpl<VecType>::ScaleAndRound(
     const std::vector<NativeInteger>& tQHatInvModqBDivqModt,
     const std::vector<NativeInteger>& tQHatInvModqBDivqModtPrecon, const std::vector<double>& tQHatInvModqDivqFrac,
     const std::vector<double>& tQHatInvModqDivqBFrac) const {
+    SyncToHost();
     usint ringDim = m_params->GetRingDimension();
     usint sizeQ   = m_vectors.size();
 
@@ -1817,6 +1915,7 @@ template <typename VecType>
 DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxScaleAndRound(
     const std::shared_ptr<Params>& paramsP, const std::vector<std::vector<NativeInteger>>& tPSHatInvModsDivsModp,
     const std::vector<DoubleNativeInt>& modpBarretMu) const {
+    SyncToHost();
     DCRTPolyImpl<VecType> ans(paramsP, m_format, true);
     usint ringDim = m_params->GetRingDimension();
     size_t sizeQP = m_vectors.size();
@@ -1876,6 +1975,7 @@ template <typename VecType>
 DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ScaleAndRound(
     const std::shared_ptr<Params>& paramsOutput, const std::vector<std::vector<NativeInteger>>& tOSHatInvModsDivsModo,
     const std::vector<double>& tOSHatInvModsDivsFrac, const std::vector<DoubleNativeInt>& modoBarretMu) const {
+    SyncToHost();
     if constexpr (NATIVEINT == 32)
         OPENFHE_THROW(math_error, "Use of ScaleAndRound with NATIVEINT == 32 may lead to overflow");
 
@@ -2007,6 +2107,7 @@ typename DCRTPolyImpl<VecType>::PolyType DCRTPolyImpl<VecType>::ScaleAndRound(
     const std::vector<NativeInteger>& tgammaQHatModq, const std::vector<NativeInteger>& tgammaQHatModqPrecon,
     const std::vector<NativeInteger>& negInvqModtgamma,
     const std::vector<NativeInteger>& negInvqModtgammaPrecon) const {
+    SyncToHost();
     usint n     = m_params->GetRingDimension();
     usint sizeQ = m_vectors.size();
 
@@ -2051,6 +2152,7 @@ typename DCRTPolyImpl<VecType>::PolyType DCRTPolyImpl<VecType>::ScaleAndRound(
 template <typename VecType>
 void DCRTPolyImpl<VecType>::ScaleAndRoundPOverQ(const std::shared_ptr<Params>& paramsQ,
                                                 const std::vector<NativeInteger>& pInvModq) {
+    PrepareHostWrite();
     const usint sizeQ   = m_vectors.size() - 1;
     const usint ringDim = m_params->GetRingDimension();
     for (usint i = 0; i < sizeQ; i++) {
@@ -2074,6 +2176,7 @@ void DCRTPolyImpl<VecType>::FastBaseConvqToBskMontgomery(
     const std::vector<NativeInteger>& QModbsk, const std::vector<NativeInteger>& QModbskPrecon,
     const uint64_t& negQInvModmtilde, const std::vector<NativeInteger>& mtildeInvModbsk,
     const std::vector<NativeInteger>& mtildeInvModbskPrecon) {
+    PrepareHostWrite();
     // Input: dcrtpoly in basis Q
     // Output: dcrtpoly in base QBsk = {B U msk}
 
@@ -2215,6 +2318,7 @@ void DCRTPolyImpl<VecType>::FastRNSFloorq(
     const std::vector<NativeInteger>& tQHatInvModqPrecon, const std::vector<std::vector<NativeInteger>>& QHatModbsk,
     const std::vector<std::vector<NativeInteger>>& qInvModbsk, const std::vector<NativeInteger>& tQInvModbsk,
     const std::vector<NativeInteger>& tQInvModbskPrecon) {
+    PrepareHostWrite();
     // Input: poly in basis {q U Bsk}
     // Output: approximateFloor(t/q*poly) in basis Bsk
 
@@ -2313,6 +2417,7 @@ void DCRTPolyImpl<VecType>::FastBaseConvSK(
     const std::vector<NativeInteger>& BHatModmsk, const NativeInteger& BInvModmsk,
     const NativeInteger& BInvModmskPrecon, const std::vector<std::vector<NativeInteger>>& BHatModq,
     const std::vector<NativeInteger>& BModq, const std::vector<NativeInteger>& BModqPrecon) {
+    PrepareHostWrite();
     // Input: poly in basis Bsk
     // Output: poly in basis q
 
@@ -404,29 +404,91 @@ public:
         m_vectors[index] = std::move(element);
     }
 
-    /*  The functions setOperation and getOperation 
-        are function accessing my variable operations
-    */
-    void SetPim(std::shared_ptr<PimManager> newPim) {
-        pim = newPim;
+    /**
+   * Keeps every tower resident on the DPUs, all of them on the same DPU. The
+   * tower-wise arithmetic, the base conversions and the rescales then run
+   * there and the towers only come back to the host when they are read.
+   */
+    void PinToPim() {
+        for (size_t i = 0; i < m_vectors.size(); ++i) {
+            if (i == 0)
+                m_vectors[0].PinToPim();
+            else
+                m_vectors[i].PinToPim(m_vectors[0]);
+        }
+    }
+
+    /**
+   * Pins the towers on the DPU holding next, e.g. the elements of a
+   * ciphertext together.
+   */
+    void PinToPim(const DCRTPolyImpl& next) {
+        if (next.m_vectors.empty())
+            return PinToPim();
+        for (auto& v : m_vectors)
+            v.PinToPim(next.m_vectors[0]);
     }
 
-    std::shared_ptr<PimManager> GetPim() {
-        return pim;
+    void UnpinFromPim() {
+        for (auto& v : m_vectors)
+            v.UnpinFromPim();
     }
 
+    bool IsPinned() const {
+        return !m_vectors.empty() && m_vectors[0].IsPinned();
+    }
+
+    /**
+   * Bring the towers up to date on the host before reading, respectively
+   * writing, their coefficients element-wise (see PolyImpl::SyncToHost). The
+   * operations of DCRTPolyImpl call them once, ahead of their parallel loops.
+   */
+    void SyncToHost() const {
+        for (const auto& v : m_vectors)
+            v.SyncToHost();
+    }
+
+    void PrepareHostWrite() {
+        for (auto& v : m_vectors)
+            v.PrepareHostWrite();
+    }
+
+    /**
+   * Weighted sum of pinned polynomials on the DPUs, tower-wise
+   * sum_i in[i] weights[i] with a fused multiply-accumulate launch per tower
+   * instead of a product and a sum per term.
+   *
+   * @param &in are the terms, of the same parameters and format.
+   * @param &weights are the CRT representations of the weights, one per term.
+   * @param &result is the sum, which is left pinned.
+   * @return false, leaving result untouched, if a term is not pinned.
+   */
+    static bool LinearWSumOnPim(const std::vector<const DCRTPolyImpl*>& in,
+                                const std::vector<std::vector<Integer>>& weights, DCRTPolyImpl& result);
+
+    /**
+   * Fills every tower with uniform residues expanded from seed on the DPUs,
+   * so only the seed crosses the bus instead of the towers. Tower i reads
+   * stream (id << 32) + i (see PimUniform.h); UniformFromSeed regenerates
+   * the same polynomial on the host.
+   *
+   * @param &seed is the key of the stream, to be drawn from a secure source.
+   * @param id tells apart the polynomials expanded from the same seed.
+   * @return false, leaving the polynomial untouched, if the towers could not
+   * be sampled on the DPUs.
+   */
+    bool UniformOnPim(const PimUniformSeed& seed, uint32_t id = 0);
+
+    /**
+   * Host counterpart of UniformOnPim, the same seed and id give the same
+   * polynomial.
+   */
+    void UniformFromSeed(const PimUniformSeed& seed, uint32_t id = 0);
+
 protected:
     std::shared_ptr<Params> m_params{std::make_shared<DCRTPolyImpl::Params>(0, 1)};
     Format m_format{Format::EVALUATION};
     std::vector<PolyType> m_vectors;
-
-    /* This is a variable i added to trace specific operations like addition, multiplication etc
-        For formalizations the following is the identification:
-        Addition == 1
-        Multiplication == 2
-        Rotation == 3 
-    */
-    std::shared_ptr<PimManager> pim;
 };
 
 }  // namespace lbcrypto
@@ -112,6 +112,7 @@ PolyImpl<VecType>& PolyImpl<VecType>::operator=(std::initializer_list<uint64_t>
         temp.SetModulus(m_params->GetModulus());
         PolyImpl<VecType>::SetValues(std::move(temp), m_format);
     }
+    m_values->PrepareHostWrite();
     for (size_t j = 0; j < vlen; ++j)
         (*m_values)[j] = (j < llen) ? *(rhs.begin() + j) : ZERO;
     return *this;
@@ -130,6 +131,7 @@ PolyImpl<VecType>& PolyImpl<VecType>::operator=(const std::vector<int64_t>& rhs)
         tmp.SetModulus(m);
         PolyImpl<VecType>::SetValues(std::move(tmp), m_format);
     }
+    m_values->PrepareHostWrite();
     for (size_t j = 0; j < vlen; ++j) {
         if (j < llen)
             (*m_values)[j] =
@@ -152,6 +154,7 @@ PolyImpl<VecType>& PolyImpl<VecType>::operator=(const std::vector<int32_t>& rhs)
         tmp.SetModulus(m);
         PolyImpl<VecType>::SetValues(std::move(tmp), m_format);
     }
+    m_values->PrepareHostWrite();
     for (size_t j = 0; j < vlen; ++j) {
         if (j < llen)
             (*m_values)[j] =
@@ -182,6 +185,7 @@ PolyImpl<VecType>& PolyImpl<VecType>::operator=(uint64_t val) {
         const auto& m{m_params->GetModulus()};
         m_values = std::make_unique<VecType>(d, m);
     }
+    m_values->PrepareHostWrite();
     size_t vlen{m_values->GetLength()};
     Integer ival{val};
     for (size_t i = 0; i < vlen; ++i)
@@ -304,6 +308,7 @@ void PolyImpl<VecType>::AddILElementOne() {
     static const Integer ONE(1);
     usint vlen{m_params->GetRingDimension()};
     const auto& m{m_params->GetModulus()};
+    m_values->PrepareHostWrite();
     for (usint i = 0; i < vlen; ++i)
         (*m_values)[i].ModAddFastEq(ONE, m);
 }
@@ -350,6 +355,9 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k) const {
     uint32_t mask{(uint32_t(1) << logn) - 1};
 
     if (bf) {
+        if (AutomorphismOnPim(k, result))
+            return result;
+        m_values->SyncToHost();
         for (uint32_t j{0}, jk{k}; j < n; ++j, jk += (2 * k)) {
             auto&& jrev{lbcrypto::ReverseBits(j, logn)};
             auto&& idxrev{lbcrypto::ReverseBits((jk >> 1) & mask, logn)};
@@ -359,6 +367,7 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k) const {
     }
 
     auto q{m_params->GetModulus()};
+    m_values->SyncToHost();
     for (uint32_t j{0}, jk{0}; j < n; ++j, jk += k)
         (*result.m_values)[jk & mask] = ((jk >> logn) & 0x1) ? q - (*m_values)[j] : (*m_values)[j];
     return result;
@@ -371,7 +380,11 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k, const std
     if (k % 2 == 0)
         OPENFHE_THROW(math_error, "Automorphism index not odd\n");
     PolyImpl<VecType> tmp(m_params, m_format, true);
+    // precomp is the map of k, the DPUs hold their own copy of it
+    if (AutomorphismOnPim(k, tmp))
+        return tmp;
     uint32_t n = m_params->GetRingDimension();
+    m_values->SyncToHost();
     for (uint32_t j = 0; j < n; ++j)
         (*tmp.m_values)[j] = (*m_values)[precomp[j]];
     return tmp;
@@ -422,6 +435,21 @@ void PolyImpl<VecType>::SwitchFormat() {
     if (!m_values)
         OPENFHE_THROW(not_available_error, "Poly switch format to empty values");
 
+    if constexpr (std::is_same_v<VecType, NativeVector>) {
+        // The tables kept with the params save looking them up
+        const auto& plan{m_params->GetNTTPlan()};
+        if (plan && plan->GetModulus() == m_values->GetModulus()) {
+            if (m_format != Format::COEFFICIENT) {
+                m_format = Format::COEFFICIENT;
+                ChineseRemainderTransformFTT<VecType>().InverseTransformFromBitReverseInPlace(*plan, &(*m_values));
+                return;
+            }
+            m_format = Format::EVALUATION;
+            ChineseRemainderTransformFTT<VecType>().ForwardTransformToBitReverseInPlace(*plan, &(*m_values));
+            return;
+        }
+    }
+
     if (m_format != Format::COEFFICIENT) {
         m_format = Format::COEFFICIENT;
         ChineseRemainderTransformFTT<VecType>().InverseTransformFromBitReverseInPlace(ru, co, &(*m_values));
@@ -469,6 +497,7 @@ template <typename VecType>
 void PolyImpl<VecType>::MakeSparse(uint32_t wFactor) {
     static const Integer ZERO(0);
     if (m_values != nullptr) {
+        m_values->PrepareHostWrite();
         uint32_t vlen{m_params->GetRingDimension()};
         for (uint32_t i = 0; i < vlen; ++i) {
             if (i % wFactor != 0)
@@ -481,6 +510,7 @@ template <typename VecType>
 bool PolyImpl<VecType>::InverseExists() const {
     static const Integer ZERO(0);
     usint vlen{m_params->GetRingDimension()};
+    m_values->SyncToHost();
     for (usint i = 0; i < vlen; ++i) {
         if ((*m_values)[i] == ZERO)
             return false;
@@ -494,6 +524,7 @@ double PolyImpl<VecType>::Norm() const {
     const auto& q{m_params->GetModulus()};
     const auto& half{q >> 1};
     Integer maxVal{}, minVal{q};
+    m_values->SyncToHost();
     for (usint i = 0; i < vlen; i++) {
         auto& val = (*m_values)[i];
         if (val > half)
@@ -50,6 +50,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -116,6 +117,7 @@ public:
         m_params = std::make_shared<PolyImpl::Params>(c, m, r);
 
         const auto& v{rhs.GetValues()};
+        v.SyncToHost();
         uint32_t vlen{m_params->GetRingDimension()};
         VecType tmp(vlen);
         tmp.SetModulus(m_params->GetModulus());
@@ -349,17 +351,207 @@ public:
         return 1;
     }
 
-    /*  The functions setOperation and getOperation 
-        are function accessing my variable operations
-    */
-    void SetPim(std::shared_ptr<PimManager> newPim) {
-        // std::cout << "Pim is Set" << std::endl;
-        pim = newPim;
+    /**
+   * Keeps the coefficients resident on the DPUs (see NativeVectorT::PinToPim),
+   * only polynomials over native vectors can be pinned.
+   */
+    void PinToPim() {
+        if constexpr (!std::is_same_v<VecType, NativeVector>)
+            OPENFHE_THROW(not_available_error, "Only native polynomials can be pinned to PIM");
+        else if (m_values != nullptr)
+            m_values->PinToPim();
+    }
+
+    /**
+   * Pins the coefficients on the DPU holding those of next (see
+   * NativeVectorT::PinToPim), e.g. the towers of a DCRTPoly together.
+   */
+    void PinToPim(const PolyImpl& next) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>)
+            OPENFHE_THROW(not_available_error, "Only native polynomials can be pinned to PIM");
+        else if (m_values != nullptr && next.m_values != nullptr)
+            m_values->PinToPim(*next.m_values);
+        else
+            PinToPim();
+    }
+
+    void UnpinFromPim() {
+        if constexpr (std::is_same_v<VecType, NativeVector>) {
+            if (m_values != nullptr)
+                m_values->UnpinFromPim();
+        }
+    }
+
+    bool IsPinned() const {
+        if constexpr (std::is_same_v<VecType, NativeVector>)
+            return m_values != nullptr && m_values->IsPinned();
+        else
+            return false;
+    }
+
+    /**
+   * Bring the coefficients of a pinned polynomial up to date on the host
+   * before reading, respectively writing, them through at() or operator[]
+   * (see NativeVectorT::SyncToHost). The operations of PolyImpl do it
+   * themselves.
+   */
+    void SyncToHost() const {
+        if (m_values != nullptr)
+            m_values->SyncToHost();
+    }
+
+    void PrepareHostWrite() {
+        if (m_values != nullptr)
+            m_values->PrepareHostWrite();
+    }
+
+    /**
+   * Fast base conversion of the first sizeQ polynomials of in into out on the
+   * DPUs, see NativeVectorT::BaseConvOnPim. Only polynomials over native
+   * vectors are converted there.
+   */
+    static bool BaseConvOnPim(const std::vector<PolyImpl>& in, usint sizeQ, std::vector<PolyImpl>& out,
+                              const PimBaseConvTables& tables) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>) {
+            return false;
+        }
+        else {
+            std::vector<const VecType*> src;
+            std::vector<VecType*> dst;
+            for (usint i = 0; i < sizeQ; ++i) {
+                if (in[i].m_values == nullptr)
+                    return false;
+                src.push_back(in[i].m_values.get());
+            }
+            for (auto& poly : out) {
+                if (poly.m_values == nullptr)
+                    return false;
+                dst.push_back(poly.m_values.get());
+            }
+            return VecType::BaseConvOnPim(src, dst, tables);
+        }
+    }
+
+    /**
+   * Weighted sum of polynomials of the same format on the DPUs, see
+   * NativeVectorT::MacOnPim. Only polynomials over native vectors are summed
+   * there.
+   */
+    static bool MacOnPim(const std::vector<const PolyImpl*>& in, const std::vector<NativeInteger>& weights,
+                         PolyImpl& result) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>) {
+            return false;
+        }
+        else {
+            std::vector<const VecType*> src;
+            for (auto* poly : in) {
+                if (poly->m_values == nullptr || poly->m_format != in[0]->m_format)
+                    return false;
+                src.push_back(poly->m_values.get());
+            }
+            if (src.empty() || result.m_values == nullptr || !VecType::MacOnPim(src, weights, *result.m_values))
+                return false;
+            result.m_format = in[0]->m_format;
+            return true;
+        }
+    }
+
+    /**
+   * Rescale of the pinned towers by the pinned polynomial last, in the
+   * coefficient format, on the DPUs (see NativeVectorT::RescaleOnPim):
+   * towers[i] = towers[i] qlInv[i] + [last]_{q_i} scale[i]. last and the
+   * towers must be held by the same DPU, as the towers of a pinned
+   * polynomial are. In the evaluation format the lifted last polynomial goes
+   * through the NTT of each tower before the sum, run by that DPU (see
+   * PimData::ntt). Only polynomials over native vectors are rescaled there.
+   */
+    static bool RescaleOnPim(const PolyImpl& last, std::vector<PolyImpl>& towers,
+                             const std::vector<NativeInteger>& scale, const std::vector<NativeInteger>& qlInv) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>) {
+            return false;
+        }
+        else {
+            if (!last.IsPinned() || last.m_format != Format::COEFFICIENT || towers.empty())
+                return false;
+            std::vector<VecType*> x;
+            for (auto& poly : towers) {
+                if (!poly.IsPinned() || poly.m_format != towers[0].m_format)
+                    return false;
+                x.push_back(poly.m_values.get());
+            }
+            if (towers[0].m_format == Format::COEFFICIENT)
+                return VecType::RescaleOnPim(RESCALE_FUSED, last.m_values.get(), x, {}, scale, qlInv);
+
+            std::vector<PolyImpl> lifted;
+            std::vector<VecType*> y;
+            for (auto& poly : towers)
+                lifted.emplace_back(poly.m_params, Format::COEFFICIENT, true);
+            for (auto& poly : lifted)
+                y.push_back(poly.m_values.get());
+            if (!VecType::RescaleOnPim(RESCALE_SWITCH, last.m_values.get(), {}, y, scale, qlInv))
+                return false;
+            for (auto& poly : lifted)
+                poly.SwitchFormat();
+            return VecType::RescaleOnPim(RESCALE_ADD, nullptr, x, y, scale, qlInv);
+        }
+    }
+
+    /**
+   * Fills the towers with uniform residues expanded from seed on the DPUs,
+   * see NativeVectorT::UniformOnPim. The towers keep their format, a uniform
+   * polynomial is uniform in both. Only polynomials over native vectors are
+   * sampled there.
+   */
+    static bool UniformOnPim(const PimUniformSeed& seed, std::vector<PolyImpl>& towers,
+                             const std::vector<uint64_t>& streams) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>) {
+            return false;
+        }
+        else {
+            // The towers without values get theirs only if they are sampled
+            std::vector<std::unique_ptr<VecType>> fresh(towers.size());
+            std::vector<VecType*> out;
+            for (size_t i = 0; i < towers.size(); ++i) {
+                if (towers[i].m_values == nullptr)
+                    fresh[i] = std::make_unique<VecType>(towers[i].m_params->GetRingDimension(),
+                                                         towers[i].m_params->GetModulus());
+                out.push_back(fresh[i] != nullptr ? fresh[i].get() : towers[i].m_values.get());
+            }
+            if (!VecType::UniformOnPim(seed, out, streams))
+                return false;
+            for (size_t i = 0; i < towers.size(); ++i) {
+                if (fresh[i] != nullptr)
+                    towers[i].m_values = std::move(fresh[i]);
+            }
+            return true;
+        }
+    }
+
+    /**
+   * Host counterpart of UniformOnPim, see NativeVectorT::UniformFromSeed.
+   */
+    void UniformFromSeed(const PimUniformSeed& seed, uint64_t stream) {
+        if constexpr (!std::is_same_v<VecType, NativeVector>) {
+            OPENFHE_THROW(not_available_error, "Only native polynomials can be sampled from a seed");
+        }
+        else {
+            if (m_values == nullptr)
+                m_values = std::make_unique<VecType>(m_params->GetRingDimension(), m_params->GetModulus());
+            m_values->UniformFromSeed(seed, stream);
+        }
     }
 
-    std::shared_ptr<PimManager> GetPim() const {
-        // std::cout << "Pim is returned" << std::endl;
-        return pim;
+    /**
+   * Automorphism k of a pinned polynomial in the evaluation format on the
+   * DPUs, see NativeVectorT::AutomorphismOnPim. The rotations of the
+   * ciphertexts kept on the DPUs then never bring them back to the host.
+   */
+    bool AutomorphismOnPim(uint32_t k, PolyImpl& result) const {
+        if constexpr (!std::is_same_v<VecType, NativeVector>)
+            return false;
+        else
+            return IsPinned() && m_format == Format::EVALUATION && result.m_values != nullptr &&
+                   m_values->AutomorphismOnPim(k, *result.m_values);
     }
 
 protected:
@@ -367,7 +559,6 @@ protected:
     std::shared_ptr<Params> m_params{nullptr};
     std::unique_ptr<VecType> m_values{nullptr};
     void ArbitrarySwitchFormat();
-    std::shared_ptr<PimManager> pim;
 };
 
 // TODO: fix issue with pke build system so this can be moved back to implementation file
@@ -44,7 +44,9 @@
 #include "utils/exception.h"
 #include "utils/inttypes.h"
 
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 namespace lbcrypto {
@@ -59,6 +61,7 @@ template <typename IntType>
 class ILParamsImpl final : public ElemParams<IntType> {
 public:
     using Integer = IntType;
+    using NTTPlan = intnat::NTTPlanNat<NativeVector>;
 
     /**
    * Constructor that initializes nothing.
@@ -79,7 +82,9 @@ public:
    */
     ILParamsImpl(usint order, const IntType& modulus, const IntType& rootOfUnity,
                  const IntType& bigModulus = IntType(0), const IntType& bigRootOfUnity = IntType(0))
-        : ElemParams<IntType>(order, modulus, rootOfUnity, bigModulus, bigRootOfUnity) {}
+        : ElemParams<IntType>(order, modulus, rootOfUnity, bigModulus, bigRootOfUnity) {
+        BuildNTTPlan();
+    }
 
     /**
    * @brief Constructor for the case of partially pre-computed parameters.
@@ -88,14 +93,16 @@ public:
    * @param &modulus the ciphertext modulus.
    */
     ILParamsImpl(usint order, const IntType& modulus)
-        : ElemParams<IntType>(order, modulus, RootOfUnity<IntType>(order, modulus)) {}
+        : ElemParams<IntType>(order, modulus, RootOfUnity<IntType>(order, modulus)) {
+        BuildNTTPlan();
+    }
 
     /**
    * @brief Copy constructor.
    *
    * @param &rhs the input set of parameters which is copied.
    */
-    ILParamsImpl(const ILParamsImpl& rhs) : ElemParams<IntType>(rhs) {}
+    ILParamsImpl(const ILParamsImpl& rhs) : ElemParams<IntType>(rhs), m_nttPlan(rhs.m_nttPlan) {}
 
     /**
    * @brief Assignment Operator.
@@ -105,6 +112,7 @@ public:
    */
     ILParamsImpl& operator=(const ILParamsImpl& rhs) {
         ElemParams<IntType>::operator=(rhs);
+        m_nttPlan = rhs.m_nttPlan;
         return *this;
     }
 
@@ -113,10 +121,12 @@ public:
    *
    * @param &rhs the input set of parameters which is copied.
    */
-    ILParamsImpl(ILParamsImpl&& rhs) noexcept : ElemParams<IntType>(std::move(rhs)) {}
+    ILParamsImpl(ILParamsImpl&& rhs) noexcept
+        : ElemParams<IntType>(std::move(rhs)), m_nttPlan(std::move(rhs.m_nttPlan)) {}
 
     ILParamsImpl& operator=(ILParamsImpl&& rhs) noexcept {
         ElemParams<IntType>::operator=(std::move(rhs));
+        m_nttPlan = std::move(rhs.m_nttPlan);
         return *this;
     }
 
@@ -138,6 +148,17 @@ public:
         return ElemParams<IntType>::operator==(rhs);
     }
 
+    /**
+   * @brief The twiddle tables of the power-of-two NTT modulo the native
+   * modulus, shared by all the params of that modulus and ring dimension.
+   *
+   * @return the plan, nullptr for other params (big moduli, arbitrary
+   * cyclotomics or no root of unity).
+   */
+    const std::shared_ptr<const NTTPlan>& GetNTTPlan() const {
+        return m_nttPlan;
+    }
+
     template <class Archive>
     void save(Archive& ar, std::uint32_t const version) const {
         ar(::cereal::base_class<ElemParams<IntType>>(this));
@@ -150,6 +171,7 @@ public:
                                                  " is from a later version of the library");
         }
         ar(::cereal::base_class<ElemParams<IntType>>(this));
+        BuildNTTPlan();
     }
 
     std::string SerializedObjectName() const override {
@@ -160,12 +182,30 @@ public:
     }
 
 private:
+    void BuildNTTPlan() {
+        if constexpr (std::is_same_v<IntType, NativeInteger>) {
+            const auto& root = this->GetRootOfUnity();
+            usint order      = this->GetCyclotomicOrder();
+            if (root == IntType(0) || root == IntType(1) || this->GetRingDimension() != (order >> 1))
+                return;
+            try {
+                m_nttPlan = NTTPlan::Get(root, order, this->GetModulus());
+            }
+            catch (const math_error&) {
+                // Not an NTT modulus, the transforms will report it
+                m_nttPlan = nullptr;
+            }
+        }
+    }
+
     std::ostream& doprint(std::ostream& out) const override {
         out << "ILParams ";
         ElemParams<IntType>::doprint(out);
         out << std::endl;
         return out;
     }
+
+    std::shared_ptr<const NTTPlan> m_nttPlan;
 };
 
 }  // namespace lbcrypto
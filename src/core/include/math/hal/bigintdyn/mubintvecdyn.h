@@ -45,7 +45,6 @@
         #include "utils/exception.h"
         #include "utils/inttypes.h"
         #include "utils/serializable.h"
-        #include "pim/PimManager.h"
 
         #include <initializer_list>
         #include <iostream>
@@ -626,19 +625,6 @@ public:
         return 1;
     }
 
-    /*  The functions setOperation and getOperation 
-        are function accessing my variable operations
-    */
-    void SetPim(std::shared_ptr<PimManager> newPim) {
-        // std::cout << "Pim is Set" << std::endl;
-        pim = newPim;
-    }
-
-    std::shared_ptr<PimManager> GetPim() const {
-        // std::cout << "Pim is returned" << std::endl;
-        return pim;
-    }
-
 private:
     enum State { GARBAGE, INITIALIZED };
 
@@ -652,8 +638,6 @@ private:
     bool IndexCheck(size_t length) const {
         return length < m_data.size();
     }
-
-    std::shared_ptr<PimManager> pim;
 };
 
 }  // namespace bigintdyn
@@ -51,6 +51,8 @@
 #include <utility>
 #include <vector>
 #include "pim/PimData.h"
+#include "pim/PimPlanner.h"
+#include "utils/parallel.h"
 
 // the following should be set to 1 in order to have native vector use block
 // allocations then determine if you want dynamic or static allocations by
@@ -125,16 +127,73 @@ private:
 
 #if BLOCK_VECTOR_ALLOCATION != 1
     std::vector<IntegerType> m_data{};
-    PimData pim_m_data =  {1,2,3,4};
 #else
     xvector<IntegerType> m_data;
 #endif
-    std::shared_ptr<PimManager> pim;
+    // Device mirror of m_data. It only holds DPU state once the vector is
+    // pinned or an offloaded operation touched it (see PinToPim).
+    mutable PimData m_pim{0, PimLayout::WHOLE};
+
     // function to check if the index is a valid index.
     bool IndexCheck(size_t length) const {
         return length < m_data.size();
     }
 
+    const auto& HostData() const {
+        SyncToHost();
+        return m_data;
+    }
+
+    // Sizes the device mirror as m_data, a mirror of another size is
+    // released (see PimData::resize).
+    void PlaceOnPim() const {
+        m_pim.resize(m_data.size());
+    }
+
+    // Makes the device copy current, materializing it on first use. With
+    // lead, the other operand of a vector operation, the mirror is moved next
+    // to the one of lead if they are placed differently on the same DPUs.
+    void PushToPim(const NativeVectorT* lead = nullptr) const {
+        PlaceOnPim();
+        m_pim.to_pim(reinterpret_cast<const uint64_t*>(m_data.data()));
+        if (lead != nullptr)
+            m_pim.follow(lead->m_pim, reinterpret_cast<uint64_t*>(const_cast<IntegerType*>(m_data.data())));
+    }
+
+    // Copies the device mirror of a pinned v on the DPUs, m_data must already
+    // hold the (possibly stale) host copy of v.
+    void CopyOnPim(const NativeVectorT& v) {
+        v.PushToPim();
+        PlaceOnPim();
+        m_pim.copy_on_pim(v.m_pim);
+    }
+
+    // Unpinned copy for the operations computed on the host, writing its
+    // m_data directly.
+    NativeVectorT HostCopy() const {
+        NativeVectorT ans;
+        ans.m_modulus = m_modulus;
+        ans.m_data    = HostData();
+        return ans;
+    }
+
+    // Whether an operation on the vector, and on b for the vector operations,
+    // is offloaded: when one of them is pinned, or wherever it is expected to
+    // be faster once the offload planner is enabled (see PimPlanner).
+    bool OnPim(pim_op_class op, const NativeVectorT* b = nullptr) const {
+        if (!PimPlanner::get().enabled())
+            return IsPinned() || (b != nullptr && b->IsPinned());
+        uint32_t push = m_pim.pim_stale() + (b != nullptr && b->m_pim.pim_stale());
+        uint32_t pull = m_pim.host_stale() + (b != nullptr && b->m_pim.host_stale());
+#ifdef PARALLEL
+        // The towers of a DCRTPoly processed by an OpenMP team
+        uint32_t towers = omp_in_parallel() ? omp_get_num_threads() : 1;
+#else
+        uint32_t towers = 1;
+#endif
+        return PimPlanner::get().offload(op, m_data.size(), towers, push, pull);
+    }
+
 public:
     using BasicInt = typename IntegerType::Integer;
 
@@ -144,17 +203,326 @@ public:
         return NativeVectorT(1, modulus, val);
     }
 
-    // /*  The functions setOperation and getOperation
-    //     are function accessing my variable operations
-    // */
-    void SetPim(std::shared_ptr<PimManager> newPim) {
-        // std::cout << "Pim is Set" << std::endl;
-        pim = newPim;
+    /**
+   * Pins the vector to PIM: its device mirror is materialized and kept
+   * current, and the modular arithmetic operations on it are offloaded while
+   * it stays pinned. The host copy is only refreshed when an operation reads
+   * it on the host (see SyncToHost). Copies of a pinned vector are made on the
+   * DPUs and are pinned as well.
+   *
+   * @param layout is where the mirror goes (see PimLayout): whole on the
+   * least loaded DPU by default, or sliced over every DPU. A vector pinned
+   * with another layout is moved.
+   */
+    void PinToPim(PimLayout layout = PimLayout::WHOLE) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            OPENFHE_THROW(lbcrypto::not_available_error, "PIM residency requires 64-bit native integers");
+        }
+        else {
+            if (m_pim.get_layout() != layout)
+                SyncToHost();
+            m_pim.set_layout(layout);
+            PushToPim();
+        }
+    }
+
+    /**
+   * Pins the vector on the DPU holding next, e.g. a tower of a polynomial
+   * next to its first tower: the base conversions and rescales of the
+   * polynomial then run on that DPU alone. A vector already pinned elsewhere
+   * is moved there.
+   *
+   * @param &next is a pinned vector of the same length. If it is spread, or
+   * its DPU cannot hold the vector, the vector is pinned as PinToPim does.
+   */
+    void PinToPim(const NativeVectorT& next) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            OPENFHE_THROW(lbcrypto::not_available_error, "PIM residency requires 64-bit native integers");
+        }
+        else {
+            PlaceOnPim();
+            m_pim.place_near(next.m_pim);
+            PushToPim(next.IsPinned() ? &next : nullptr);
+        }
+    }
+
+    /**
+   * Brings the data back to the host if needed and releases its MRAM.
+   */
+    void UnpinFromPim() {
+        SyncToHost();
+        m_pim.release();
+    }
+
+    bool IsPinned() const {
+        return m_pim.is_materialized();
     }
 
-    std::shared_ptr<PimManager> GetPim() const {
-        // std::cout << "Pim is returned" << std::endl;
-        return pim;
+    /**
+   * Brings the host copy up to date if an offloaded operation left the device
+   * copy newer. The element accessors do not sync: an operation reading a
+   * pinned vector element-wise calls this once before its loop, outside of
+   * any parallel region. Concurrent calls only transfer once.
+   */
+    void SyncToHost() const {
+        if (m_pim.host_stale())
+            m_pim.to_host(reinterpret_cast<uint64_t*>(const_cast<IntegerType*>(m_data.data())));
+    }
+
+    /**
+   * Syncs the host copy and marks the device copy stale. It must precede the
+   * element-wise writes of a pinned vector through at() or operator[].
+   */
+    void PrepareHostWrite() {
+        if (m_pim.is_materialized()) {
+            SyncToHost();
+            m_pim.host_modified();
+        }
+    }
+
+    /**
+   * Negacyclic NTT of a pinned vector on the DPUs, in place (see PimData::ntt).
+   *
+   * @param inverse selects the inverse transform from bit reversed order.
+   * @param &tables are the tables of the vector modulus.
+   * @return false, leaving the vector untouched, if it is not pinned or its
+   * length is not a power of two, or does not split over the DPUs when it is
+   * spread.
+   */
+    bool NTTOnPim(bool inverse, const PimNttTables& tables) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            if (!IsPinned())
+                return false;
+            return m_pim.ntt(inverse, m_modulus.ConvertToInt(), tables, reinterpret_cast<uint64_t*>(m_data.data()));
+        }
+    }
+
+    /**
+   * Automorphism k of a pinned vector in the evaluation format, in bit
+   * reversed order, on the DPUs (see PimData::automorphism). The result is
+   * left pinned.
+   *
+   * @param k is the automorphism index, odd.
+   * @param &result receives the permuted vector.
+   * @return false, leaving result untouched, if the vector is not pinned or
+   * its length does not split over the DPUs.
+   */
+    bool AutomorphismOnPim(uint32_t k, NativeVectorT& result) const {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            if (!IsPinned() || &result == this)
+                return false;
+            NativeVectorT ans(m_data.size(), m_modulus);
+            ans.PlaceOnPim();
+            if (!m_pim.automorphism(k, reinterpret_cast<const uint64_t*>(m_data.data()), ans.m_pim,
+                                    reinterpret_cast<uint64_t*>(ans.m_data.data())))
+                return false;
+            result = std::move(ans);
+            return true;
+        }
+    }
+
+    /**
+   * Fast base conversion of the towers in, over the moduli of tables.q, into
+   * the towers out, over tables.p, on the DPUs (see PimData::base_conv). The
+   * results are left pinned.
+   *
+   * @param &in are the input towers, which must all be pinned by the same
+   * DPU, or all spread.
+   * @param &out are the output towers, of the same length.
+   * @param &tables are the precomputed tables of the conversion.
+   * @return false, leaving in and out untouched, if an input tower is not
+   * pinned, the towers are not all of the same length or the input towers
+   * are placed differently.
+   */
+    static bool BaseConvOnPim(const std::vector<const NativeVectorT*>& in, const std::vector<NativeVectorT*>& out,
+                              const PimBaseConvTables& tables) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            if (in.empty())
+                return false;
+            std::vector<PimData*> src, dst;
+            std::vector<const uint64_t*> bufs;
+            for (auto* v : in) {
+                if (!v->IsPinned())
+                    return false;
+                src.push_back(&v->m_pim);
+                bufs.push_back(reinterpret_cast<const uint64_t*>(v->m_data.data()));
+            }
+            for (auto* v : out) {
+                if (v->m_data.size() != in[0]->m_data.size())
+                    return false;
+            }
+            for (auto* v : out) {
+                v->PlaceOnPim();
+                dst.push_back(&v->m_pim);
+            }
+            return PimData::base_conv(src, bufs, dst, tables);
+        }
+    }
+
+    /**
+   * Weighted sum of the vectors in, sum_i weights[i] in[i] modulo their
+   * modulus, with the fused multiply-accumulate kernel of the DPUs (see
+   * PimData::mac). The result is left pinned.
+   *
+   * @param &in are the terms, which must all be pinned and share a modulus.
+   * Terms held by other DPUs than the first one, e.g. the elements of
+   * ciphertexts pinned separately, are moved next to it once (see
+   * PimData::follow).
+   * @param &weights are the weights of the terms.
+   * @param &result is the sum, which must not be one of the terms.
+   * @return false, leaving result untouched, if a term is not pinned or the
+   * modulus is wider than 62 bits.
+   */
+    static bool MacOnPim(const std::vector<const NativeVectorT*>& in, const std::vector<IntegerType>& weights,
+                         NativeVectorT& result) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            if (in.empty() || in.size() != weights.size())
+                return false;
+            std::vector<PimData*> src;
+            std::vector<const uint64_t*> bufs;
+            std::vector<uint64_t> w;
+            for (size_t i = 0; i < in.size(); ++i) {
+                if (!in[i]->IsPinned() || in[i] == &result || in[i]->m_modulus != in[0]->m_modulus)
+                    return false;
+                src.push_back(&in[i]->m_pim);
+                bufs.push_back(reinterpret_cast<const uint64_t*>(in[i]->m_data.data()));
+                w.push_back(weights[i].ConvertToInt());
+            }
+            for (auto* v : in)
+                v->PushToPim(in[0]);
+            NativeVectorT ans(in[0]->m_data.size(), in[0]->m_modulus);
+            ans.PlaceOnPim();
+            if (!PimData::mac(src, bufs, w, in[0]->m_modulus.ConvertToInt(), ans.m_pim))
+                return false;
+            result = std::move(ans);
+            return true;
+        }
+    }
+
+    /**
+   * Rescale of the towers x by the tower last, in the coefficient form, on
+   * the DPUs (see PimData::rescale). The moduli of the towers are those of
+   * the vectors x, or y for RESCALE_SWITCH. The results are left pinned.
+   *
+   * @param mode selects the kernel: x_i = x_i qInv_i + [last]_{q_i} scale_i,
+   * y_i = [last]_{q_i} scale_i, or x_i = x_i qInv_i + y_i.
+   * @param *last is the last tower, nullptr for RESCALE_ADD.
+   * @param &x are the towers rescaled, empty for RESCALE_SWITCH.
+   * @param &y are the lifted last towers, empty for RESCALE_FUSED.
+   * @param &scale are the factors of the lifted last tower.
+   * @param &qInv are the factors of the towers x.
+   * @return false, leaving the towers untouched, if an input is not pinned or
+   * a modulus is wider than 62 bits.
+   */
+    static bool RescaleOnPim(pim_rescale_mode mode, const NativeVectorT* last, const std::vector<NativeVectorT*>& x,
+                             const std::vector<NativeVectorT*>& y, const std::vector<IntegerType>& scale,
+                             const std::vector<IntegerType>& qInv) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            const auto& towers = mode == RESCALE_SWITCH ? y : x;
+            if (towers.empty() || scale.size() != towers.size() || qInv.size() != towers.size())
+                return false;
+            if ((last != nullptr && !last->IsPinned()) || (last == nullptr) != (mode == RESCALE_ADD))
+                return false;
+            PimRescaleTables tables;
+            tables.last_mod = last != nullptr ? last->m_modulus.ConvertToInt() : 0;
+            std::vector<PimData*> xs, ys;
+            std::vector<const uint64_t*> xBufs, yBufs;
+            for (size_t i = 0; i < towers.size(); ++i) {
+                tables.q.push_back(towers[i]->m_modulus.ConvertToInt());
+                tables.scale.push_back(scale[i].ConvertToInt());
+                tables.q_inv.push_back(qInv[i].ConvertToInt());
+            }
+            for (auto* v : x) {
+                if (!v->IsPinned())
+                    return false;
+                xs.push_back(&v->m_pim);
+                xBufs.push_back(reinterpret_cast<const uint64_t*>(v->m_data.data()));
+            }
+            for (auto* v : y) {
+                if (mode == RESCALE_ADD && !v->IsPinned())
+                    return false;
+                ys.push_back(&v->m_pim);
+                yBufs.push_back(reinterpret_cast<const uint64_t*>(v->m_data.data()));
+            }
+            if (!PimData::rescale(mode, last != nullptr ? &last->m_pim : nullptr,
+                                  last != nullptr ? reinterpret_cast<const uint64_t*>(last->m_data.data()) : nullptr,
+                                  xs, xBufs, ys, yBufs, tables))
+                return false;
+            // The towers y of a RESCALE_SWITCH were sized like last on the DPUs
+            if (mode == RESCALE_SWITCH)
+                for (auto* v : y)
+                    v->m_data.resize(last->m_data.size());
+            return true;
+        }
+    }
+
+    /**
+   * Fills the vectors out, of the same length, with uniform residues modulo
+   * their moduli expanded from seed on the DPUs (see PimData::uniform). The
+   * results are left pinned; UniformFromSeed regenerates them on the host.
+   *
+   * @param &seed is the key of the stream.
+   * @param &out are the vectors filled, sized and with their moduli set.
+   * @param &streams are the streams of the vectors.
+   * @return false, leaving the vectors untouched, if they are empty, their
+   * lengths differ or a modulus is 0.
+   */
+    static bool UniformOnPim(const PimUniformSeed& seed, const std::vector<NativeVectorT*>& out,
+                             const std::vector<uint64_t>& streams) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            return false;
+        }
+        else {
+            if (out.empty() || streams.size() != out.size())
+                return false;
+            for (auto* v : out) {
+                if (v->m_data.empty() || v->m_data.size() != out[0]->m_data.size() || v->m_modulus == 0)
+                    return false;
+            }
+            // Nothing was touched until here, and PimData::uniform takes any
+            // native modulus
+            std::vector<PimData*> dst;
+            std::vector<uint64_t> q;
+            for (auto* v : out) {
+                v->PlaceOnPim();
+                dst.push_back(&v->m_pim);
+                q.push_back(v->m_modulus.ConvertToInt());
+            }
+            return PimData::uniform(seed, dst, q, streams);
+        }
+    }
+
+    /**
+   * Host counterpart of UniformOnPim: the same seed and stream give the same
+   * vector (see pim_uniform_fill).
+   *
+   * @param &seed is the key of the stream.
+   * @param stream is the stream of the vector.
+   */
+    void UniformFromSeed(const PimUniformSeed& seed, uint64_t stream) {
+        if constexpr (sizeof(IntegerType) != sizeof(uint64_t)) {
+            OPENFHE_THROW(lbcrypto::not_available_error, "seeded sampling requires 64-bit native integers");
+        }
+        else {
+            PrepareHostWrite();
+            pim_uniform_fill(seed, stream, m_modulus.ConvertToInt(), 0, m_data.size(),
+                             reinterpret_cast<uint64_t*>(m_data.data()));
+        }
     }
 
     /**
@@ -192,7 +560,10 @@ public:
    *
    * @param bigVector is the native vector to be copied.
    */
-    constexpr NativeVectorT(const NativeVectorT& v) noexcept : m_modulus{v.m_modulus}, m_data{v.m_data} {}
+    NativeVectorT(const NativeVectorT& v) : m_modulus{v.m_modulus}, m_data{v.m_data} {
+        if (v.IsPinned())
+            CopyOnPim(v);
+    }
 
     /**
    * Basic move constructor for moving a vector
@@ -200,7 +571,7 @@ public:
    * @param &&bigVector is the native vector to be moved.
    */
     constexpr NativeVectorT(NativeVectorT&& v) noexcept
-        : m_modulus{std::move(v.m_modulus)}, m_data{std::move(v.m_data)} {}
+        : m_modulus{std::move(v.m_modulus)}, m_data{std::move(v.m_data)}, m_pim{std::move(v.m_pim)} {}
 
     /**
    * Basic constructor for specifying the length of the vector
@@ -231,7 +602,17 @@ public:
    * @param &rhs is the native vector to be assigned from.
    * @return Assigned NativeVectorT.
    */
-    NativeVectorT& operator=(const NativeVectorT& rhs) noexcept {
+    NativeVectorT& operator=(const NativeVectorT& rhs) {
+        if (this == &rhs)
+            return *this;
+        if (rhs.IsPinned()) {
+            m_modulus = rhs.m_modulus;
+            m_data    = rhs.m_data;
+            CopyOnPim(rhs);
+            return *this;
+        }
+        rhs.SyncToHost();
+        PrepareHostWrite();
         m_modulus = rhs.m_modulus;
         if (m_data.size() >= rhs.m_data.size()) {
             std::copy(rhs.m_data.begin(), rhs.m_data.end(), m_data.begin());
@@ -252,6 +633,7 @@ public:
     NativeVectorT& operator=(NativeVectorT&& rhs) noexcept {
         m_modulus = std::move(rhs.m_modulus);
         m_data    = std::move(rhs.m_data);
+        m_pim     = std::move(rhs.m_pim);
         return *this;
     }
 
@@ -262,7 +644,7 @@ public:
    * the BBV.
    * @return NativeVectorT object
    */
-    NativeVectorT& operator=(std::initializer_list<std::string> rhs) noexcept;
+    NativeVectorT& operator=(std::initializer_list<std::string> rhs);
 
     /**
    * Initializer list for NativeVectorT.
@@ -270,7 +652,7 @@ public:
    * @param &&rhs is the list of integers to be assigned to the BBV.
    * @return NativeVectorT object
    */
-    NativeVectorT& operator=(std::initializer_list<uint64_t> rhs) noexcept;
+    NativeVectorT& operator=(std::initializer_list<uint64_t> rhs);
 
     /**
    * Assignment operator to assign value val to first entry, 0 for the rest of
@@ -280,6 +662,7 @@ public:
    * @return Assigned NativeVectorT.
    */
     constexpr NativeVectorT& operator=(uint64_t val) {
+        PrepareHostWrite();
         std::fill(m_data.begin(), m_data.end(), 0);
         m_data.at(0) = val;
         return *this;
@@ -304,7 +687,8 @@ public:
     }
 
     /**
-   * operators to get a value at an index.
+   * operators to get a value at an index. Neither syncs a pinned vector, see
+   * SyncToHost and PrepareHostWrite.
    * @param idx is the index to get a value at.
    * @return is the value at the index. return nullptr if invalid index.
    */
@@ -424,6 +808,16 @@ public:
    */
     NativeVectorT& ModAddEq(const NativeVectorT& b);
     NativeVectorT& ModAddNoCheckEq(const NativeVectorT& b) {
+        if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+            if (OnPim(PIM_OP_ADD_SUB, &b)) {
+                PushToPim();
+                b.PushToPim(this);
+                m_pim.ModAddEq(b.m_pim, m_modulus.ConvertToInt());
+                return *this;
+            }
+        }
+        PrepareHostWrite();
+        b.SyncToHost();
         size_t size{m_data.size()};
         auto mv{m_modulus};
         for (size_t i = 0; i < size; ++i)
@@ -499,6 +893,16 @@ public:
    */
     NativeVectorT& ModMulEq(const NativeVectorT& b);
     NativeVectorT& ModMulNoCheckEq(const NativeVectorT& b) {
+        if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+            if (OnPim(PIM_OP_MULT, &b)) {
+                PushToPim();
+                b.PushToPim(this);
+                m_pim.ModMulEq(b.m_pim, m_modulus.ConvertToInt());
+                return *this;
+            }
+        }
+        PrepareHostWrite();
+        b.SyncToHost();
         size_t size{m_data.size()};
         auto mv{m_modulus};
 #ifdef NATIVEINT_BARRET_MOD
@@ -544,6 +948,7 @@ public:
    * @return a new vector which is the result of the modulus inverse operation.
    */
     NativeVectorT ModInverse() const {
+        SyncToHost();
         size_t size{m_data.size()};
         auto mv{m_modulus};
         NativeVectorT ans(size, mv);
@@ -558,6 +963,7 @@ public:
    * @return a new vector which is the result of the modulus inverse operation.
    */
     NativeVectorT& ModInverseEq() {
+        PrepareHostWrite();
         size_t size{m_data.size()};
         auto mv{m_modulus};
         for (size_t i{0}; i < size; ++i)
@@ -652,6 +1058,7 @@ public:
    */
     template <class IntegerType_c>
     friend std::ostream& operator<<(std::ostream& os, const NativeVectorT<IntegerType_c>& ptr_obj) {
+        ptr_obj.SyncToHost();
         auto len = ptr_obj.m_data.size();
         os << "[";
         for (usint i = 0; i < len; i++) {
@@ -665,6 +1072,7 @@ public:
     template <class Archive>
     typename std::enable_if<!cereal::traits::is_text_archive<Archive>::value, void>::type save(
         Archive& ar, std::uint32_t const version) const {
+        SyncToHost();
         ::cereal::size_type size = m_data.size();
         ar(size);
         if (size > 0) {
@@ -676,6 +1084,7 @@ public:
     template <class Archive>
     typename std::enable_if<cereal::traits::is_text_archive<Archive>::value, void>::type save(
         Archive& ar, std::uint32_t const version) const {
+        SyncToHost();
         ar(::cereal::make_nvp("v", m_data));
         ar(::cereal::make_nvp("m", m_modulus));
     }
@@ -689,6 +1098,7 @@ public:
         }
         ::cereal::size_type size;
         ar(size);
+        PrepareHostWrite();
         m_data.resize(size);
         if (size > 0) {
             auto* data = reinterpret_cast<IntegerType*>(malloc(size * sizeof(IntegerType)));
@@ -708,6 +1118,7 @@ public:
             OPENFHE_THROW(lbcrypto::deserialize_error, "serialized object version " + std::to_string(version) +
                                                            " is from a later version of the library");
         }
+        PrepareHostWrite();
         ar(::cereal::make_nvp("v", m_data));
         ar(::cereal::make_nvp("m", m_modulus));
     }
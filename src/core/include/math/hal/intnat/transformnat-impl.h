@@ -40,6 +40,7 @@
 #include "math/hal/intnat/ubintnat.h"
 #include "math/hal/intnat/mubintvecnat.h"
 #include "math/hal/intnat/transformnat.h"
+#include "math/hal/intnat/transformnat-simd.h"
 #include "math/nbtheory.h"
 
 #include "utils/exception.h"
@@ -52,28 +53,11 @@
 namespace intnat {
 
 template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_cycloOrderInverseTableByModulus;
-
-template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_cycloOrderInversePreconTableByModulus;
-
-template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_rootOfUnityReverseTableByModulus;
-
-template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_rootOfUnityInverseReverseTableByModulus;
+std::shared_mutex NTTPlanNat<VecType>::m_plansLock;
 
 template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_rootOfUnityPreconReverseTableByModulus;
-
-template <typename VecType>
-std::map<typename VecType::Integer, VecType>
-    ChineseRemainderTransformFTTNat<VecType>::m_rootOfUnityInversePreconReverseTableByModulus;
+std::map<std::pair<typename VecType::Integer, usint>, std::shared_ptr<const NTTPlanNat<VecType>>>
+    NTTPlanNat<VecType>::m_plans;
 
 template <typename VecType>
 std::map<typename VecType::Integer, VecType> ChineseRemainderTransformArbNat<VecType>::m_cyclotomicPolyMap;
@@ -123,6 +107,8 @@ std::map<usint, usint> ChineseRemainderTransformArbNat<VecType>::m_nttDivisionDi
 template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::ForwardTransformIterative(const VecType& element,
                                                                      const VecType& rootOfUnityTable, VecType* result) {
+    element.SyncToHost();
+    result->PrepareHostWrite();
     usint n = element.GetLength();
     if (result->GetLength() != n) {
         OPENFHE_THROW(lbcrypto::math_error, "size of input element and size of output element not of same size");
@@ -196,6 +182,7 @@ void NumberTheoreticTransformNat<VecType>::InverseTransformIterative(const VecTy
 template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::ForwardTransformToBitReverseInPlace(const VecType& rootOfUnityTable,
                                                                                VecType* element) {
+    element->PrepareHostWrite();
     usint n         = element->GetLength();
     IntType modulus = element->GetModulus();
     IntType mu      = modulus.ComputeMu();
@@ -241,6 +228,8 @@ template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::ForwardTransformToBitReverse(const VecType& element,
                                                                         const VecType& rootOfUnityTable,
                                                                         VecType* result) {
+    element.SyncToHost();
+    result->PrepareHostWrite();
     usint n = element.GetLength();
     if (result->GetLength() != n) {
         OPENFHE_THROW(lbcrypto::math_error, "size of input element and size of output element not of same size");
@@ -300,7 +289,17 @@ template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::ForwardTransformToBitReverseInPlace(const VecType& rootOfUnityTable,
                                                                                const VecType& preconRootOfUnityTable,
                                                                                VecType* element) {
+    element->PrepareHostWrite();
     auto modulus{element->GetModulus()};
+#ifdef WITH_SIMD_NTT
+    if constexpr (sizeof(IntType) == sizeof(uint64_t)) {
+        // Lazy butterflies, vectorized when the CPU has AVX-512 or AVX2
+        if (NttSimdForward(reinterpret_cast<uint64_t*>(&(*element)[0]), element->GetLength(),
+                           modulus.ConvertToInt(), reinterpret_cast<const uint64_t*>(&rootOfUnityTable[0]),
+                           reinterpret_cast<const uint64_t*>(&preconRootOfUnityTable[0])))
+            return;
+    }
+#endif
     uint32_t n(element->GetLength() >> 1), t{n}, logt{lbcrypto::GetMSB(t)};
     for (uint32_t m{1}; m < n; m <<= 1, t >>= 1, --logt) {
         for (uint32_t i{0}; i < m; ++i) {
@@ -358,6 +357,8 @@ void NumberTheoreticTransformNat<VecType>::ForwardTransformToBitReverse(const Ve
                                                                         const VecType& rootOfUnityTable,
                                                                         const VecType& preconRootOfUnityTable,
                                                                         VecType* result) {
+    element.SyncToHost();
+    result->PrepareHostWrite();
     usint n = element.GetLength();
 
     if (result->GetLength() != n) {
@@ -419,6 +420,7 @@ template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverseInPlace(const VecType& rootOfUnityInverseTable,
                                                                                  const IntType& cycloOrderInv,
                                                                                  VecType* element) {
+    element->PrepareHostWrite();
     usint n         = element->GetLength();
     IntType modulus = element->GetModulus();
     IntType mu      = modulus.ComputeMu();
@@ -474,6 +476,8 @@ void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverse(const
                                                                           const VecType& rootOfUnityInverseTable,
                                                                           const IntType& cycloOrderInv,
                                                                           VecType* result) {
+    element.SyncToHost();
+    result->PrepareHostWrite();
     usint n = element.GetLength();
 
     if (result->GetLength() != n) {
@@ -492,7 +496,17 @@ template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverseInPlace(
     const VecType& rootOfUnityInverseTable, const VecType& preconRootOfUnityInverseTable, const IntType& cycloOrderInv,
     const IntType& preconCycloOrderInv, VecType* element) {
+    element->PrepareHostWrite();
     auto modulus{element->GetModulus()};
+#ifdef WITH_SIMD_NTT
+    if constexpr (sizeof(IntType) == sizeof(uint64_t)) {
+        if (NttSimdInverse(reinterpret_cast<uint64_t*>(&(*element)[0]), element->GetLength(),
+                           modulus.ConvertToInt(), reinterpret_cast<const uint64_t*>(&rootOfUnityInverseTable[0]),
+                           reinterpret_cast<const uint64_t*>(&preconRootOfUnityInverseTable[0]),
+                           cycloOrderInv.ConvertToInt(), preconCycloOrderInv.ConvertToInt()))
+            return;
+    }
+#endif
     uint32_t n(element->GetLength());
     for (uint32_t i{0}; i < n; i += 2) {
         auto omega{rootOfUnityInverseTable[(i + n) >> 1]};
@@ -555,6 +569,8 @@ template <typename VecType>
 void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverse(
     const VecType& element, const VecType& rootOfUnityInverseTable, const VecType& preconRootOfUnityInverseTable,
     const IntType& cycloOrderInv, const IntType& preconCycloOrderInv, VecType* result) {
+    element.SyncToHost();
+    result->PrepareHostWrite();
     usint n = element.GetLength();
     if (result->GetLength() != n) {
         OPENFHE_THROW(lbcrypto::math_error, "size of input element and size of output element not of same size");
@@ -571,12 +587,90 @@ void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverse(
     return;
 }
 
+template <typename VecType>
+NTTPlanNat<VecType>::NTTPlanNat(const IntType& rootOfUnity, usint CycloOrder, const IntType& modulus)
+    : m_modulus(modulus),
+      m_rootOfUnity(rootOfUnity),
+      m_ringDimension(CycloOrder >> 1),
+      m_rootOfUnityTable(CycloOrder >> 1, modulus),
+      m_rootOfUnityPreconTable(CycloOrder >> 1, modulus),
+      m_rootOfUnityInverseTable(CycloOrder >> 1, modulus),
+      m_rootOfUnityInversePreconTable(CycloOrder >> 1, modulus) {
+    usint CycloOrderHf         = m_ringDimension;
+    usint msb                  = lbcrypto::GetMSB(CycloOrderHf - 1);
+    IntType mu                 = modulus.ComputeMu();
+    IntType rootOfUnityInverse = rootOfUnity.ModInverse(modulus);
+    IntType x(1), xinv(1);
+    for (usint i = 0; i < CycloOrderHf; i++) {
+        usint iinv                      = lbcrypto::ReverseBits(i, msb);
+        m_rootOfUnityTable[iinv]        = x;
+        m_rootOfUnityInverseTable[iinv] = xinv;
+        x.ModMulEq(rootOfUnity, modulus, mu);
+        xinv.ModMulEq(rootOfUnityInverse, modulus, mu);
+    }
+
+    NativeInteger nativeModulus = modulus.ConvertToInt();
+    for (usint i = 0; i < CycloOrderHf; i++) {
+        m_rootOfUnityPreconTable[i] =
+            NativeInteger(m_rootOfUnityTable[i].ConvertToInt()).PrepModMulConst(nativeModulus);
+        m_rootOfUnityInversePreconTable[i] =
+            NativeInteger(m_rootOfUnityInverseTable[i].ConvertToInt()).PrepModMulConst(nativeModulus);
+    }
+
+    m_cycloOrderInverse       = IntType(CycloOrderHf).ModInverse(modulus);
+    m_cycloOrderInversePrecon = NativeInteger(m_cycloOrderInverse.ConvertToInt()).PrepModMulConst(nativeModulus);
+}
+
+template <typename VecType>
+std::shared_ptr<const NTTPlanNat<VecType>> NTTPlanNat<VecType>::Get(const IntType& rootOfUnity, usint CycloOrder,
+                                                                    const IntType& modulus) {
+    auto key = std::make_pair(modulus, usint(CycloOrder >> 1));
+    {
+        std::shared_lock<std::shared_mutex> guard(m_plansLock);
+        auto it = m_plans.find(key);
+        if (it != m_plans.end())
+            return it->second;
+    }
+    // Other moduli are not held back while the tables are computed
+    auto plan = std::make_shared<const NTTPlanNat>(rootOfUnity, CycloOrder, modulus);
+    std::unique_lock<std::shared_mutex> guard(m_plansLock);
+    return m_plans.emplace(key, std::move(plan)).first->second;
+}
+
+template <typename VecType>
+std::shared_ptr<const NTTPlanNat<VecType>> NTTPlanNat<VecType>::Find(const IntType& modulus, usint ringDimension) {
+    std::shared_lock<std::shared_mutex> guard(m_plansLock);
+    auto it = m_plans.find(std::make_pair(modulus, ringDimension));
+    return it != m_plans.end() ? it->second : nullptr;
+}
+
+template <typename VecType>
+void NTTPlanNat<VecType>::Reset() {
+    std::unique_lock<std::shared_mutex> guard(m_plansLock);
+    m_plans.clear();
+}
+
+template <typename VecType>
+PimNttTables NTTPlanNat<VecType>::GetPimTables() const {
+    PimNttTables tables;
+    if constexpr (sizeof(IntType) == sizeof(uint64_t)) {
+        auto view = [](const VecType& table) {
+            return reinterpret_cast<const uint64_t*>(&table[0]);
+        };
+        tables.root            = view(m_rootOfUnityTable);
+        tables.root_precon     = view(m_rootOfUnityPreconTable);
+        tables.root_inv        = view(m_rootOfUnityInverseTable);
+        tables.root_inv_precon = view(m_rootOfUnityInversePreconTable);
+        tables.n_inv           = m_cycloOrderInverse.ConvertToInt();
+        tables.n_inv_precon    = m_cycloOrderInversePrecon.ConvertToInt();
+    }
+    return tables;
+}
+
 template <typename VecType>
 void ChineseRemainderTransformFTTNat<VecType>::ForwardTransformToBitReverseInPlace(const IntType& rootOfUnity,
                                                                                    const usint CycloOrder,
                                                                                    VecType* element) {
-    // std::cout << "ForwardTransformToBitReverseInPlace" << std::endl;
-
     if (rootOfUnity == IntType(1) || rootOfUnity == IntType(0)) {
         return;
     }
@@ -590,15 +684,19 @@ void ChineseRemainderTransformFTTNat<VecType>::ForwardTransformToBitReverseInPla
         OPENFHE_THROW(lbcrypto::math_error, "element size must be equal to CyclotomicOrder / 2");
     }
 
-    IntType modulus = element->GetModulus();
+    ForwardTransformToBitReverseInPlace(*NTTPlanNat<VecType>::Get(rootOfUnity, CycloOrder, element->GetModulus()),
+                                        element);
+}
 
-    auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
-    if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
-        PreCompute(rootOfUnity, CycloOrder, modulus);
-    }
+template <typename VecType>
+void ChineseRemainderTransformFTTNat<VecType>::ForwardTransformToBitReverseInPlace(const NTTPlanNat<VecType>& plan,
+                                                                                   VecType* element) {
+    // Pinned vectors are transformed on the DPUs
+    if (element->IsPinned() && element->NTTOnPim(false, plan.GetPimTables()))
+        return;
 
     NumberTheoreticTransformNat<VecType>().ForwardTransformToBitReverseInPlace(
-        m_rootOfUnityReverseTableByModulus[modulus], m_rootOfUnityPreconReverseTableByModulus[modulus], element);
+        plan.GetRootOfUnityTable(), plan.GetRootOfUnityPreconTable(), element);
 }
 
 template <typename VecType>
@@ -619,16 +717,9 @@ void ChineseRemainderTransformFTTNat<VecType>::ForwardTransformToBitReverse(cons
         OPENFHE_THROW(lbcrypto::math_error, "result size must be equal to CyclotomicOrder / 2");
     }
 
-    IntType modulus = element.GetModulus();
-
-    auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
-    if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
-        PreCompute(rootOfUnity, CycloOrder, modulus);
-    }
-
-    NumberTheoreticTransformNat<VecType>().ForwardTransformToBitReverse(
-        element, m_rootOfUnityReverseTableByModulus[modulus], m_rootOfUnityPreconReverseTableByModulus[modulus],
-        result);
+    auto plan = NTTPlanNat<VecType>::Get(rootOfUnity, CycloOrder, element.GetModulus());
+    NumberTheoreticTransformNat<VecType>().ForwardTransformToBitReverse(element, plan->GetRootOfUnityTable(),
+                                                                        plan->GetRootOfUnityPreconTable(), result);
 
     return;
 }
@@ -637,7 +728,6 @@ template <typename VecType>
 void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverseInPlace(const IntType& rootOfUnity,
                                                                                      const usint CycloOrder,
                                                                                      VecType* element) {
-    // std::cout << "InverseTransformFromBitReverseInPlace" << std::endl;
     if (rootOfUnity == IntType(1) || rootOfUnity == IntType(0)) {
         return;
     }
@@ -651,18 +741,19 @@ void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverseInP
         OPENFHE_THROW(lbcrypto::math_error, "element size must be equal to CyclotomicOrder / 2");
     }
 
-    IntType modulus = element->GetModulus();
+    InverseTransformFromBitReverseInPlace(*NTTPlanNat<VecType>::Get(rootOfUnity, CycloOrder, element->GetModulus()),
+                                          element);
+}
 
-    auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
-    if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
-        PreCompute(rootOfUnity, CycloOrder, modulus);
-    }
+template <typename VecType>
+void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverseInPlace(const NTTPlanNat<VecType>& plan,
+                                                                                     VecType* element) {
+    if (element->IsPinned() && element->NTTOnPim(true, plan.GetPimTables()))
+        return;
 
-    usint msb = lbcrypto::GetMSB(CycloOrderHf - 1);
     NumberTheoreticTransformNat<VecType>().InverseTransformFromBitReverseInPlace(
-        m_rootOfUnityInverseReverseTableByModulus[modulus], m_rootOfUnityInversePreconReverseTableByModulus[modulus],
-        m_cycloOrderInverseTableByModulus[modulus][msb], m_cycloOrderInversePreconTableByModulus[modulus][msb],
-        element);
+        plan.GetRootOfUnityInverseTable(), plan.GetRootOfUnityInversePreconTable(), plan.GetCycloOrderInverse(),
+        plan.GetCycloOrderInversePrecon(), element);
 }
 
 template <typename VecType>
@@ -683,12 +774,7 @@ void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverse(co
         OPENFHE_THROW(lbcrypto::math_error, "result size must be equal to CyclotomicOrder / 2");
     }
 
-    IntType modulus = element.GetModulus();
-
-    auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
-    if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
-        PreCompute(rootOfUnity, CycloOrder, modulus);
-    }
+    auto plan = NTTPlanNat<VecType>::Get(rootOfUnity, CycloOrder, element.GetModulus());
 
     usint n = element.GetLength();
     result->SetModulus(element.GetModulus());
@@ -696,10 +782,9 @@ void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverse(co
         (*result)[i] = element[i];
     }
 
-    usint msb = lbcrypto::GetMSB(CycloOrderHf - 1);
     NumberTheoreticTransformNat<VecType>().InverseTransformFromBitReverseInPlace(
-        m_rootOfUnityInverseReverseTableByModulus[modulus], m_rootOfUnityInversePreconReverseTableByModulus[modulus],
-        m_cycloOrderInverseTableByModulus[modulus][msb], m_cycloOrderInversePreconTableByModulus[modulus][msb], result);
+        plan->GetRootOfUnityInverseTable(), plan->GetRootOfUnityInversePreconTable(), plan->GetCycloOrderInverse(),
+        plan->GetCycloOrderInversePrecon(), result);
 
     return;
 }
@@ -707,59 +792,7 @@ void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverse(co
 template <typename VecType>
 void ChineseRemainderTransformFTTNat<VecType>::PreCompute(const IntType& rootOfUnity, const usint CycloOrder,
                                                           const IntType& modulus) {
-    // Half of cyclo order
-    usint CycloOrderHf = (CycloOrder >> 1);
-
-    auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
-    if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
-#pragma omp critical
-        {
-            IntType x(1), xinv(1);
-            usint msb  = lbcrypto::GetMSB(CycloOrderHf - 1);
-            IntType mu = modulus.ComputeMu();
-            VecType Table(CycloOrderHf, modulus);
-            VecType TableI(CycloOrderHf, modulus);
-            IntType rootOfUnityInverse = rootOfUnity.ModInverse(modulus);
-            usint iinv;
-            for (usint i = 0; i < CycloOrderHf; i++) {
-                iinv         = lbcrypto::ReverseBits(i, msb);
-                Table[iinv]  = x;
-                TableI[iinv] = xinv;
-                x.ModMulEq(rootOfUnity, modulus, mu);
-                xinv.ModMulEq(rootOfUnityInverse, modulus, mu);
-            }
-            m_rootOfUnityReverseTableByModulus[modulus]        = Table;
-            m_rootOfUnityInverseReverseTableByModulus[modulus] = TableI;
-
-            VecType TableCOI(msb + 1, modulus);
-            for (usint i = 0; i < msb + 1; i++) {
-                IntType coInv(IntType(1 << i).ModInverse(modulus));
-                TableCOI[i] = coInv;
-            }
-            m_cycloOrderInverseTableByModulus[modulus] = TableCOI;
-
-            NativeInteger nativeModulus = modulus.ConvertToInt();
-            VecType preconTable(CycloOrderHf, nativeModulus);
-            VecType preconTableI(CycloOrderHf, nativeModulus);
-
-            for (usint i = 0; i < CycloOrderHf; i++) {
-                preconTable[i] = NativeInteger(m_rootOfUnityReverseTableByModulus[modulus][i].ConvertToInt())
-                                     .PrepModMulConst(nativeModulus);
-                preconTableI[i] = NativeInteger(m_rootOfUnityInverseReverseTableByModulus[modulus][i].ConvertToInt())
-                                      .PrepModMulConst(nativeModulus);
-            }
-
-            VecType preconTableCOI(msb + 1, nativeModulus);
-            for (usint i = 0; i < msb + 1; i++) {
-                preconTableCOI[i] = NativeInteger(m_cycloOrderInverseTableByModulus[modulus][i].ConvertToInt())
-                                        .PrepModMulConst(nativeModulus);
-            }
-
-            m_rootOfUnityPreconReverseTableByModulus[modulus]        = preconTable;
-            m_rootOfUnityInversePreconReverseTableByModulus[modulus] = preconTableI;
-            m_cycloOrderInversePreconTableByModulus[modulus]         = preconTableCOI;
-        }
-    }
+    NTTPlanNat<VecType>::Get(rootOfUnity, CycloOrder, modulus);
 }
 
 template <typename VecType>
@@ -779,14 +812,17 @@ void ChineseRemainderTransformFTTNat<VecType>::PreCompute(std::vector<IntType>&
     }
 }
 
+template <typename VecType>
+PimNttTables ChineseRemainderTransformFTTNat<VecType>::PimTables(const IntType& modulus, usint CycloOrderHf) {
+    auto plan = NTTPlanNat<VecType>::Find(modulus, CycloOrderHf);
+    if (plan == nullptr)
+        OPENFHE_THROW(lbcrypto::math_error, "No NTT plan for modulus " + modulus.ToString());
+    return plan->GetPimTables();
+}
+
 template <typename VecType>
 void ChineseRemainderTransformFTTNat<VecType>::Reset() {
-    m_cycloOrderInverseTableByModulus.clear();
-    m_cycloOrderInversePreconTableByModulus.clear();
-    m_rootOfUnityReverseTableByModulus.clear();
-    m_rootOfUnityInverseReverseTableByModulus.clear();
-    m_rootOfUnityPreconReverseTableByModulus.clear();
-    m_rootOfUnityInversePreconReverseTableByModulus.clear();
+    NTTPlanNat<VecType>::Reset();
 }
 
 template <typename VecType>
@@ -1089,6 +1125,7 @@ template <typename VecType>
 VecType ChineseRemainderTransformArbNat<VecType>::ForwardTransform(const VecType& element, const IntType& root,
                                                                    const IntType& nttModulus, const IntType& nttRoot,
                                                                    const usint cycloOrder) {
+    element.SyncToHost();
     usint phim = lbcrypto::GetTotient(cycloOrder);
     if (element.GetLength() != phim) {
         OPENFHE_THROW(lbcrypto::math_error, "element size should be equal to phim");
@@ -1127,6 +1164,7 @@ template <typename VecType>
 VecType ChineseRemainderTransformArbNat<VecType>::InverseTransform(const VecType& element, const IntType& root,
                                                                    const IntType& nttModulus, const IntType& nttRoot,
                                                                    const usint cycloOrder) {
+    element.SyncToHost();
     usint phim = lbcrypto::GetTotient(cycloOrder);
     if (element.GetLength() != phim) {
         OPENFHE_THROW(lbcrypto::math_error, "element size should be equal to phim");
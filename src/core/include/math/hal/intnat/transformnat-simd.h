@@ -0,0 +1,102 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Lazy Harvey butterflies of the negacyclic NTT over 64-bit words, vectorized
+  with AVX-512 and AVX2 and dispatched at runtime on the features of the CPU
+ */
+
+#ifndef LBCRYPTO_MATH_HAL_INTNAT_TRANSFORMNAT_SIMD_H
+#define LBCRYPTO_MATH_HAL_INTNAT_TRANSFORMNAT_SIMD_H
+
+#include <cstdint>
+#include <string>
+
+namespace intnat {
+
+/**
+ * @brief Implementations of the NTT of NativeVector.
+ *
+ * OFF keeps the butterflies of NumberTheoreticTransformNat, with a full
+ * reduction per butterfly. The other paths keep the values in [0, 4q) between
+ * the stages and only reduce them below q at the end, which requires moduli
+ * below 2^62; they compute the same transform, bit for bit.
+ *
+ * The path is the best one the CPU supports, unless the OPENFHE_NTT_SIMD
+ * environment variable (off, scalar, avx2 or avx512) selects another one.
+ */
+enum class NttSimdPath { OFF, SCALAR, AVX2, AVX512 };
+
+/**
+ * Whether the CPU, and the build, support the path.
+ */
+bool NttSimdSupported(NttSimdPath path);
+
+/**
+ * The path the NTT of NativeVector takes.
+ */
+NttSimdPath GetNttSimdPath();
+
+/**
+ * Selects the path the NTT of NativeVector takes, for all threads.
+ * @param path has to be supported.
+ */
+void SetNttSimdPath(NttSimdPath path);
+
+std::string NttSimdPathName(NttSimdPath path);
+
+/**
+ * In-place forward transform in Z_q[X]/(X^n+1), to bit reversed order, on
+ * the selected path (see NumberTheoreticTransformNat::ForwardTransformToBitReverseInPlace).
+ *
+ * @param element holds n residues below q, n a power of two.
+ * @param rootOfUnityTable the n powers of the root of unity in bit reversed
+ * order and preconRootOfUnityTable their Shoup precomputations.
+ * @return false, leaving element untouched, if the path is OFF or q is not
+ * below 2^62.
+ */
+bool NttSimdForward(uint64_t* element, uint32_t n, uint64_t q, const uint64_t* rootOfUnityTable,
+                    const uint64_t* preconRootOfUnityTable);
+
+/**
+ * In-place inverse transform from bit reversed order, scaled by
+ * cycloOrderInv (see NumberTheoreticTransformNat::InverseTransformFromBitReverseInPlace).
+ *
+ * @return false, leaving element untouched, if the path is OFF or q is not
+ * below 2^62.
+ */
+bool NttSimdInverse(uint64_t* element, uint32_t n, uint64_t q, const uint64_t* rootOfUnityInverseTable,
+                    const uint64_t* preconRootOfUnityInverseTable, uint64_t cycloOrderInv,
+                    uint64_t preconCycloOrderInv);
+
+}  // namespace intnat
+
+#endif
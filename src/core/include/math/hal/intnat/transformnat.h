@@ -39,9 +39,12 @@
 #include "math/hal/transform.h"
 
 #include "utils/inttypes.h"
+#include "pim/PimNtt.h"
 
 #include <map>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -241,6 +244,109 @@ public:
                                                VecType* element);
 };
 
+/**
+ * @brief Twiddle tables of the negacyclic NTT modulo a prime q in ring
+ * dimension n: the powers of the 2n-th root of unity and of its inverse in bit
+ * reversed order, their Shoup precomputations, and n^-1.
+ *
+ * A plan is immutable once built and shared: there is one per (q, n), built
+ * by the first Get and handed to every later caller, which keeps it with its
+ * params instead of looking the tables up on every transform. The first root
+ * of unity given for a (q, n) is the one all the transforms use.
+ */
+template <typename VecType>
+class NTTPlanNat {
+    using IntType = typename VecType::Integer;
+
+public:
+    /**
+   * Computes the tables, use Get to share them.
+   *
+   * @param &rootOfUnity is the 2n-th root of unity in Z_q.
+   * @param CycloOrder is a power-of-two, equal to 2n.
+   * @param &modulus is q, the prime modulus
+   */
+    NTTPlanNat(const IntType& rootOfUnity, usint CycloOrder, const IntType& modulus);
+
+    NTTPlanNat(const NTTPlanNat&)            = delete;
+    NTTPlanNat& operator=(const NTTPlanNat&) = delete;
+
+    /**
+   * The plan of (modulus, CycloOrder / 2), built on first use. Contexts may
+   * call it from several threads: a plan is built outside of the lock and
+   * the first one registered wins.
+   */
+    static std::shared_ptr<const NTTPlanNat> Get(const IntType& rootOfUnity, usint CycloOrder,
+                                                 const IntType& modulus);
+
+    /**
+   * The plan of (modulus, ringDimension) if one was built, nullptr otherwise.
+   */
+    static std::shared_ptr<const NTTPlanNat> Find(const IntType& modulus, usint ringDimension);
+
+    /**
+   * Forgets the plans, the ones still held (e.g. by params) stay valid.
+   */
+    static void Reset();
+
+    const IntType& GetModulus() const {
+        return m_modulus;
+    }
+
+    const IntType& GetRootOfUnity() const {
+        return m_rootOfUnity;
+    }
+
+    usint GetRingDimension() const {
+        return m_ringDimension;
+    }
+
+    const VecType& GetRootOfUnityTable() const {
+        return m_rootOfUnityTable;
+    }
+
+    const VecType& GetRootOfUnityPreconTable() const {
+        return m_rootOfUnityPreconTable;
+    }
+
+    const VecType& GetRootOfUnityInverseTable() const {
+        return m_rootOfUnityInverseTable;
+    }
+
+    const VecType& GetRootOfUnityInversePreconTable() const {
+        return m_rootOfUnityInversePreconTable;
+    }
+
+    // n^-1 mod q, which scales the inverse transform
+    const IntType& GetCycloOrderInverse() const {
+        return m_cycloOrderInverse;
+    }
+
+    const IntType& GetCycloOrderInversePrecon() const {
+        return m_cycloOrderInversePrecon;
+    }
+
+    /**
+   * Views the tables for the PIM NTT kernels (see PimManager::ntt_tables),
+   * valid while the plan lives.
+   */
+    PimNttTables GetPimTables() const;
+
+private:
+    IntType m_modulus;
+    IntType m_rootOfUnity;
+    usint m_ringDimension;
+    VecType m_rootOfUnityTable;
+    VecType m_rootOfUnityPreconTable;
+    VecType m_rootOfUnityInverseTable;
+    VecType m_rootOfUnityInversePreconTable;
+    IntType m_cycloOrderInverse;
+    IntType m_cycloOrderInversePrecon;
+
+    static std::shared_mutex m_plansLock;
+    static std::map<std::pair<IntType, usint>, std::shared_ptr<const NTTPlanNat>> m_plans;
+};
+
 /**
  * @brief Golden Chinese Remainder Transform FFT implementation.
  */
@@ -318,6 +424,24 @@ public:
    */
     void InverseTransformFromBitReverseInPlace(const IntType& rootOfUnity, const usint CycloOrder, VecType* element);
 
+    /**
+   * In-place forward transform with the tables of a plan, without looking
+   * them up.
+   *
+   * @param &plan is the plan of the modulus and length of element.
+   * @param[in,out] &element is the input to the transform of type VecType.
+   */
+    void ForwardTransformToBitReverseInPlace(const NTTPlanNat<VecType>& plan, VecType* element);
+
+    /**
+   * In-place inverse transform with the tables of a plan, without looking
+   * them up.
+   *
+   * @param &plan is the plan of the modulus and length of element.
+   * @param[in,out] &element is the input/output of the transform of type VecType.
+   */
+    void InverseTransformFromBitReverseInPlace(const NTTPlanNat<VecType>& plan, VecType* element);
+
     /**
    * Precomputation of root of unity tables for transforms in the ring
    * Z_q[X]/(X^n+1)
@@ -347,25 +471,16 @@ public:
    */
     void Reset();
 
-    /// map to store the cyclo order inverse with modulus as a key
-    /// For inverse FTT, we also need #m_cycloOrderInversePreconTableByModulus (this is to use an N-size NTT for FTT instead of 2N-size NTT).
-    static std::map<IntType, VecType> m_cycloOrderInverseTableByModulus;
-
-    /// map to store the cyclo order inverse preconditioned with modulus as a key
-    /// Shoup's precomputation of above #m_cycloOrderInverseTableByModulus
-    static std::map<IntType, VecType> m_cycloOrderInversePreconTableByModulus;
-
-    /// map to store the forward roots of Unity for NTT, with bits reversed, with modulus as a key (aka twiddle factors)
-    static std::map<IntType, VecType> m_rootOfUnityReverseTableByModulus;
-
-    /// map to store inverse roots of unity for iNTT, with bits reversed, with modulus as a key (aka inverse twiddle factors)
-    static std::map<IntType, VecType> m_rootOfUnityInverseReverseTableByModulus;
-
-    /// map to store Shoup's precomputations of forward roots of unity for NTT, with bits reversed, with modulus as a key
-    static std::map<IntType, VecType> m_rootOfUnityPreconReverseTableByModulus;
-
-    /// map to store Shoup's precomputations of inverse rou for iNTT, with bits reversed, with modulus as a key
-    static std::map<IntType, VecType> m_rootOfUnityInversePreconReverseTableByModulus;
+    /**
+   * Views the precomputed tables of a modulus for the PIM NTT kernels, which
+   * transform pinned vectors on the DPUs and polynomials inside the
+   * bootstrapping kernels. The plan of the modulus must have been built, e.g.
+   * by a transform modulo that modulus, or a math_error is thrown.
+   *
+   * @param &modulus is the modulus the tables were precomputed for.
+   * @param CycloOrderHf is the ring dimension n.
+   */
+    static PimNttTables PimTables(const IntType& modulus, usint CycloOrderHf);
 };
 
 // struct used as a key in BlueStein transform
@@ -108,6 +108,8 @@ public:
         if ((a.GetLength() != b.GetLength()) || (a.GetModulus() != b.GetModulus())) {
             return false;
         }
+        a.SyncToHost();
+        b.SyncToHost();
         for (usint i = 0; i < a.GetLength(); ++i) {
             if (a[i] != b[i]) {
                 return false;
@@ -134,6 +136,12 @@ public:
     I& operator[](size_t idx);
     const I& operator[](size_t idx) const;
 
+    // A vector with a device mirror brings its host copy up to date, before
+    // element-wise reads and writes respectively (see NativeVectorT). The host
+    // only vectors have nothing to do.
+    void SyncToHost() const {}
+    void PrepareHostWrite() {}
+
     /**
    * Sets the vector modulus.
    *
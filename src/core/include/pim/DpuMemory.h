@@ -1,83 +1,118 @@
+#ifndef _PIM_DPU_MEMORY_
+#define _PIM_DPU_MEMORY_
+
 #include "common.h"
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <set>
 #include <sys/types.h>
 #include <vector>
 
 #define CHUNK_SIZE (64 * 1024 * 1024) // 64 MB
-#define BLOCK_SIZE (4 * 1024)         // 4k blocks within each chunk
+#define BLOCK_SIZE (4 * 1024)         // smallest block handed out, 4k
 
+/**
+ * DpuMemory manages an MRAM heap with a buddy allocator. The heap is cut in
+ * power of two blocks of at least BLOCK_SIZE bytes, the free ones are kept in
+ * one sorted list per order. An allocation splits the smallest free block
+ * that fits and a deallocation merges the block with its buddy for as long as
+ * the buddy is free, so both are logarithmic in the number of blocks instead
+ * of scanning the whole heap.
+ *
+ * PimManager keeps a single DpuMemory for the whole DPU set: a mirror sits at
+ * the same offset in the MRAM of every DPU, one allocation decision holds for
+ * all of them.
+ */
 class DpuMemory {
 public:
-  DpuMemory() : free_blocks(TOTAL_BLOCKS, true) {}
+  DpuMemory() : free_lists(MAX_ORDER + 1) { free_lists[MAX_ORDER].insert(0); }
 
   ~DpuMemory() {}
 
+  /**
+   * @param size bytes needed, rounded up to a power of two block
+   * @return offset of the block in the heap, -1 if no block is large enough
+   */
   int32_t allocate(size_t size) {
     if (size > CHUNK_SIZE) {
       return -1;
     }
-    size_t blocks_needed = DIVROUNDUP(size, BLOCK_SIZE);
-    int32_t start_block = find_free_blocks(blocks_needed);
-    if (start_block == -1) {
+    uint32_t order = order_of(size);
+    uint32_t k = order;
+    while (k <= MAX_ORDER && free_lists[k].empty())
+      ++k;
+    if (k > MAX_ORDER) {
       return -1;
     }
-    mark_blocks(start_block, blocks_needed, false);
-    uint32_t addr = start_block * BLOCK_SIZE;
-    allocations[addr] = blocks_needed;
+
+    // The lowest free block keeps the heap compact
+    uint32_t addr = *free_lists[k].begin();
+    free_lists[k].erase(free_lists[k].begin());
+    // Splits down to the requested order, the upper halves stay free
+    while (k > order) {
+      --k;
+      free_lists[k].insert(addr + block_bytes(k));
+    }
+    allocations[addr] = order;
+    used += block_bytes(order);
     return addr;
   }
 
-  void deallocate(uint32_t addr) {
-    if (allocations.find(addr) != allocations.end()) {
-      size_t start_block = DIV(addr, BLOCK_SIZE);
-      size_t blocks_to_free = allocations[addr];
-      mark_blocks(start_block, blocks_to_free, true);
-      allocations.erase(addr);
-    } else {
-      std::cerr << "Invalid address to deallocate.\n";
+  // false if addr is not the offset of an allocated block
+  bool deallocate(uint32_t addr) {
+    auto it = allocations.find(addr);
+    if (it == allocations.end())
+      return false;
+    uint32_t order = it->second;
+    allocations.erase(it);
+    used -= block_bytes(order);
+
+    while (order < MAX_ORDER) {
+      auto buddy = free_lists[order].find(addr ^ block_bytes(order));
+      if (buddy == free_lists[order].end())
+        break;
+      addr = std::min(addr, *buddy);
+      free_lists[order].erase(buddy);
+      ++order;
     }
+    free_lists[order].insert(addr);
+    return true;
   }
 
-  void display_status() const {
-    const std::string red("\033[31m");
-    const std::string reset("\033[0m");
+  // Bytes handed out, including the rounding to the block sizes
+  size_t bytes_in_use() const { return used; }
 
-    for (size_t i = 0; i < TOTAL_BLOCKS; ++i) {
-      if (free_blocks[i]) {
-        std::cout << "Free ";
-      } else {
-        std::cout << red << "Aloc" << reset << " ";
-      }
-      if ((i + 1) % 16 == 0)
-        std::cout << "\n";
+  void display_status() const {
+    std::cout << "In use: " << used << " of " << CHUNK_SIZE << " bytes, "
+              << allocations.size() << " blocks\n";
+    for (uint32_t k = 0; k <= MAX_ORDER; ++k) {
+      if (!free_lists[k].empty())
+        std::cout << "Free " << block_bytes(k) << " byte blocks: "
+                  << free_lists[k].size() << "\n";
     }
   }
 
 private:
-  static const size_t TOTAL_BLOCKS = DIV(CHUNK_SIZE, BLOCK_SIZE);
-  std::vector<bool> free_blocks;
-  std::map<uint32_t, size_t> allocations;
+  static const uint32_t MAX_ORDER = 14; // BLOCK_SIZE << MAX_ORDER == CHUNK_SIZE
+  static_assert((size_t(BLOCK_SIZE) << MAX_ORDER) == CHUNK_SIZE,
+                "the heap must be a power of two number of blocks");
 
-  size_t find_free_blocks(size_t blocks_needed) {
-    size_t consecutive_free = 0;
-    for (size_t i = 0; i < TOTAL_BLOCKS; ++i) {
-      if (free_blocks[i]) {
-        ++consecutive_free;
-        if (consecutive_free == blocks_needed) {
-          return i - blocks_needed + 1;
-        }
-      } else {
-        consecutive_free = 0;
-      }
-    }
-    return -1;
+  static size_t block_bytes(uint32_t order) {
+    return size_t(BLOCK_SIZE) << order;
   }
 
-  void mark_blocks(size_t start_block, size_t blocks_needed, bool free) {
-    for (size_t i = start_block; i < start_block + blocks_needed; ++i) {
-      free_blocks[i] = free;
-    }
+  static uint32_t order_of(size_t size) {
+    uint32_t order = 0;
+    while (block_bytes(order) < size)
+      ++order;
+    return order;
   }
-};
\ No newline at end of file
+
+  std::vector<std::set<uint32_t>> free_lists;
+  std::map<uint32_t, uint32_t> allocations; // offset -> order
+  size_t used = 0;
+};
+
+#endif //_PIM_DPU_MEMORY_
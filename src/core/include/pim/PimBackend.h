@@ -0,0 +1,114 @@
+#ifndef _PIM_BACKEND_
+#define _PIM_BACKEND_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Symbol of the MRAM heap, the same name as the UPMEM runtime uses
+#ifndef DPU_MRAM_HEAP_POINTER_NAME
+#define DPU_MRAM_HEAP_POINTER_NAME "__sys_used_mram_end"
+#endif
+
+// DPUs of an emulated rank. A hardware rank has 64, but every emulated DPU
+// costs its own tasklet threads and MRAM on the host.
+#define EMU_RANK_DPUS 4
+
+/*
+  Transfer and launch counters kept by PimManager, whatever the backend. The
+  times are only measured while timing is on (see PimManager::set_timing):
+  they are the time the DPU set spent on the operations, from the moment an
+  operation reached the head of the queue to its completion.
+*/
+struct PimCounters {
+  uint64_t loads = 0;
+  uint64_t launches = 0;
+  uint64_t xfers_to_pim = 0;
+  uint64_t xfers_from_pim = 0;
+  uint64_t bytes_to_pim = 0;
+  uint64_t bytes_from_pim = 0;
+  uint64_t load_ns = 0;
+  uint64_t launch_ns = 0;
+  uint64_t to_pim_ns = 0;
+  uint64_t from_pim_ns = 0;
+  // Most MRAM bytes in use on each DPU since the counters were reset
+  uint64_t mram_high_water = 0;
+};
+
+/**
+ * PimBackend is what PimManager drives to reach the DPUs. The UPMEM backend
+ * wraps the dpu.h runtime (real ranks or the UPMEM simulator), the emulator
+ * backend runs the resident kernels compiled for the host with a thread per
+ * DPU, so the PIM paths can be exercised on machines without the SDK.
+ *
+ * Operations are executed in submission order; asynchronous ones return
+ * right away and the synchronous ones wait for everything queued before them.
+ */
+class PimBackend {
+public:
+  virtual ~PimBackend() = default;
+
+  virtual uint32_t get_nr_dpus() const = 0;
+
+  // "upmem" or "emulator", as selected by PIM_BACKEND
+  virtual std::string name() const = 0;
+
+  // Loads a DPU program on the whole set
+  virtual void load(const std::string &binary) = 0;
+
+  virtual void launch(bool async) = 0;
+
+  /**
+   * Prepared transfer, bufs[i] is the buffer of the i-th DPU of the set and
+   * DPUs with a nullptr entry are left out.
+   * @param to_pim direction of the transfer
+   * @param symbol WRAM symbol or DPU_MRAM_HEAP_POINTER_NAME for the MRAM heap
+   * @param offset offset in the symbol
+   * @param bytes bytes transferred for each DPU
+   */
+  virtual void xfer(const std::vector<void *> &bufs, bool to_pim,
+                    const std::string &symbol, uint32_t offset, uint32_t bytes,
+                    bool async) = 0;
+
+  // Same buffer to every DPU of the set
+  virtual void broadcast(const std::string &symbol, uint32_t offset,
+                         const void *buf, uint32_t bytes, bool async) = 0;
+
+  // fn is called once every operation submitted before it has completed
+  virtual void callback(std::function<void()> fn) = 0;
+
+  // Blocks until every submitted operation has completed
+  virtual void sync() = 0;
+
+  // Dumps the printf output of the last launch of every DPU
+  virtual void log(FILE *out) = 0;
+
+  /**
+   * Creates the backend selected by the PIM_BACKEND environment variable,
+   * "upmem" or "emulator". Without it the UPMEM runtime is used when the
+   * library is built with RUN_ON_DPU, the emulator otherwise.
+   */
+  static std::unique_ptr<PimBackend> create(uint32_t nr_dpus,
+                                            const std::string &profile);
+
+  /**
+   * Same as create for a set of nr_ranks whole ranks, which no other set
+   * shares: its transfers and launches never wait for another set's.
+   * @throw std::runtime_error if the ranks are not available
+   */
+  static std::unique_ptr<PimBackend> create_ranks(uint32_t nr_ranks,
+                                                  const std::string &profile);
+};
+
+std::unique_ptr<PimBackend> make_upmem_backend(uint32_t nr_dpus,
+                                               const std::string &profile);
+
+std::unique_ptr<PimBackend> make_upmem_rank_backend(uint32_t nr_ranks,
+                                                    const std::string &profile);
+
+std::unique_ptr<PimBackend> make_emulator_backend(uint32_t nr_dpus);
+
+#endif //_PIM_BACKEND_
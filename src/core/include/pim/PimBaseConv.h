@@ -0,0 +1,22 @@
+#ifndef _PIM_BASE_CONV_
+#define _PIM_BASE_CONV_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Precomputed tables of the fast base conversion from the towers over
+ * q_0..q_{size_q-1} to the towers over p_0..p_{size_p-1}, as passed to
+ * DCRTPolyImpl::ApproxSwitchCRTBasis. PimManager::base_conv_tables uploads
+ * them in the layout of the DPU kernel (see struct pim_base_conv).
+ */
+struct PimBaseConvTables {
+  std::vector<uint64_t> q;                // moduli of the input towers
+  std::vector<uint64_t> q_hat_inv;        // [(Q/q_i)^-1]_{q_i}
+  std::vector<uint64_t> q_hat_inv_precon; // their Shoup precomputations
+  std::vector<uint64_t> p;                // moduli of the output towers
+  std::vector<unsigned __int128> p_mu;    // floor(2^128 / p_j)
+  std::vector<uint64_t> q_hat_modp;       // [Q/q_i]_{p_j} at i * size_p + j
+};
+
+#endif //_PIM_BASE_CONV_
@@ -0,0 +1,81 @@
+#ifndef _PIM_BLIND_ROTATE_
+#define _PIM_BLIND_ROTATE_
+
+#include "PimNtt.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class PimManager;
+
+// MRAM taken by a block of the bootstrapping key, the buddy heap of the DPUs
+// hands out power of two blocks and a whole key would round up to the heap
+#ifndef PIM_BOOT_KEY_BLOCK
+#define PIM_BOOT_KEY_BLOCK (8 * 1024 * 1024)
+#endif
+
+/**
+ * Bootstrapping key of the CGGI accumulator with the parameters of its ring,
+ * as RingGSWAccumulatorCGGI uses them (see struct pim_blind_rotate for the
+ * image the DPUs keep). Q must fit in 32 bits.
+ */
+struct PimBootKey {
+  uint64_t modulus = 0; // Q
+  uint32_t N = 0;       // ring dimension
+  uint32_t n = 0;       // LWE dimension
+  uint32_t digits = 0;  // 2 (d_g - 1)
+  uint32_t g_bits = 0;  // log2 of the gadget base
+  PimNttTables ntt;     // NTT tables of Q for dimension N
+  // [2N] the monomials X^e - 1 at the first slot of the evaluation form
+  std::vector<uint64_t> monomials;
+  // [N] the exponent e_j such that X at the slot j is X^e_j at the first slot
+  std::vector<uint32_t> exponents;
+  // Writes the 2 digits 2 N words of the RGSW rows of the LWE coefficient i,
+  // called once per coefficient when the key is uploaded
+  std::function<void(uint32_t i, uint32_t *rows)> rows;
+
+  // Bytes of the RGSW rows of one LWE coefficient
+  size_t row_bytes() const {
+    return size_t(2) * digits * 2 * N * sizeof(uint32_t);
+  }
+
+  // LWE coefficients of a block of the key in MRAM
+  uint32_t per_block() const {
+    size_t fit = PIM_BOOT_KEY_BLOCK / row_bytes();
+    return uint32_t(std::max<size_t>(1, std::min<size_t>(fit, n)));
+  }
+};
+
+// Ciphertext of a gate bootstrapping, after the additive gate operation
+struct PimGateInput {
+  std::vector<uint32_t> index; // (-a_i mod q) 2N / q
+  uint64_t b = 0;
+  uint64_t q = 0;
+  uint64_t q1 = 0; // [q1, q2) is mapped to -Q/8, the rest to Q/8
+  uint64_t q2 = 0;
+  uint64_t q2p = 0; // Q / 2p + 1
+};
+
+// Extracted LWE ciphertext modulo Q, under the transposed key
+struct PimGateOutput {
+  std::vector<uint64_t> a;
+  uint64_t b = 0;
+};
+
+/**
+ * Blind rotations of a batch of gate bootstrappings on the DPUs of pim, one
+ * bootstrap per DPU and launch. The key is uploaded to every DPU on the first
+ * call for owner and stays in MRAM for as long as owner lives (see
+ * PimManager::boot_key), only the ciphertexts move afterwards.
+ * @return false if the MRAM cannot hold the key or the scratch of the
+ * launches, nothing ran then
+ */
+bool pim_blind_rotate(PimManager &pim,
+                      const std::shared_ptr<const void> &owner,
+                      const PimBootKey &key,
+                      const std::vector<PimGateInput> &inputs,
+                      std::vector<PimGateOutput> &outputs);
+
+#endif //_PIM_BLIND_ROTATE_
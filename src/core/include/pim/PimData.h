@@ -2,169 +2,869 @@
 #define _PIM_DATA_
 
 #include "PimManager.h"
+#include "PimModArith.h"
+#include "PimRescale.h"
+#include "PimUniform.h"
 #include "kernel.h"
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
-#include <initializer_list>
 #include <iostream>
 #include <limits>
+#include <mutex>
+#include <stdexcept>
 #include <stdint.h>
 #include <sys/types.h>
 
+/**
+ * Layout of a mirror on its DPU set. SPREAD slices it over every DPU; WHOLE
+ * puts it on the DPU with the least MRAM taken by whole mirrors when it is
+ * materialized on its own, or falls back to SPREAD if that DPU cannot hold
+ * it. A mirror materialized next to another one takes its placement.
+ */
+enum class PimLayout { SPREAD, WHOLE };
+
+/**
+ * PimData is the device mirror of a host buffer. It is materialized lazily:
+ * constructing one costs nothing on the DPUs, the MRAM is only allocated when
+ * the data is pinned or an offloaded operation touches it. The validity of the
+ * host and the device copies is tracked separately so that a transfer only
+ * happens when the destination is really stale.
+ *
+ * PimData does not own the host buffer, the caller passes it on every
+ * transfer (for NativeVectorT this is m_data). Each DPU holds a slice of
+ * PimManager::slice_words(size) words; when size does not split evenly the
+ * slices at the end are zero padded on the DPUs, so the kernels never see a
+ * partial slice and the padding never reaches the host buffer.
+ *
+ * A mirror of the WHOLE layout sits whole on one DPU instead, the other DPUs
+ * of the set skip the kernels on it. Its operations, the NTT included, then
+ * never leave that DPU, and the towers of a polynomial placed together (see
+ * place_near) are base converted and rescaled there as well.
+ */
 class PimData {
 public:
-  PimData(std::initializer_list<uint64_t> data) : host_data(data) {
-    pim = PimManager::getPim(4);
-    size = data.size();
-    metadata = pim->allocate(size);
-    pim->copy_to_pim(host_data.data(), size, metadata[0].second);
-  };
-
-  PimData(uint64_t size_set) : size(size_set) {
-    pim = PimManager::getPim(1);
-    metadata = pim->allocate(size);
-  };
+  PimData() = default;
 
-  PimData(){};
+  explicit PimData(uint32_t size_set,
+                   PimLayout layout_set = PimLayout::SPREAD)
+      : size(size_set), layout(layout_set) {}
 
-  ~PimData() { pim->deallocate(metadata); }
+  // A copy never shares the MRAM of its source, it starts as a host only
+  // mirror of the same size and is materialized on first use.
+  PimData(const PimData &rhs) : size(rhs.size), layout(rhs.layout) {}
 
-  void sync() {
-    pim->copy_from_pim(host_data.data(), size, metadata[0].second);
+  PimData(PimData &&rhs) noexcept
+      : size(rhs.size), layout(rhs.layout), home(rhs.home), pim(rhs.pim),
+        metadata(std::move(rhs.metadata)), host_valid(rhs.host_valid.load()),
+        pim_valid(rhs.pim_valid) {
+    rhs.reset();
   }
 
+  ~PimData() { release(); }
+
   PimData &operator=(const PimData &rhs) {
     if (this != &rhs) {
+      release();
+      size = rhs.size;
+      layout = rhs.layout;
+    }
+    return *this;
+  }
+
+  PimData &operator=(PimData &&rhs) noexcept {
+    if (this != &rhs) {
+      release();
       size = rhs.size;
+      layout = rhs.layout;
+      home = rhs.home;
       pim = rhs.pim;
-      metadata.resize(rhs.metadata.size());
-      std::copy(rhs.metadata.begin(), rhs.metadata.end(), metadata.begin());
+      metadata = std::move(rhs.metadata);
+      host_valid = rhs.host_valid.load();
+      pim_valid = rhs.pim_valid;
+      rhs.reset();
     }
     return *this;
   }
 
+  // Residency state
+  bool is_materialized() const { return !metadata.empty(); }
+  bool host_stale() const { return !host_valid; }
+  bool pim_stale() const { return !pim_valid; }
+  uint32_t get_size() const { return size; }
+  PimLayout get_layout() const { return layout; }
+  // Whether the mirror sits whole on a single DPU
+  bool is_whole() const { return home >= 0; }
+
+  /**
+   * Sets the layout the mirror is materialized with. A mirror materialized
+   * with another layout is released, its host copy must be current.
+   */
+  void set_layout(PimLayout layout_set) {
+    if (layout_set == layout)
+      return;
+    release();
+    layout = layout_set;
+  }
+
+  /**
+   * Allocates the MRAM for the mirror if it does not exist yet, as its
+   * layout says. The content of a freshly materialized mirror is undefined,
+   * hence it is not valid.
+   * @param on DPU set of the mirror, PimManager::current() by default
+   */
+  void materialize(PimManager *on = nullptr) {
+    if (is_materialized())
+      return;
+    PimManager *set = on != nullptr ? on : PimManager::current();
+    if (layout == PimLayout::WHOLE && size != 0 &&
+        materialize_on(set, set->least_loaded()))
+      return;
+    materialize_spread(set);
+  }
+
+  /**
+   * Materializes the mirror where like is, on its DPU set and, for a whole
+   * mirror, on its DPU: the result of an operation next to its operands.
+   */
+  void materialize_like(const PimData &like) {
+    if (is_materialized())
+      return;
+    if (!like.is_whole())
+      materialize_spread(like.pim);
+    else if (!materialize_on(like.pim, like.home))
+      throw std::runtime_error("PimData: MRAM allocation failed");
+  }
+
+  /**
+   * Materializes the mirror next to like, e.g. a tower next to the first
+   * tower of its polynomial, or as materialize does if like is not
+   * materialized or its DPU cannot hold the mirror.
+   */
+  void place_near(const PimData &like) {
+    if (is_materialized())
+      return;
+    if (like.is_whole() && size != 0 && materialize_on(like.pim, like.home))
+      return;
+    materialize(like.pim);
+  }
+
+  /**
+   * Makes the device copy current, transferring from buf only if the device
+   * copy is stale.
+   * @param buf host buffer holding size elements
+   */
+  void to_pim(const uint64_t *buf) {
+    materialize();
+    if (pim_valid)
+      return;
+    if (!is_whole())
+      pim->copy_to_pim(const_cast<uint64_t *>(buf), size, metadata[0].second);
+    else if (size != 0)
+      pim->scatter_to_pim(home_bufs<const void>(buf), size * sizeof(uint64_t),
+                          metadata[0].second);
+    pim_valid = true;
+  }
+
+  /**
+   * Makes the host copy current, transferring into buf only if an offloaded
+   * operation left the device copy newer.
+   * @param buf host buffer holding size elements
+   */
+  void to_host(uint64_t *buf) {
+    if (host_valid.load(std::memory_order_acquire))
+      return;
+    // The threads of an OpenMP team may read the same stale mirror: the first
+    // one transfers, the others wait for it instead of writing buf again. The
+    // pulls of different mirrors go on concurrently.
+    std::lock_guard<std::mutex> guard(pull_lock);
+    if (host_valid.load(std::memory_order_relaxed))
+      return;
+    if (!is_whole())
+      pim->copy_from_pim(buf, size, metadata[0].second);
+    else if (size != 0)
+      pim->gather_from_pim(home_bufs<void>(buf), size * sizeof(uint64_t),
+                           metadata[0].second);
+    host_valid.store(true, std::memory_order_release);
+  }
+
+  /**
+   * Moves the mirror next to lead, through buf, when both are on the same
+   * DPU set but placed differently, e.g. the towers of two polynomials held
+   * whole by different DPUs. The mirror then stays there, the next
+   * operations with lead need no move. The mirrors of other sets are left
+   * alone.
+   * @param buf host buffer holding size elements
+   */
+  void follow(const PimData &lead, uint64_t *buf) {
+    if (!is_materialized() || !lead.is_materialized() || pim != lead.pim ||
+        home == lead.home)
+      return;
+    to_host(buf);
+    release();
+    materialize_like(lead);
+    to_pim(buf);
+  }
+
+  // The host copy was written, the device copy (if any) is now stale.
+  void host_modified() {
+    host_valid = true;
+    pim_valid = false;
+  }
+
+  // An offloaded operation wrote the device copy, the host copy is now stale.
+  void pim_modified() {
+    host_valid = false;
+    pim_valid = true;
+  }
+
+  /**
+   * Makes this mirror a copy of src on the DPUs, without going through the
+   * host. src must be current on the device; the host copy of this mirror is
+   * as current as the one of src once the caller has copied the host buffer.
+   */
+  void copy_on_pim(const PimData &src) {
+    if (src.size != size)
+      throw std::invalid_argument("PimData: copy between different sizes");
+    // The mirror is overwritten, it may as well move next to src
+    if (pim == src.pim && home != src.home)
+      release();
+    materialize_like(src);
+    same_place(src);
+    struct pim_meta header;
+    struct mod_add_sub_mult &meta = header.args.elem;
+    header.opcode = OP_MEM_COPY;
+    meta.op1.start = src.metadata[0].second;
+    meta.op1.size = slice_bytes(size);
+    meta.op2.start = 0;
+    meta.op2.size = 0;
+    meta.res.start = metadata[0].second;
+    meta.res.size = meta.op1.size;
+    meta.mod = 0;
+    meta.mu = 0;
+    meta.precon = 0;
+    meta.kernel = VECTOR;
+    submit(header);
+    host_valid = src.host_valid.load();
+    pim_valid = true;
+  }
+
+  /**
+   * Negacyclic NTT of the mirror in place, forward (to bit reversed order) or
+   * inverse. A whole mirror is transformed by its DPU alone, only the device
+   * copy is current afterwards. A spread one is transformed slice by slice
+   * on every DPU, the stages crossing the slices running on the host copy
+   * (see struct pim_ntt) at the cost of a round trip through buf; the device
+   * copy is current afterwards, the host one only if the host ran the last
+   * stages.
+   * @param buf host buffer holding size elements
+   * @return false if size is not a power of two of at least two words, or
+   * for a spread mirror does not split in such slices over a power of two
+   * number of DPUs, nothing is done then
+   */
+  bool ntt(bool inverse, uint64_t modulus, const PimNttTables &tables,
+           uint64_t *buf) {
+    if ((size & (size - 1)) != 0 || size < 2)
+      return false;
+    materialize();
+
+    struct pim_meta header;
+    struct pim_ntt &meta = header.args.ntt;
+    header.opcode = inverse ? OP_NTT_INVERSE : OP_NTT_FORWARD;
+    meta.data.start = metadata[0].second;
+    meta.n = size;
+    if (is_whole()) {
+      to_pim(buf);
+      std::vector<struct pim_tower> info =
+          placed(modulus, pim->ntt_tables(modulus, size, tables));
+      meta.data.size = size * sizeof(uint64_t);
+      meta.groups = 1;
+      submit(header, &info);
+      pim_modified();
+      return true;
+    }
+
+    uint32_t groups = pim->getNumDpus();
+    if ((groups & (groups - 1)) != 0 || size < 2 * groups)
+      return false;
+
+    if (!inverse && groups > 1) {
+      to_host(buf);
+      pim_ntt_forward_cross_stages(buf, size, groups, modulus, tables);
+      host_modified();
+    }
+    to_pim(buf);
+
+    std::vector<struct pim_tower> info(groups, pim_tower{});
+    uint32_t twiddles = pim->ntt_tables(modulus, size, tables);
+    for (uint32_t i = 0; i < groups; ++i) {
+      info[i].mod = modulus;
+      info[i].mu = pim_barrett_mu(modulus);
+      info[i].slice = i;
+      info[i].valid = 1;
+      info[i].twiddles = twiddles;
+    }
+    meta.data.size = slice_bytes(size);
+    meta.groups = groups;
+    // Descriptions and launch go in together, another thread may be
+    // pushing descriptions of its own
+    submit(header, &info);
+    pim_modified();
+
+    if (inverse && groups > 1) {
+      to_host(buf);
+      pim_ntt_inverse_cross_stages(buf, size, groups, modulus, tables);
+      host_modified();
+      to_pim(buf);
+    }
+    return true;
+  }
+
+  /**
+   * Automorphism k of the evaluation form of the tower, in bit reversed
+   * order, into out (see struct pim_automorphism), which is materialized next
+   * to the mirror. A whole mirror is permuted by its DPU, out is then current
+   * on the DPUs only. Otherwise each DPU permutes its own slice, the slices
+   * of the result are then exchanged between the DPUs through out_buf, which
+   * leaves both copies of out current. With a single DPU, or when every
+   * slice stays on its DPU, out is current on the DPUs only.
+   * @param buf host buffer of the mirror, pushed if the device copy is stale
+   * @param out_buf host buffer of out, holding size elements
+   * @return false if k is even, or if size does not split in slices of an
+   * even number of words mapped to one another, nothing is done then
+   */
+  bool automorphism(uint32_t k, const uint64_t *buf, PimData &out,
+                    uint64_t *out_buf) {
+    if (k % 2 == 0 || (size & (size - 1)) != 0 || out.size != size ||
+        &out == this)
+      return false;
+    materialize();
+    uint32_t groups = is_whole() ? 1 : pim->getNumDpus();
+    std::vector<uint32_t> slices;
+    int32_t maps = pim->automorphism_maps(k, size, groups, slices);
+    if (maps == -1)
+      return false;
+
+    to_pim(buf);
+    // out is overwritten, it may as well move next to the mirror
+    if (out.pim == pim && out.home != home)
+      out.release();
+    out.materialize_like(*this);
+    same_place(out);
+
+    uint32_t len = size / groups;
+    struct pim_meta header;
+    struct pim_automorphism &meta = header.args.autom;
+    header.opcode = OP_AUTOMORPHISM;
+    meta.in = metadata[0].second;
+    meta.out = out.metadata[0].second;
+    meta.map = maps;
+    meta.len = len;
+    submit(header);
+    out.pim_modified();
+
+    bool moved = false;
+    for (uint32_t s = 0; s < groups; ++s)
+      moved |= slices[s] != s;
+    if (moved) {
+      std::vector<void *> bufs(groups);
+      for (uint32_t s = 0; s < groups; ++s)
+        bufs[s] = out_buf + size_t(slices[s]) * len;
+      pim->gather_from_pim(bufs, len * sizeof(uint64_t), meta.out);
+      out.host_modified();
+      out.to_pim(out_buf);
+    }
+    return true;
+  }
+
+  /**
+   * Fast base conversion of the towers of a polynomial over the q_i, mirrored
+   * by in, into the towers over the p_j mirrored by out (see struct
+   * pim_base_conv), with the tables uploaded once per DPU set. The towers
+   * stay where they are in MRAM: the DPU holding whole towers in converts
+   * them whole, spread ones are converted slice by slice on every DPU. The
+   * towers out are materialized next to the towers in, the results are
+   * current on the DPUs only.
+   * @param bufs host buffers of the towers in, pushed if their device copy
+   * is stale
+   * @return false if the towers are not all of the same length, or the
+   * towers in are not all placed alike, before anything is moved or written
+   */
+  static bool base_conv(const std::vector<PimData *> &in,
+                        const std::vector<const uint64_t *> &bufs,
+                        const std::vector<PimData *> &out,
+                        const PimBaseConvTables &tables) {
+    if (tables.q.size() != in.size() || tables.p.size() != out.size())
+      throw std::invalid_argument("PimData: base conversion tables mismatch");
+    if (in.empty() || out.empty())
+      return false;
+    PimManager *manager =
+        in[0]->is_materialized() ? in[0]->pim : PimManager::current();
+    uint32_t groups = manager->getNumDpus();
+    uint32_t n = in[0]->size;
+    if (n == 0)
+      return false;
+    for (auto *data : in)
+      if (data->size != n || data->pim != in[0]->pim ||
+          data->home != in[0]->home)
+        return false;
+    for (auto *data : out)
+      if (data->size != n)
+        return false;
+
+    // Nothing was touched until here
+    in[0]->materialize(manager);
+    for (size_t i = 0; i < in.size(); ++i) {
+      in[i]->materialize_like(*in[0]);
+      in[i]->to_pim(bufs[i]);
+    }
+    // The towers out are overwritten, they may as well move next to in
+    for (auto *data : out) {
+      if (data->pim == manager && data->home != in[0]->home)
+        data->release();
+      data->materialize_like(*in[0]);
+      data->same_place(*in[0]);
+    }
+
+    // The towers sit at the same offsets on every DPU, each DPU gets its own
+    // copy of the list
+    uint32_t towers = in.size() + out.size();
+    std::vector<uint64_t> offsets(size_t(towers) * groups);
+    for (uint32_t d = 0; d < groups; ++d) {
+      for (size_t i = 0; i < in.size(); ++i)
+        offsets[d * towers + i] = in[i]->metadata[0].second;
+      for (size_t j = 0; j < out.size(); ++j)
+        offsets[d * towers + in.size() + j] = out[j]->metadata[0].second;
+    }
+    PimData list(towers * groups);
+    list.materialize(manager);
+    list.to_pim(offsets.data());
+
+    struct pim_meta header;
+    struct pim_base_conv &meta = header.args.conv;
+    header.opcode = OP_BASE_CONV;
+    meta.towers = list.metadata[0].second;
+    meta.tables = manager->base_conv_tables(tables);
+    meta.size_q = in.size();
+    meta.size_p = out.size();
+    meta.len = in[0]->slice_words(n);
+    meta.pad = 0;
+    std::vector<struct pim_tower> info;
+    if (in[0]->is_whole())
+      info = in[0]->placed(0);
+    list.submit(header, info.empty() ? nullptr : &info);
+
+    // Freeing the list before the kernel ran is fine, a later transfer to
+    // its MRAM is queued behind the launch
+    for (auto *data : out)
+      data->pim_modified();
+    return true;
+  }
+
+  /**
+   * Weighted sum out = sum_i weights[i] in[i] mod mod on the DPUs, with the
+   * fused multiply-accumulate kernel (see struct pim_mac): one launch per
+   * PIM_MAC_TERMS terms instead of a product and a sum per term. out is
+   * materialized next to the terms, the result is current on the DPUs only.
+   * @param bufs host buffers of the vectors in, pushed if their device copy
+   * is stale
+   * @return false if the vectors are not all of the length of out, out is
+   * one of the terms, the terms are not all placed alike or mod is wider
+   * than 62 bits, nothing is done then
+   */
+  static bool mac(const std::vector<PimData *> &in,
+                  const std::vector<const uint64_t *> &bufs,
+                  const std::vector<uint64_t> &weights, uint64_t mod,
+                  PimData &out) {
+    if (weights.size() != in.size())
+      throw std::invalid_argument("PimData: a weight per term is needed");
+    if (in.empty() || mod == 0 || mod >> 62 != 0)
+      return false;
+    PimManager *manager =
+        in[0]->is_materialized() ? in[0]->pim : PimManager::current();
+    uint32_t n = out.size;
+    if (n == 0)
+      return false;
+    for (auto *data : in)
+      if (data->size != n || data == &out)
+        return false;
+
+    for (auto *data : in) {
+      data->materialize(manager);
+      data->same_set(*in[0]);
+      if (data->home != in[0]->home)
+        return false;
+    }
+    for (size_t i = 0; i < in.size(); ++i)
+      in[i]->to_pim(bufs[i]);
+    // out is overwritten, it may as well move next to the terms
+    if (out.pim == manager && out.home != in[0]->home)
+      out.release();
+    out.materialize_like(*in[0]);
+    out.same_place(*in[0]);
+
+    struct pim_meta header;
+    struct pim_mac &meta = header.args.mac;
+    header.opcode = OP_MAC;
+    meta.mod = mod;
+    meta.res = out.metadata[0].second;
+    meta.len = out.slice_words(n);
+    for (size_t first = 0; first < in.size(); first += PIM_MAC_TERMS) {
+      meta.count = std::min<size_t>(PIM_MAC_TERMS, in.size() - first);
+      meta.accumulate = first != 0;
+      for (uint32_t i = 0; i < meta.count; ++i) {
+        uint64_t w = weights[first + i] % mod;
+        meta.ops[i] = in[first + i]->metadata[0].second;
+        meta.weights[i] = w;
+        meta.precons[i] = pim_shoup_precon(w, mod);
+      }
+      out.submit(header);
+    }
+    out.pim_modified();
+    return true;
+  }
+
+  /**
+   * Rescale of the towers x by the tower last, in the coefficient form, on
+   * the DPUs (see struct pim_rescale). Each DPU lifts its slice of last to
+   * the modulus of every other tower:
+   *   RESCALE_FUSED  x_i = x_i q_inv_i + [last]_{q_i} scale_i mod q_i
+   *   RESCALE_SWITCH y_i = [last]_{q_i} scale_i mod q_i
+   *   RESCALE_ADD    x_i = x_i q_inv_i + y_i mod q_i
+   * The operands a mode does not use are left empty (last is then nullptr).
+   * The towers are placed alike, the DPU holding whole towers rescales them
+   * whole; the towers y of a RESCALE_SWITCH are sized like last and
+   * materialized next to it. The results are current on the DPUs only.
+   * @param last_buf, x_bufs, y_bufs host buffers of the inputs, pushed if
+   * their device copy is stale
+   * @return false if the towers read are not all of the same length, a
+   * modulus is wider than 62 bits, or the towers read are not all placed
+   * alike, nothing is done then
+   */
+  static bool rescale(enum pim_rescale_mode mode, PimData *last,
+                      const uint64_t *last_buf, const std::vector<PimData *> &x,
+                      const std::vector<const uint64_t *> &x_bufs,
+                      const std::vector<PimData *> &y,
+                      const std::vector<const uint64_t *> &y_bufs,
+                      const PimRescaleTables &tables) {
+    size_t count = tables.q.size();
+    if (tables.scale.size() != count || tables.q_inv.size() != count ||
+        x.size() != (mode == RESCALE_SWITCH ? 0 : count) ||
+        y.size() != (mode == RESCALE_FUSED ? 0 : count) ||
+        (last == nullptr) != (mode == RESCALE_ADD))
+      throw std::invalid_argument("PimData: rescale operands mismatch");
+    if (count == 0 || tables.last_mod >> 62 != 0)
+      return false;
+    PimData *first = mode == RESCALE_ADD ? x[0] : last;
+    uint32_t n = first->size;
+    if (n == 0)
+      return false;
+    for (size_t i = 0; i < count; ++i)
+      if (tables.q[i] == 0 || tables.q[i] >> 62 != 0)
+        return false;
+    // The towers read, x_i and y_i are read together in a RESCALE_ADD
+    std::vector<PimData *> read(x);
+    if (last != nullptr)
+      read.push_back(last);
+    if (mode == RESCALE_ADD)
+      read.insert(read.end(), y.begin(), y.end());
+    for (auto *data : read)
+      if (data->size != n || data->pim != first->pim ||
+          data->home != first->home)
+        return false;
+
+    // Nothing was touched until here
+    PimManager *manager =
+        first->is_materialized() ? first->pim : PimManager::current();
+    first->materialize(manager);
+    for (auto *data : read)
+      data->materialize_like(*first);
+    for (size_t i = 0; i < x.size(); ++i)
+      x[i]->to_pim(x_bufs[i]);
+    if (mode == RESCALE_ADD)
+      for (size_t i = 0; i < y.size(); ++i)
+        y[i]->to_pim(y_bufs[i]);
+    if (last != nullptr)
+      last->to_pim(last_buf);
+    // The towers y of a RESCALE_SWITCH are overwritten, they may as well
+    // move next to last
+    if (mode == RESCALE_SWITCH) {
+      for (auto *data : y) {
+        data->resize(n);
+        if (data->pim == manager && data->home != first->home)
+          data->release();
+        data->materialize_like(*first);
+        data->same_place(*first);
+      }
+    }
+
+    // The towers sit at the same offsets on every DPU, each DPU gets its own
+    // copy of the rows
+    const uint32_t width = 8;
+    uint32_t groups = manager->getNumDpus();
+    std::vector<uint64_t> rows(size_t(groups) * count * width);
+    for (uint32_t d = 0; d < groups; ++d) {
+      for (size_t i = 0; i < count; ++i) {
+        uint64_t q = tables.q[i];
+        uint64_t *row = &rows[(d * count + i) * width];
+        row[0] = q;
+        row[1] = q - tables.last_mod % q;
+        row[2] = tables.scale[i] % q;
+        row[3] = pim_shoup_precon(row[2], q);
+        row[4] = tables.q_inv[i] % q;
+        row[5] = pim_shoup_precon(row[4], q);
+        row[6] = x.empty() ? 0 : x[i]->metadata[0].second;
+        row[7] = y.empty() ? 0 : y[i]->metadata[0].second;
+      }
+    }
+    PimData list(rows.size());
+    list.materialize(manager);
+    list.to_pim(rows.data());
+
+    struct pim_meta header;
+    struct pim_rescale &meta = header.args.rescale;
+    header.opcode = OP_RESCALE;
+    meta.last_mod = tables.last_mod;
+    meta.last = last != nullptr ? last->metadata[0].second : 0;
+    meta.rows = list.metadata[0].second;
+    meta.count = count;
+    meta.len = first->slice_words(n);
+    meta.mode = mode;
+    meta.pad = 0;
+    std::vector<struct pim_tower> info;
+    if (first->is_whole())
+      info = first->placed(0);
+    list.submit(header, info.empty() ? nullptr : &info);
+
+    for (auto *data : mode == RESCALE_SWITCH ? y : x)
+      data->pim_modified();
+    return true;
+  }
+
+  /**
+   * Fills the towers out with uniform residues expanded from seed on the DPUs
+   * (see struct pim_uniform), the words pim_uniform_fill computes on the
+   * host. Only the seed and the moduli cross the bus, the results are current
+   * on the DPUs only. The towers are materialized next to the first one; the
+   * DPU holding whole towers expands them whole.
+   * @param q moduli of the towers
+   * @param streams streams of the towers, distinct for distinct towers
+   * @return false if the towers are not all of the same length, or a modulus
+   * is 0 or wider than 63 bits, nothing is done then
+   */
+  static bool uniform(const PimUniformSeed &seed,
+                      const std::vector<PimData *> &out,
+                      const std::vector<uint64_t> &q,
+                      const std::vector<uint64_t> &streams) {
+    size_t count = out.size();
+    if (q.size() != count || streams.size() != count)
+      throw std::invalid_argument("PimData: uniform operands mismatch");
+    if (count == 0 || out[0]->size == 0)
+      return false;
+    uint32_t n = out[0]->size;
+    for (size_t i = 0; i < count; ++i)
+      if (out[i]->size != n || q[i] == 0 || q[i] >> 63 != 0)
+        return false;
+
+    PimManager *manager =
+        out[0]->is_materialized() ? out[0]->pim : PimManager::current();
+    out[0]->materialize(manager);
+    // The towers are overwritten, they may as well move next to the first
+    for (auto *data : out) {
+      if (data->pim == manager && data->home != out[0]->home)
+        data->release();
+      data->materialize_like(*out[0]);
+      data->same_place(*out[0]);
+    }
+    bool whole = out[0]->is_whole();
+
+    // The towers sit at the same offsets on every DPU, each DPU gets its own
+    // copy of the rows and finds the first coefficient of its slice from its
+    // description
+    const uint32_t width = 4;
+    uint32_t groups = manager->getNumDpus();
+    std::vector<uint64_t> rows(size_t(groups) * count * width);
+    for (uint32_t d = 0; d < groups; ++d) {
+      for (size_t i = 0; i < count; ++i) {
+        uint64_t *row = &rows[(d * count + i) * width];
+        row[0] = q[i];
+        row[1] = pim_uniform_mask(q[i]);
+        row[2] = streams[i];
+        row[3] = out[i]->metadata[0].second;
+      }
+    }
+    PimData list(rows.size());
+    list.materialize(manager);
+    list.to_pim(rows.data());
+
+    struct pim_meta header;
+    struct pim_uniform &meta = header.args.uniform;
+    header.opcode = OP_UNIFORM;
+    for (int i = 0; i < 8; ++i)
+      meta.key[i] = seed[i];
+    meta.rows = list.metadata[0].second;
+    meta.count = count;
+    meta.len = out[0]->slice_words(n);
+    meta.n = n;
+    std::vector<struct pim_tower> info;
+    if (whole) {
+      info = out[0]->placed(0);
+    } else {
+      info.assign(groups, pim_tower{});
+      for (uint32_t d = 0; d < groups; ++d) {
+        info[d].slice = d;
+        info[d].valid = 1;
+      }
+    }
+    list.submit(header, &info);
+
+    for (auto *data : out)
+      data->pim_modified();
+    return true;
+  }
+
+  /**
+   * Frees the MRAM of the mirror. The host copy must have been brought up to
+   * date with to_host before if it is still needed.
+   */
+  void release() {
+    if (is_whole())
+      pim->deallocate_on(home, metadata[0].second);
+    else if (is_materialized())
+      pim->deallocate(metadata);
+    reset();
+  }
+
+  // Resizing drops the device copy, the new content only exists on the host.
+  void resize(uint32_t size_set) {
+    if (size_set == size)
+      return;
+    release();
+    size = size_set;
+  }
+
   PimData &operator+=(const uint64_t &rhs) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_ADD);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_ADD);
     return *this;
   }
 
   PimData &operator+=(const PimData &rhs) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_ADD);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_ADD);
     return *this;
   }
 
   PimData operator+(const PimData &rhs) {
     PimData ret(size);
-    do_ops(rhs, ret, VECTOR, ELEM_MOD_ADD);
+    do_ops(rhs, ret, VECTOR, OP_ELEM_MOD_ADD);
     return ret;
   }
 
   PimData operator+(const uint64_t &rhs) {
     PimData ret(size);
-    do_ops(rhs, ret, SCALAR, ELEM_MOD_ADD);
+    do_ops(rhs, ret, SCALAR, OP_ELEM_MOD_ADD);
     return ret;
   }
 
   PimData &operator-=(const uint64_t &rhs) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_SUB);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_SUB);
     return *this;
   }
 
   PimData &operator-=(const PimData &rhs) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_SUB);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_SUB);
     return *this;
   }
   PimData operator-(const PimData &rhs) {
     PimData result(size);
-    do_ops(rhs, result, VECTOR, ELEM_MOD_SUB);
+    do_ops(rhs, result, VECTOR, OP_ELEM_MOD_SUB);
     return result;
   }
 
   PimData operator-(const uint64_t &rhs) {
     PimData result(size);
-    do_ops(rhs, result, SCALAR, ELEM_MOD_SUB);
+    do_ops(rhs, result, SCALAR, OP_ELEM_MOD_SUB);
     return result;
   }
 
   PimData &operator*=(const uint64_t &rhs) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_MULT);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_MULT);
     return *this;
   }
 
   PimData &operator*=(const PimData &rhs) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_MULT);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_MULT);
     return *this;
   }
 
   PimData operator*(const PimData &rhs) {
     PimData result(size);
-    do_ops(rhs, result, VECTOR, ELEM_MOD_MULT);
+    do_ops(rhs, result, VECTOR, OP_ELEM_MOD_MULT);
     return result;
   }
 
   PimData operator*(const uint64_t &rhs) {
     PimData result(size);
-    do_ops(rhs, result, SCALAR, ELEM_MOD_MULT);
+    do_ops(rhs, result, SCALAR, OP_ELEM_MOD_MULT);
     return result;
   }
 
   // Addition operations
   PimData ModAdd(const uint64_t &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, SCALAR, ELEM_MOD_ADD, modulus);
+    do_ops(rhs, ret, SCALAR, OP_ELEM_MOD_ADD, modulus);
     return ret;
   }
 
   PimData ModAdd(const PimData &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, VECTOR, ELEM_MOD_ADD, modulus);
+    do_ops(rhs, ret, VECTOR, OP_ELEM_MOD_ADD, modulus);
     return ret;
   }
 
   void ModAddEq(const uint64_t &rhs, const uint64_t &modulus) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_ADD, modulus);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_ADD, modulus);
   }
   void ModAddEq(const PimData &rhs, const uint64_t &modulus) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_ADD, modulus);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_ADD, modulus);
   }
 
   // Substraction operations
   PimData ModSub(const uint64_t &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, SCALAR, ELEM_MOD_SUB, modulus);
+    do_ops(rhs, ret, SCALAR, OP_ELEM_MOD_SUB, modulus);
     return ret;
   }
   PimData ModSub(const PimData &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, VECTOR, ELEM_MOD_SUB, modulus);
+    do_ops(rhs, ret, VECTOR, OP_ELEM_MOD_SUB, modulus);
     return ret;
   }
 
   void ModSubEq(const uint64_t &rhs, const uint64_t &modulus) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_SUB, modulus);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_SUB, modulus);
   }
 
   void ModSubEq(const PimData &rhs, const uint64_t &modulus) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_SUB, modulus);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_SUB, modulus);
   }
 
   // Multiplication operations
   PimData ModMul(const uint64_t &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, SCALAR, ELEM_MOD_MULT, modulus);
+    do_ops(rhs, ret, SCALAR, OP_ELEM_MOD_MULT, modulus);
     return ret;
   }
   PimData ModMul(const PimData &rhs, const uint64_t &modulus) {
     PimData ret(size);
-    do_ops(rhs, ret, VECTOR, ELEM_MOD_MULT, modulus);
+    do_ops(rhs, ret, VECTOR, OP_ELEM_MOD_MULT, modulus);
     return ret;
   }
 
   void ModMulEq(const uint64_t &rhs, const uint64_t &modulus) {
-    do_ops(rhs, SCALAR_EQ, ELEM_MOD_MULT, modulus);
+    do_ops(rhs, SCALAR_EQ, OP_ELEM_MOD_MULT, modulus);
   }
   void ModMulEq(const PimData &rhs, const uint64_t &modulus) {
-    do_ops(rhs, VECTOR_EQ, ELEM_MOD_MULT, modulus);
+    do_ops(rhs, VECTOR_EQ, OP_ELEM_MOD_MULT, modulus);
   }
   void MultWithOutMod(const PimData &rhs) {}
 
@@ -173,165 +873,282 @@ public:
   // mod operations
   PimData Mod(const uint64_t &om, const uint64_t &nm) {
     PimData ret(size);
-    do_mod_ops(MOD_NORMAL, ret.metadata[0].second, ret.size, om, nm, 0);
+    do_mod_ops(MOD_NORMAL, &ret, om, nm, 0);
     return ret;
   }
   void ModEq(const uint64_t &om, const uint64_t &nm) {
-    do_mod_ops(MODEQ, 0, 0, om, nm, 0);
+    do_mod_ops(MODEQ, nullptr, om, nm, 0);
   }
   void switchmod(const uint64_t &om, const uint64_t &nm) {
-    do_mod_ops(SWITCHMODULUS, 0, 0, om, nm, 0);
+    do_mod_ops(SWITCHMODULUS, nullptr, om, nm, 0);
   }
 
   PimData ModByTwo(const uint64_t &modulus) {
     PimData ret(size);
-    do_mod_ops(MODBYTWO, ret.metadata[0].second, ret.size, modulus, 0, 0);
+    do_mod_ops(MODBYTWO, &ret, modulus, 0, 0);
     return ret;
   }
   void ModByTwoEq(const uint64_t &modulus) {
-    do_mod_ops(MODBYTWOEQ, 0, 0, modulus, 0, 0);
+    do_mod_ops(MODBYTWOEQ, nullptr, modulus, 0, 0);
   }
 
+  // The exponent is reduced here, as NativeVectorT::ModExp does, the DPUs
+  // have no divider
   PimData ModExp(const uint64_t &modulus, const uint64_t b) {
     PimData ret(size);
-    do_mod_ops(MODEXP, ret.metadata[0].second, ret.size, modulus, b, 0);
+    do_mod_ops(MODEXP, &ret, modulus, b % modulus, 0);
     return ret;
   }
   void ModExpEq(const uint64_t &modulus, const uint64_t b) {
-    do_mod_ops(MODEXPEQ, 0, 0, modulus, b, 0);
+    do_mod_ops(MODEXPEQ, nullptr, modulus, b % modulus, 0);
   }
 
   PimData ModInverse(uint64_t modulus) {
     PimData ret(size);
-    do_mod_ops(MODINVERSE, ret.metadata[0].second, ret.size, modulus, 0, 0);
+    do_mod_ops(MODINVERSE, &ret, modulus, 0, 0);
     return ret;
   }
   void ModInverseEq(uint64_t modulus) {
-    do_mod_ops(MODINVERSEEQ, 0, 0, modulus, 0, 0);
+    do_mod_ops(MODINVERSEEQ, nullptr, modulus, 0, 0);
   }
 
   PimData MultiplyAndRound(const uint64_t &modulus, const uint64_t &p,
                            const uint64_t &q) {
     PimData ret(size);
-    do_mod_ops(MULTIPLYANDROUND, ret.metadata[0].second, ret.size, modulus, p,
-               q);
+    do_mod_ops(MULTIPLYANDROUND, &ret, modulus, p, q);
     return ret;
   }
 
   void MultiplyAndRoundEq(const uint64_t &modulus, const uint64_t &p,
                           const uint64_t &q) {
-    do_mod_ops(MULTIPLYANDROUNDEQ, 0, 0, modulus, p, q);
+    do_mod_ops(MULTIPLYANDROUNDEQ, nullptr, modulus, p, q);
   }
 
   PimData DivideAndRound(const uint64_t &modulus, const uint64_t &q) {
     PimData ret(size);
-    do_mod_ops(DIVIDEANDROUND, ret.metadata[0].second, ret.size, modulus, q, 0);
+    do_mod_ops(DIVIDEANDROUND, &ret, modulus, q, 0);
     return ret;
   }
   void DivideAndRoundEq(const uint64_t &modulus, const uint64_t &q) {
-    do_mod_ops(DIVIDEANDROUNDEQ, 0, 0, modulus, q, 0);
+    do_mod_ops(DIVIDEANDROUNDEQ, nullptr, modulus, q, 0);
   }
 
 private:
-  // Normal operations
+  // Normal operations. The operands must be current on the device (see
+  // to_pim), the result is materialized here and only its device copy is
+  // valid afterwards.
 
-  void do_ops(const PimData &rhs, const PimData &res,
-              enum add_sub_mul_kernel kernel, const std::string &ops,
+  void do_ops(const PimData &rhs, PimData &res, enum add_sub_mul_kernel kernel,
+              enum pim_opcode ops,
               uint64_t mod = std::numeric_limits<uint64_t>::max(),
               uint64_t mu = 0) {
-    common_do_ops(metadata[0].second, size * sizeof(uint64_t),
-                  rhs.metadata[0].second, rhs.size * sizeof(uint64_t),
+    same_place(rhs);
+    res.materialize_like(*this);
+    common_do_ops(metadata[0].second, size, rhs.metadata[0].second, rhs.size,
                   res.metadata[0].second, res.size, kernel, ops, mod, mu,
                   "Dot operation of vectors");
+    res.pim_modified();
   }
 
-  void do_ops(const uint64_t &rhs, const PimData &res,
-              enum add_sub_mul_kernel kernel, const std::string &ops,
+  void do_ops(const uint64_t &rhs, PimData &res, enum add_sub_mul_kernel kernel,
+              enum pim_opcode ops,
               uint64_t mod = std::numeric_limits<uint64_t>::max(),
               uint64_t mu = 0) {
-    common_do_ops(metadata[0].second, size * sizeof(uint64_t), rhs, 0,
-                  res.metadata[0].second, res.size, kernel, ops, mod, mu,
+    res.materialize_like(*this);
+    common_do_ops(metadata[0].second, size, rhs, 0, res.metadata[0].second,
+                  res.size, kernel, ops, mod, mu,
                   "Scalar operation of vectors");
+    res.pim_modified();
   }
 
   // In place variants operations
   void do_ops(const PimData &rhs, enum add_sub_mul_kernel kernel,
-              const std::string &ops,
+              enum pim_opcode ops,
               uint64_t mod = std::numeric_limits<uint64_t>::max(),
               uint64_t mu = 0) {
-    common_do_ops(metadata[0].second, size * sizeof(uint64_t),
-                  rhs.metadata[0].second, rhs.size * sizeof(uint64_t), 0, 0,
-                  kernel, ops, mod, mu, "Dot operation of vectors");
+    same_place(rhs);
+    common_do_ops(metadata[0].second, size, rhs.metadata[0].second, rhs.size,
+                  0, 0, kernel, ops, mod, mu, "Dot operation of vectors");
+    pim_modified();
   }
 
   void do_ops(const uint64_t &rhs, enum add_sub_mul_kernel kernel,
-              const std::string &ops,
+              enum pim_opcode ops,
               uint64_t mod = std::numeric_limits<uint64_t>::max(),
               uint64_t mu = 0) {
-    common_do_ops(metadata[0].second, size * sizeof(uint64_t), rhs, 0, 0, 0,
-                  kernel, ops, mod, mu, "Scalar operation of vectors");
+    common_do_ops(metadata[0].second, size, rhs, 0, 0, 0, kernel, ops, mod, mu,
+                  "Scalar operation of vectors");
+    pim_modified();
   }
 
+  // The sizes are in words, of the whole vectors
   void common_do_ops(uint64_t op1_start, uint64_t op1_size, uint64_t op2_start,
                      uint64_t op2_size, uint64_t res_start, uint64_t res_size,
-                     enum add_sub_mul_kernel kernel, const std::string &ops,
+                     enum add_sub_mul_kernel kernel, enum pim_opcode ops,
                      uint64_t mod, uint64_t mu,
                      const std::string &operation_desc) {
     // Create the metadata header
-    struct mod_add_sub_mult meta;
+    struct pim_meta header;
+    struct mod_add_sub_mult &meta = header.args.elem;
+    header.opcode = ops;
     meta.op1.start = op1_start;
-    meta.op1.size = DIV(op1_size, pim->getNumDpus());
+    meta.op1.size = slice_bytes(op1_size);
+    // A scalar is reduced here, the kernels expect it below the modulus
+    if ((kernel == SCALAR || kernel == SCALAR_EQ) && mod != PIM_TOWER_MODULUS)
+      op2_start %= mod;
     meta.op2.start = op2_start;
-    meta.op2.size = DIV(op2_size, pim->getNumDpus());
+    meta.op2.size = slice_bytes(op2_size);
     meta.mod = mod;
     meta.mu = mu;
+    meta.precon = 0;
+    // The constants of the products need a 128-bit division, which the DPUs
+    // would emulate bit by bit: a scalar gets its Shoup precomputation, the
+    // vectors the Barrett constant of the modulus
+    if (ops == OP_ELEM_MOD_MULT) {
+      if (meta.mu == 0)
+        meta.mu = pim_barrett_mu(mod);
+      if (kernel == SCALAR || kernel == SCALAR_EQ)
+        meta.precon = pim_shoup_precon(op2_start, mod);
+    }
     meta.res.start = res_start;
-    meta.res.size = DIV(res_size, pim->getNumDpus());
+    meta.res.size = slice_bytes(res_size);
     meta.kernel = kernel;
+#ifdef PIM_DEBUG
     std::cout << operation_desc << " " << meta.op1.start << " and "
               << meta.op2.start << std::endl;
+#endif
 
-    // Load the appropriate kernel
-    pim->load_kernel(ops.c_str());
-
-    // Send by broadcast the meta header to the DPUs, here not to the MRAM but
-    // to the WRAM where the header resides
-    pim->copy_to_pim(&meta, sizeof(meta), 0, 1, "meta");
-
-    // Launch the kernel
-    pim->start_kernel();
-
-    pim->display();
+    // The resident program is already loaded, the opcode selects the kernel.
+    // The launch is only enqueued: the host keeps going while the DPUs
+    // compute, and a later to_host is ordered after it by the runtime.
+    submit(header);
   }
 
-  void do_mod_ops(enum mod_kernel kernel, u_int32_t res_start,
-                  u_int32_t res_size, uint64_t mod, uint64_t p, uint64_t q) {
-    struct mod_ops ops;
+  void do_mod_ops(enum mod_kernel kernel, PimData *res, uint64_t mod,
+                  uint64_t p, uint64_t q) {
+    struct pim_meta header;
+    struct mod_ops &ops = header.args.mod;
+    header.opcode = OP_ELEM_MOD_OPS;
     ops.kernel = kernel;
     ops.op.start = metadata[0].second;
-    ops.op.size = DIV(size * sizeof(uint64_t), pim->getNumDpus());
-    ops.res.start = res_start;
-    ops.res.size = DIV(res_size * sizeof(uint64_t), pim->getNumDpus());
+    ops.op.size = slice_bytes(size);
+    ops.res.start = 0;
+    ops.res.size = 0;
+    if (res != nullptr) {
+      res->materialize_like(*this);
+      ops.res.start = res->metadata[0].second;
+      ops.res.size = slice_bytes(res->size);
+    }
     ops.mod = mod;
     ops.p = p;
     ops.q = q;
 
-    pim->load_kernel(ELEM_MOD_OPS);
+    submit(header);
+
+    if (res != nullptr)
+      res->pim_modified();
+    else
+      pim_modified();
+  }
 
-    // Send by broadcast the meta header to the DPUs, here not to the MRAM but
-    // to the WRAM where the header resides.
-    pim->copy_to_pim(&ops, sizeof(ops), 0, 1, "meta");
+  // Words of the slice of a vector of words words on each DPU of the set,
+  // padding included; all of them for a whole mirror
+  uint32_t slice_words(uint32_t words) const {
+    return is_whole() ? words : pim->slice_words(words);
+  }
 
-    // Launch the kernel
-    pim->start_kernel();
+  uint32_t slice_bytes(uint32_t words) const {
+    return slice_words(words) * sizeof(uint64_t);
+  }
+
+  // Operands of a kernel have to live in the MRAM of the same DPU set
+  void same_set(const PimData &rhs) const {
+    if (rhs.pim != pim)
+      throw std::invalid_argument("PimData: operands on different DPU sets");
+  }
 
+  // and element-wise ones on the same DPUs
+  void same_place(const PimData &rhs) const {
+    same_set(rhs);
+    if (rhs.home != home)
+      throw std::invalid_argument("PimData: operands placed on different DPUs");
+  }
+
+  // Allocates the mirror whole on DPU dpu of set, false if its MRAM is full
+  bool materialize_on(PimManager *set, uint32_t dpu) {
+    int32_t addr = set->allocate_on(dpu, size * sizeof(uint64_t));
+    if (addr == -1)
+      return false;
+    pim = set;
+    home = dpu;
+    metadata = {{dpu, uint32_t(addr)}};
+    pim_valid = false;
+    return true;
+  }
+
+  void materialize_spread(PimManager *set) {
+    pim = set;
+    metadata = pim->allocate(size * sizeof(uint64_t));
+    if (metadata.empty())
+      throw std::runtime_error("PimData: MRAM allocation failed");
+    pim_valid = false;
+  }
+
+  // Buffers of a transfer of a whole mirror, buf for its DPU alone
+  template <typename T> std::vector<T *> home_bufs(T *buf) const {
+    std::vector<T *> bufs(pim->getNumDpus(), nullptr);
+    bufs[home] = buf;
+    return bufs;
+  }
+
+  // Descriptions of a launch on a whole mirror, only its DPU runs it. The
+  // kernels given their modulus in the header need none here.
+  std::vector<struct pim_tower> placed(uint64_t modulus,
+                                       uint32_t twiddles = 0) const {
+    std::vector<struct pim_tower> info(pim->getNumDpus(), pim_tower{});
+    info[home].mod = modulus;
+    info[home].mu = modulus != 0 ? pim_barrett_mu(modulus) : 0;
+    info[home].slice = 0;
+    info[home].valid = 1;
+    info[home].twiddles = twiddles;
+    return info;
+  }
+
+  // Kernels on a whole mirror run on its DPU alone, unless given the
+  // descriptions of their own
+  void submit(const struct pim_meta &header,
+              const std::vector<struct pim_tower> *towers = nullptr) {
+    std::vector<struct pim_tower> info;
+    if (towers == nullptr && is_whole()) {
+      info = placed(0);
+      towers = &info;
+    }
+    pim->launch_async(header, towers);
+#ifdef PIM_DEBUG
+    // Reading the DPU logs needs the kernel to have completed
+    pim->sync();
     pim->display();
+#endif
+  }
+
+  void reset() {
+    metadata.clear();
+    home = -1;
+    host_valid = true;
+    pim_valid = false;
   }
 
-  std::vector<uint64_t> host_data;
-  uint32_t size;
-  PimManager *pim;
+  uint32_t size = 0;
+  // Placement of the mirror when it is materialized on its own
+  PimLayout layout = PimLayout::SPREAD;
+  // DPU holding the whole mirror, -1 when it is spread over the set
+  int32_t home = -1;
+  PimManager *pim = nullptr;
   std::vector<std::pair<size_t, uint32_t>> metadata;
+  std::atomic<bool> host_valid{true};
+  bool pim_valid = false;
+  // Taken by to_host while it pulls the mirror, never copied or moved
+  std::mutex pull_lock;
 };
 
 #endif //_PIM_DATA_
@@ -0,0 +1,61 @@
+#ifndef _PIM_EVENT_
+#define _PIM_EVENT_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+/**
+ * PimEvent is the completion handle of an operation enqueued on the DPUs
+ * with one of the *_async calls of PimManager. The UPMEM runtime executes the
+ * asynchronous operations of a rank in submission order, so an operation that
+ * depends on an earlier one only has to be enqueued after it; events are
+ * needed by the host side to know when its buffers can be read or reused.
+ *
+ * A default constructed event is already complete.
+ */
+class PimEvent {
+public:
+  PimEvent() = default;
+
+  bool ready() const {
+    if (state == nullptr)
+      return true;
+    std::lock_guard<std::mutex> lock(state->lock);
+    return state->done;
+  }
+
+  void wait() const {
+    if (state == nullptr)
+      return;
+    std::unique_lock<std::mutex> lock(state->lock);
+    state->cv.wait(lock, [this] { return state->done; });
+  }
+
+private:
+  friend class PimManager;
+
+  struct State {
+    std::mutex lock;
+    std::condition_variable cv;
+    bool done = false;
+    // Host memory the queued operation reads from (e.g. a copy of the meta
+    // header), released once the operation has completed
+    std::shared_ptr<const void> keep_alive;
+  };
+
+  explicit PimEvent(std::shared_ptr<State> s) : state(std::move(s)) {}
+
+  void complete() const {
+    {
+      std::lock_guard<std::mutex> lock(state->lock);
+      state->done = true;
+      state->keep_alive.reset();
+    }
+    state->cv.notify_all();
+  }
+
+  std::shared_ptr<State> state;
+};
+
+#endif //_PIM_EVENT_
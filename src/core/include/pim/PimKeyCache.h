@@ -0,0 +1,144 @@
+#ifndef _PIM_KEY_CACHE_
+#define _PIM_KEY_CACHE_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Counters of a PimKeyCache
+struct PimKeyCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t bytes = 0;   // bytes of the resident keys
+  size_t entries = 0; // resident keys
+};
+
+/**
+ * PimKeyCache keeps the evaluation keys (relinearization and rotation keys)
+ * a DPU set switches pinned ciphertexts with resident in its MRAM, so that a
+ * key crosses the bus once instead of on every key switch. The keys are
+ * indexed by key tag and index and weigh their bytes against the capacity of
+ * the cache; when a key does not fit, the least frequently used ones are
+ * evicted first, the least recently used first among equally used ones.
+ *
+ * The cache does not move the keys itself: acquire is given a callback which
+ * pins the key and one which unpins it, called when the key is uploaded and
+ * evicted. A key is identified by its owner, the object holding it, as well:
+ * a new owner under a used tag and index replaces the entry, and the entries
+ * whose owner is gone, which released its MRAM with it, are evicted first.
+ * The keys in use by a key switch are held by a Lease and never evicted.
+ *
+ * pin runs without the lock of the cache, so that the other keys are served
+ * while a key crosses the bus; the acquirers of that key wait for its
+ * upload. unpin runs under the lock when a key is evicted. The callbacks may
+ * use the DPU set but not the cache.
+ */
+class PimKeyCache {
+public:
+  /**
+   * Keeps a key resident while it lives. An empty lease, for a key the cache
+   * could not hold, leaves the key to the host.
+   */
+  class Lease {
+  public:
+    Lease() = default;
+    Lease(Lease &&rhs) noexcept : cache(rhs.cache), key(std::move(rhs.key)) {
+      rhs.cache = nullptr;
+    }
+    Lease &operator=(Lease &&rhs) noexcept {
+      if (this != &rhs) {
+        drop();
+        cache = rhs.cache;
+        key = std::move(rhs.key);
+        rhs.cache = nullptr;
+      }
+      return *this;
+    }
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    ~Lease() { drop(); }
+
+    bool resident() const { return cache != nullptr; }
+
+  private:
+    friend class PimKeyCache;
+    Lease(PimKeyCache *set, std::pair<std::string, uint32_t> id)
+        : cache(set), key(std::move(id)) {}
+    void drop();
+
+    PimKeyCache *cache = nullptr;
+    std::pair<std::string, uint32_t> key;
+  };
+
+  explicit PimKeyCache(size_t capacity_bytes = 0) : capacity(capacity_bytes) {}
+
+  ~PimKeyCache() { clear(); }
+
+  PimKeyCache(const PimKeyCache &) = delete;
+  PimKeyCache &operator=(const PimKeyCache &) = delete;
+
+  /**
+   * Records a use of the key (tag, index) and makes it resident, uploading
+   * it with pin if it is not yet, or waiting for another acquirer uploading
+   * it. Room is made by evicting the keys not in use.
+   * @param owner object holding the key
+   * @param bytes size of the key
+   * @param pin uploads the key, it may throw when the MRAM is exhausted
+   * @param unpin releases the MRAM of the key, kept for its eviction
+   * @return a lease on the key, empty if the key cannot be made resident
+   */
+  Lease acquire(const std::shared_ptr<const void> &owner,
+                const std::string &tag, uint32_t index, size_t bytes,
+                const std::function<void()> &pin,
+                std::function<void()> unpin);
+
+  // Bytes the resident keys may take, lowering it evicts the keys not in use
+  void set_capacity(size_t bytes);
+
+  size_t get_capacity() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return capacity;
+  }
+
+  // Evicts every key which is not in use
+  void clear();
+
+  PimKeyCacheStats get_stats() const;
+
+private:
+  struct Entry {
+    std::weak_ptr<const void> owner;
+    const void *id;
+    size_t bytes;
+    uint64_t uses;
+    uint64_t last; // clock of the last use
+    uint32_t leases;
+    bool ready; // false while the key is uploaded, the uploader holds a lease
+    std::function<void()> unpin;
+  };
+  using Key = std::pair<std::string, uint32_t>;
+
+  // Evicts the entry, lock held
+  void evict(std::map<Key, Entry>::iterator it);
+
+  // Evicts the entries not in use until bytes more fit, lock held
+  bool make_room(size_t bytes);
+
+  // Drops the entry of a key whose upload failed, lock held
+  void cancel(const Key &key);
+
+  mutable std::mutex lock;
+  std::condition_variable uploaded; // an upload is over
+  size_t capacity;
+  uint64_t clock = 0;
+  std::map<Key, Entry> entries;
+  PimKeyCacheStats stats;
+};
+
+#endif //_PIM_KEY_CACHE_
@@ -2,30 +2,79 @@
 #define _PIM_MANAGER_
 
 #include "DpuMemory.h"
+#include "PimBackend.h"
+#include "PimBaseConv.h"
+#include "PimBlindRotate.h"
+#include "PimEvent.h"
+#include "PimKeyCache.h"
+#include "PimNtt.h"
+#include "PimStats.h"
 #include <iostream>
+#include "common.h"
 #include "kernel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
-extern "C" {
-#include <assert.h>
-#include <dpu.h>
-#include <dpu_log.h>
-}
-
 using namespace std;
 
+// Number of DPUs the lazily materialized PimData mirrors are spread over
+#ifndef PIM_NR_DPUS
+#define PIM_NR_DPUS 4
+#endif
+
+/**
+ * PimManager drives one DPU set: the default one of the process (getPim) or a
+ * partition of whole ranks leased from PimPool. Every set has its own MRAM
+ * heap, resident program and locks, so operations on different sets run
+ * concurrently.
+ *
+ * Any number of host threads may use the same set, e.g. the tower loops of
+ * DCRTPoly run by an OpenMP team. The locks of a set are only held to update
+ * its heap and tables and to enqueue an operation on the ranks, never while
+ * the DPUs compute: a synchronous call enqueues its operation, leaves the
+ * lock and waits for its completion event, so the other threads keep
+ * submitting in the meantime. The operations of a thread are executed in the
+ * order it submitted them.
+ */
 class PimManager {
 public:
+  /**
+   * The default DPU set, allocated by the first call with nr_dpus DPUs; the
+   * arguments of later calls are ignored.
+   */
   static PimManager *getPim(uint32_t nr_dpus, const std::string &profile = "") {
+    PimManager *set = pim.load(std::memory_order_acquire);
+    if (set != nullptr)
+      return set;
     std::lock_guard<std::mutex> lock(mutex_);
-    if (pim == nullptr) {
-      pim = new PimManager(nr_dpus, profile);
-    }
-    return pim;
+    if (pim.load(std::memory_order_relaxed) == nullptr)
+      pim.store(new PimManager(nr_dpus, profile), std::memory_order_release);
+    return pim.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * The set new PimData mirrors are materialized on: the one bound to the
+   * calling thread by a PimBinding, the default set otherwise. A mirror then
+   * stays on its set, and so do the results of the operations on it.
+   */
+  static PimManager *current() {
+    return bound != nullptr ? bound : getPim(PIM_NR_DPUS);
+  }
+
+  ~PimManager() {
+    keys.clear();
+    backend.reset();
   }
 
   /**
@@ -39,6 +88,10 @@ public:
    * @param memory indicates the symbol name of where to tranfer the data
    * @return offset from which the array starts, since the data is divided
    * equally we assume that the offset is the same for all DPUs
+   *
+   * A rank transfer gives every DPU slice_words(size) words. The slices are
+   * read in place from buf; only those cut by the end of an uneven length
+   * (or of a buffer which is not 8-byte aligned) are staged, zero padded.
    */
 
   void copy_to_pim(void *buf, uint32_t size, uint32_t offset, uint8_t type = 0,
@@ -50,43 +103,252 @@ public:
    * @param size size of the buffer
    * @param offset offset where the data to read starts
    * @return
+   * The padding of the slices (see copy_to_pim) is not written to buf.
    */
   uint32_t copy_from_pim(uint64_t *buf, uint32_t size, uint32_t offset);
 
+  /**
+   * Asynchronous variants of the transfers above. The transfer is queued
+   * behind the operations already submitted to the ranks and the call
+   * returns immediately; buf must stay valid and untouched until the
+   * returned event is ready (or until sync()).
+   */
+  PimEvent copy_to_pim_async(void *buf, uint32_t size, uint32_t offset,
+                             uint8_t type = 0,
+                             const std::string &memory =
+                                 DPU_MRAM_HEAP_POINTER_NAME);
+
+  PimEvent copy_from_pim_async(uint64_t *buf, uint32_t size, uint32_t offset);
+
+  /**
+   * scatter_to_pim - prepared transfer where every DPU gets its own buffer,
+   * the whole set is moved by a single dpu_push_xfer.
+   * @param bufs one buffer per DPU (bufs[i] for the i-th DPU of the set),
+   * DPUs with a nullptr entry are left out of the transfer
+   * @param bytes bytes transferred to each DPU, multiple of 8
+   * @param offset offset in the symbol
+   * @param memory symbol name of where to transfer the data
+   */
+  void scatter_to_pim(const std::vector<const void *> &bufs, uint32_t bytes,
+                      uint32_t offset,
+                      const std::string &memory = DPU_MRAM_HEAP_POINTER_NAME);
+
+  /**
+   * gather_from_pim - counterpart of scatter_to_pim, bytes are read from
+   * every DPU with a non null buffer in a single dpu_push_xfer.
+   */
+  void gather_from_pim(const std::vector<void *> &bufs, uint32_t bytes,
+                       uint32_t offset,
+                       const std::string &memory = DPU_MRAM_HEAP_POINTER_NAME);
+
+  PimEvent scatter_to_pim_async(const std::vector<const void *> &bufs,
+                                uint32_t bytes, uint32_t offset,
+                                const std::string &memory =
+                                    DPU_MRAM_HEAP_POINTER_NAME);
+
+  PimEvent gather_from_pim_async(const std::vector<void *> &bufs,
+                                 uint32_t bytes, uint32_t offset,
+                                 const std::string &memory =
+                                     DPU_MRAM_HEAP_POINTER_NAME);
+
   /**
    loads the kernel, we separate the loading and starting the kernel,
    for usecases where there could be specific parameters for a specific kernel
    otherwise they could be merged.
  */
   void load_kernel(const std::string &bin) {
-    DPU_ASSERT(dpu_load(set, bin.c_str(), NULL));
+    std::lock_guard<std::mutex> guard(submit_lock);
+    // Reloading the resident program would only wipe the WRAM state
+    if (bin == loaded_binary)
+      return;
+    auto start = std::chrono::steady_clock::now();
+    backend->load(bin);
+    loaded_binary = bin;
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters.loads++;
+    // A load is synchronous, its time is known right away
+    if (timing) {
+      auto now = std::chrono::steady_clock::now();
+      counters.load_ns += elapsed_ns(std::max(start, last_done), now);
+      last_done = now;
+    }
   }
   /**
     starts the kernel, to be checked for scenarios where ASYNCHRONOUS execution
     is to be prefered.
   */
-  void start_kernel() { DPU_ASSERT(dpu_launch(set, DPU_SYNCHRONOUS)); }
+  void start_kernel() {
+    PimEvent done;
+    {
+      std::lock_guard<std::mutex> guard(submit_lock);
+      enqueue_launch();
+      done = enqueue_event();
+    }
+    done.wait();
+  }
+
+  /**
+    runs one kernel of the resident program: the header is broadcast to the
+    "meta" symbol in WRAM and its opcode selects the kernel on the DPUs.
+  */
+  void launch(const struct pim_meta &meta,
+              const std::vector<struct pim_tower> *towers = nullptr) {
+    launch_async(meta, towers).wait();
+  }
+
+  /**
+    enqueues the broadcast of the header and the launch with
+    DPU_ASYNCHRONOUS and returns while the DPUs compute. The header is
+    copied, the caller's one can go out of scope right away. Since the ranks
+    run their queue in order, a kernel consuming the result of this one only
+    has to be launched after it.
+    @param towers the tower descriptions of the kernel, one per DPU,
+    pushed along with the header so that no launch of another thread comes
+    in between; nullptr for the kernels which do not read them. The last
+    descriptions pushed are remembered, identical ones are not transferred
+    again.
+  */
+  PimEvent launch_async(const struct pim_meta &meta,
+                        const std::vector<struct pim_tower> *towers = nullptr);
+
+  /**
+    fence: blocks until every operation queued on the DPUs so far has
+    completed. Synchronous transfers and launches are ordered after the
+    queued ones by the runtime, they do not need an explicit sync.
+  */
+  void sync() { record_event().wait(); }
 
   void display() {
-    struct dpu_set_t dpu;
-    DPU_FOREACH(set, dpu) { DPU_ASSERT(dpu_log_read(dpu, stdout)); }
+    sync();
+    std::lock_guard<std::mutex> guard(submit_lock);
+    backend->log(stdout);
   }
 
   void display_memory_status() const {
-    for (size_t i = 0; i < chunks.size(); ++i) {
-      std::cout << "Chunk " << i << ":\n";
-      chunks[i]->display_status();
-      std::cout << "\n";
-    }
+    std::lock_guard<std::mutex> guard(heap_lock);
+    heap.display_status();
   }
 
+  /**
+   * uploads the NTT tables of a modulus for ring dimension n to every DPU and
+   * returns their MRAM offset, to be put in pim_tower.twiddles. The tables
+   * are transferred once, later calls for the same modulus and dimension
+   * return the same offset; they stay in MRAM as long as the DPUs.
+   */
+  uint32_t ntt_tables(uint64_t modulus, uint32_t n, const PimNttTables &tables);
+
+  /**
+   * uploads the tables of a base conversion to every DPU and returns their
+   * MRAM offset, to be put in pim_base_conv.tables. Identical tables are
+   * transferred once and stay in MRAM as long as the DPUs.
+   */
+  uint32_t base_conv_tables(const PimBaseConvTables &tables);
+
+  /**
+   * uploads the index maps of the automorphism k of the towers of n words
+   * split in groups slices to the DPUs and returns their MRAM offset, to be
+   * put in pim_automorphism.map. DPU d gets the maps of slice d % groups,
+   * slices receives the slice of the result computed from each of the groups
+   * slices (see pim_automorphism_maps). The maps of a rotation index are
+   * transferred once and stay in MRAM as long as the DPUs.
+   * @return -1 if the automorphism does not map slices to slices
+   */
+  int32_t automorphism_maps(uint32_t k, uint32_t n, uint32_t groups,
+                            std::vector<uint32_t> &slices);
+
+  /**
+   * uploads the image of a bootstrapping key to every DPU and returns its
+   * MRAM offset, to be put in pim_blind_rotate.key. The image is transferred
+   * once per owner, the key object it is built from, and its MRAM is given
+   * back by a later call which finds the owner gone.
+   * @return -1 if the MRAM cannot hold the image
+   */
+  int32_t boot_key(const std::shared_ptr<const void> &owner,
+                   const PimBootKey &key);
+
+  /**
+   * Cache of the evaluation keys resident on the set (see PimKeyCache). It
+   * may take half of the MRAM of the DPUs unless its capacity is set.
+   */
+  PimKeyCache &key_cache() { return keys; }
+
+  /**
+   * allocates size bytes spread evenly over the DPUs, the share of a DPU
+   * rounded up to whole 8-byte words. The layout of the heap is the same on
+   * every DPU, the returned {dpu, offset} pairs all carry the same offset.
+   * An empty vector means the MRAM is exhausted.
+   */
   std::vector<std::pair<size_t, uint32_t>> allocate(size_t size);
 
   void deallocate(const std::vector<std::pair<size_t, uint32_t>> &addrs);
 
+  /**
+   * allocates size bytes on DPU dpu alone, for the mirrors placed whole on
+   * one DPU. Such allocations share heap blocks: a block taken for a DPU
+   * leaves a free slot of its size at the same offset on every other DPU,
+   * which their own allocations of that size take before a new block, and
+   * goes back to the heap once all of its slots are free again. The free
+   * slots are kept per DPU and block size, so finding one is logarithmic.
+   * @return the offset on dpu, -1 if its MRAM is exhausted
+   */
+  int32_t allocate_on(uint32_t dpu, size_t size);
+
+  // false if addr is not an allocation of allocate_on on dpu
+  bool deallocate_on(uint32_t dpu, uint32_t addr);
+
+  /**
+   * The DPU with the fewest bytes allocated by allocate_on, where a mirror
+   * placed whole goes when it is not materialized next to another one. The
+   * DPUs are then filled evenly, and so are the shared blocks.
+   */
+  uint32_t least_loaded() const;
+
   uint32_t getNumDpus() { return nr_dpus; }
 
+  // Words of a vector of size words held by each DPU, the slices of the last
+  // DPUs are padded when size does not split evenly
+  uint32_t slice_words(uint32_t size) const {
+    return DIVROUNDUP(size, nr_dpus);
+  }
+
+  std::string get_backend_name() const { return backend->name(); }
+
+  // Snapshot of the host side counters
+  PimCounters get_counters() {
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    return counters;
+  }
+
+  void reset_counters() {
+    std::lock_guard<std::mutex> heap_guard(heap_lock);
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters = PimCounters();
+    counters.mram_high_water = heap.bytes_in_use();
+  }
+
+  /**
+   * Snapshot of the host side counters and of the DPU cycles of every
+   * kernel. Reading the cycles waits for the operations queued on the DPUs,
+   * it is not counted as a transfer.
+   */
+  PimStats get_stats();
+
+  // Resets the host side counters and the DPU cycles
+  void reset_stats();
+
+  /**
+   * Turns on or off the measurement of the time of the transfers, loads and
+   * launches (see PimCounters). It costs a callback per operation, so it is
+   * off unless PIM_STATS=1.
+   */
+  void set_timing(bool on) { timing = on; }
+
+  bool timing_enabled() const { return timing; }
+
 private:
+  friend class PimBinding;
+  friend class PimPool;
+
   /**
    *This constructor loads the program to initialize the heap and other
    *structures. The initial plan is that to have only one kernel with
@@ -98,32 +360,166 @@ private:
    *@param count number of dpus to be launched
    *@param profile is the profile of the dpus to be launched
    */
-  PimManager(uint32_t count, const std::string &profile = "") : nr_dpus(count) {
-    DPU_ASSERT(dpu_alloc(count, profile.c_str(), &set));
-    struct dpu_set_t dpu;
-    load_kernel(BOOT);
+  PimManager(uint32_t count, const std::string &profile = "")
+      : PimManager(PimBackend::create(count, profile)) {}
 
-    DPU_FOREACH(set, dpu) { chunks.push_back(new DpuMemory()); }
-  }
-
-  ~PimManager() {
-    DPU_ASSERT(dpu_free(set));
-    for (DpuMemory *chunk : chunks) {
-      delete chunk;
-    }
+  explicit PimManager(std::unique_ptr<PimBackend> set)
+      : backend(std::move(set)) {
+    nr_dpus = backend->get_nr_dpus();
+    free_slots.resize(nr_dpus);
+    loads.assign(nr_dpus, 0);
+    for (uint32_t d = 0; d < nr_dpus; ++d)
+      by_load.insert({0, d});
+    keys.set_capacity(size_t(nr_dpus) * (CHUNK_SIZE / 2));
+    const char *env = std::getenv("PIM_STATS");
+    timing = env != nullptr && std::string(env) == "1";
+    load_kernel(PIM_KERNELS);
   }
 
   PimManager(const PimManager &) = delete;
   PimManager &operator=(const PimManager &) = delete;
 
-  static PimManager *pim;
+  // The transfers return the completion event of the transfer they enqueue
+  PimEvent push_to_pim(void *buf, uint32_t size, uint32_t offset, uint8_t type,
+                       const std::string &memory);
+
+  PimEvent pull_from_pim(uint64_t *buf, uint32_t size, uint32_t offset);
+
+  PimEvent xfer_prepared(const std::vector<void *> &bufs, bool to_pim,
+                         uint32_t bytes, uint32_t offset,
+                         const std::string &memory);
+
+  // Queues a callback behind the submitted operations which completes the
+  // returned event, keep_alive is released at the same time
+  PimEvent record_event(std::shared_ptr<const void> keep_alive = nullptr);
+
+  /*
+    The enqueue_* calls put an operation in the queue of the ranks and count
+    it, submit_lock held. They never wait: the buffers they read must stay
+    valid until an event enqueued after them completes.
+  */
+  void enqueue_xfer(const std::vector<void *> &bufs, bool to_pim,
+                    uint32_t bytes, uint32_t offset,
+                    const std::string &memory);
+
+  void enqueue_broadcast(const std::string &memory, uint32_t offset,
+                         const void *buf, uint32_t bytes);
+
+  void enqueue_launch();
+
+  // Pushes the tower descriptions unless they are the last ones pushed,
+  // submit_lock held
+  void enqueue_towers(const std::vector<struct pim_tower> &info);
+
+  PimEvent enqueue_event(std::shared_ptr<const void> keep_alive = nullptr);
+
+  // Broadcasts image to the MRAM heap at addr, image is kept alive until the
+  // transfer has completed
+  void upload(uint32_t addr, std::shared_ptr<const std::vector<uint64_t>> image);
+
+  /**
+   * With timing on, queues a callback behind the operation submitted at
+   * submitted which adds its time to the field of the counters. The queue
+   * runs in order, so the operation started when it was submitted or when
+   * the one before it completed, whichever came last.
+   */
+  void time_op(uint64_t PimCounters::*field,
+               std::chrono::steady_clock::time_point submitted);
+
+  static uint64_t elapsed_ns(std::chrono::steady_clock::time_point from,
+                             std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from)
+        .count();
+  }
+
+  // heap.allocate and heap.deallocate, keeping track of the high-water mark
+  int32_t heap_allocate(size_t bytes);
+
+  // heap_allocate, heap_lock held
+  int32_t heap_take(size_t bytes);
+
+  void heap_deallocate(uint32_t addr);
+
+  // Counts bytes taken on or given back by dpu in its load, heap_lock held
+  void add_load(uint32_t dpu, size_t bytes, bool taken);
+
+  static std::atomic<PimManager *> pim;
   static std::mutex mutex_;
-  struct dpu_set_t set;
+  // Set bound to the thread, see current()
+  static thread_local PimManager *bound;
+  /*
+    The locks of the set, taken in this order when nested:
+    the lock of keys - the evaluation keys, its callbacks pin and unpin them
+    tables_lock - the resident tables and keys below
+    submit_lock - the queue of the ranks: the operations enqueued under one
+                  hold (e.g. a header and its launch) run back to back
+    heap_lock   - the MRAM heap
+    stats_lock  - the counters, also taken by the callbacks of the backend
+  */
+  std::mutex tables_lock;
+  std::mutex submit_lock;
+  mutable std::mutex heap_lock;
+  std::unique_ptr<PimBackend> backend;
   uint32_t nr_dpus;
-  std::vector<DpuMemory *> chunks;
-  std::map<std::pair<size_t, uint32_t>,
-           std::vector<std::pair<size_t, uint32_t>>>
-      allocations;
+  PimCounters counters;
+  std::mutex stats_lock;
+  std::atomic<bool> timing{false};
+  // Completion of the last timed operation
+  std::chrono::steady_clock::time_point last_done;
+  std::string loaded_binary;
+  // Last tower descriptions pushed, submit_lock held
+  std::vector<struct pim_tower> towers;
+  // MRAM offsets of the NTT tables, by modulus and ring dimension
+  std::map<std::pair<uint64_t, uint32_t>, uint32_t> twiddles;
+  // MRAM offsets of the base conversion tables, by their image
+  std::map<std::vector<uint64_t>, uint32_t> conversions;
+  // MRAM offsets of the automorphism maps and the slices computed from every
+  // slice, by automorphism index, ring dimension and number of slices
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t>,
+           std::pair<int32_t, std::vector<uint32_t>>>
+      automorphisms;
+  // MRAM offsets of the bootstrapping key images, the image first and its
+  // blocks after it, by the key object they are built from
+  struct ResidentKey {
+    std::weak_ptr<const void> owner;
+    std::vector<uint32_t> addrs;
+  };
+  std::map<const void *, ResidentKey> boot_keys;
+  // MRAM heap layout, shared by all the DPUs of the set
+  DpuMemory heap;
+  // Heap blocks of the allocations of allocate_on, by offset: their size
+  // and the number of DPUs using them, heap_lock held
+  struct SharedBlock {
+    size_t bytes;
+    uint32_t count;
+  };
+  std::map<uint32_t, SharedBlock> shared;
+  // Offsets of the shared blocks with a free slot, by DPU and block size
+  std::vector<std::map<size_t, std::set<uint32_t>>> free_slots;
+  // Bytes allocated on each DPU alone, and the DPUs ordered by them
+  std::vector<size_t> loads;
+  std::set<std::pair<size_t, uint32_t>> by_load;
+  PimKeyCache keys;
+};
+
+/**
+ * Binds a DPU set to the calling thread for its scope, see
+ * PimManager::current(). Bindings nest, the previous one is restored at the
+ * end of the scope. The workers of an OpenMP team do not inherit it.
+ */
+class PimBinding {
+public:
+  explicit PimBinding(PimManager *manager) : previous(PimManager::bound) {
+    PimManager::bound = manager;
+  }
+
+  ~PimBinding() { PimManager::bound = previous; }
+
+  PimBinding(const PimBinding &) = delete;
+  PimBinding &operator=(const PimBinding &) = delete;
+
+private:
+  PimManager *previous;
 };
 
 #endif //_PIM_MANAGER_ 
\ No newline at end of file
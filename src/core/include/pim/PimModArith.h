@@ -0,0 +1,29 @@
+#ifndef _PIM_MOD_ARITH_
+#define _PIM_MOD_ARITH_
+
+#include <cstdint>
+
+/*
+  Constants of the modular products of the DPU kernels. They need a 128-bit
+  division, which the DPUs would have to emulate bit by bit, so the host
+  computes them and ships them in the kernel arguments.
+*/
+
+// Barrett constant floor(2^(2 msb + 3) / modulus), as NativeIntegerT::ComputeMu.
+// 0 (computed on the DPU) for moduli wider than the 60 bits it is defined for.
+inline uint64_t pim_barrett_mu(uint64_t modulus) {
+  if (modulus == 0 || modulus >> 60 != 0)
+    return 0;
+  unsigned msb = 64 - __builtin_clzll(modulus);
+  return uint64_t(((unsigned __int128)1 << (2 * msb + 3)) / modulus);
+}
+
+// Shoup precomputation floor(b 2^64 / modulus) of a constant b < modulus, as
+// NativeIntegerT::PrepModMulConst
+inline uint64_t pim_shoup_precon(uint64_t b, uint64_t modulus) {
+  if (modulus == 0 || b >= modulus)
+    return 0;
+  return uint64_t(((unsigned __int128)b << 64) / modulus);
+}
+
+#endif //_PIM_MOD_ARITH_
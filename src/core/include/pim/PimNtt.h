@@ -0,0 +1,50 @@
+#ifndef _PIM_NTT_
+#define _PIM_NTT_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * NTT tables of one modulus and ring dimension n, as kept by NTTPlanNat: the
+ * roots of unity in bit reversed order, the inverse ones, the Shoup
+ * precomputations of both (n words each), and n^-1 with its precomputation.
+ * PimManager::ntt_tables uploads them in the layout of the DPU kernels (see
+ * struct pim_ntt).
+ */
+struct PimNttTables {
+  const uint64_t *root = nullptr;
+  const uint64_t *root_precon = nullptr;
+  const uint64_t *root_inv = nullptr;
+  const uint64_t *root_inv_precon = nullptr;
+  uint64_t n_inv = 0;
+  uint64_t n_inv_precon = 0;
+};
+
+/**
+ * Butterfly stages of a tower split in groups slices which cross the slices:
+ * m = 1 .. groups/2 of the forward transform, run before the DPUs transform
+ * their slices, and m = groups/2 .. 1 of the inverse one, run after them. The
+ * data is the whole tower, in the order of the host transforms.
+ */
+void pim_ntt_forward_cross_stages(uint64_t *data, uint32_t n, uint32_t groups,
+                                  uint64_t modulus,
+                                  const PimNttTables &tables);
+
+void pim_ntt_inverse_cross_stages(uint64_t *data, uint32_t n, uint32_t groups,
+                                  uint64_t modulus,
+                                  const PimNttTables &tables);
+
+/**
+ * Index maps of the automorphism k (odd) of a tower of n words in the bit
+ * reversed evaluation form, the permutation of PrecomputeAutoMap, when the
+ * tower is split in groups slices (see struct pim_automorphism). slices[s]
+ * receives the slice of the result computed by the DPU holding slice s of the
+ * input, maps the n / groups indexes of that DPU at s * n / groups.
+ * @return false if a slice of the result does not come from a single slice of
+ * the input, which does not happen when groups is a power of two
+ */
+bool pim_automorphism_maps(uint32_t k, uint32_t n, uint32_t groups,
+                           std::vector<uint32_t> &slices,
+                           std::vector<uint32_t> &maps);
+
+#endif //_PIM_NTT_
@@ -0,0 +1,106 @@
+#ifndef _PIM_PLANNER_
+#define _PIM_PLANNER_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Operation classes the offload planner keeps costs for
+enum pim_op_class { PIM_OP_ADD_SUB = 0, PIM_OP_MULT = 1, PIM_OP_CLASSES };
+
+/**
+ * Measured costs of the host and of a DPU set, in nanoseconds. A transfer
+ * costs a fixed latency plus a cost per byte of the whole buffer; a kernel
+ * costs the launch latency plus a cost per word of the vector, which one DPU
+ * holds whole (see PimLayout).
+ */
+struct PimCalibration {
+  std::string backend;
+  uint32_t nr_dpus = 0; // 0 until the set is calibrated
+  double host_word_ns[PIM_OP_CLASSES] = {};
+  double pim_word_ns[PIM_OP_CLASSES] = {};
+  double launch_ns = 0;
+  double to_pim_ns = 0;
+  double to_pim_byte_ns = 0;
+  double from_pim_ns = 0;
+  double from_pim_byte_ns = 0;
+
+  // Text file of "key value..." lines, false if it cannot be read or parsed
+  bool load(const std::string &path);
+  bool save(const std::string &path) const;
+};
+
+/**
+ * PimPlanner decides per operation whether the host or the DPUs compute it,
+ * from the size of the operands, where their current copies are and the
+ * calibrated costs. An offloaded operation pays for pushing its stale
+ * operands and for its launch, a host one for pulling back the operands an
+ * offloaded operation left newer on the DPUs.
+ *
+ * The planner is disabled unless PIM_OFFLOAD_PLANNER=1 or enable() turns it
+ * on: small ring dimensions and one-off operations are slower on the DPUs,
+ * so by default only the operations on pinned operands are offloaded (see
+ * NativeVectorT::PinToPim).
+ *
+ * The calibration is kept in the file named by PIM_CALIBRATION, by default
+ * $HOME/.openfhe-pim-calibration. It is reused when it was measured on the
+ * same backend and number of DPUs, the DPU set is calibrated again
+ * otherwise when the planner is enabled.
+ */
+class PimPlanner {
+public:
+  static PimPlanner &get();
+
+  bool enabled() const { return on; }
+
+  void enable(bool enable);
+
+  /**
+   * @param op class of the operation
+   * @param words elements of each operand
+   * @param towers operations of that size issued together, e.g. the towers
+   * of a DCRTPoly run by an OpenMP team. The host runs them on separate
+   * cores while the DPU holding the polynomial runs them one after the
+   * other.
+   * @param to_push operands without a current copy on the DPUs
+   * @param to_pull operands without a current copy on the host
+   * @return true if the DPUs are expected to be faster
+   */
+  bool offload(enum pim_op_class op, uint32_t words, uint32_t towers,
+               uint32_t to_push, uint32_t to_pull) const;
+
+  /**
+   * Measures the transfers, the launch latency and the kernels on vectors
+   * held whole by one DPU of the set of PimData and the matching host loops,
+   * then persists the result.
+   */
+  void calibrate();
+
+  const PimCalibration &get_calibration() const { return calibration; }
+
+  // Replaces the calibration, e.g. with one measured on another run
+  void set_calibration(const PimCalibration &c) {
+    std::lock_guard<std::mutex> guard(lock);
+    calibration = c;
+  }
+
+  static std::string calibration_path();
+
+private:
+  PimPlanner();
+
+  PimPlanner(const PimPlanner &) = delete;
+  PimPlanner &operator=(const PimPlanner &) = delete;
+
+  // Fills calibration, lock held
+  void measure();
+
+  std::atomic<bool> on{false};
+  // Written by enable and calibrate, which are expected to run before the
+  // operations that consult it
+  PimCalibration calibration;
+  std::mutex lock;
+};
+
+#endif //_PIM_PLANNER_
@@ -0,0 +1,57 @@
+#ifndef _PIM_POOL_
+#define _PIM_POOL_
+
+#include "PimManager.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A partition leased from PimPool, it goes back to the pool with the last copy
+using PimLease = std::shared_ptr<PimManager>;
+
+/**
+ * PimPool hands out partitions of the DPUs of the machine as leases. A
+ * partition is made of whole ranks and driven by a PimManager of its own, so
+ * its transfers and launches never wait for another partition's: each
+ * CryptoContext, thread or request can own one and work on its ciphertexts
+ * concurrently with the others (bind it with PimBinding).
+ *
+ * A released partition stays allocated with the resident program and its NTT
+ * tables loaded, the next lease of the same size gets it back. The mirrors
+ * materialized on a partition must be released before its lease.
+ */
+class PimPool {
+public:
+  static PimPool &get();
+
+  /**
+   * @param ranks whole ranks of the partition
+   * @param profile profile of the DPUs, as for PimManager::getPim
+   * @throw std::runtime_error if the ranks are not available
+   */
+  PimLease lease(uint32_t ranks = 1, const std::string &profile = "");
+
+  // Released partitions waiting for a lease
+  size_t idle_partitions();
+
+private:
+  PimPool() = default;
+
+  PimPool(const PimPool &) = delete;
+  PimPool &operator=(const PimPool &) = delete;
+
+  struct Partition {
+    uint32_t ranks;
+    std::string profile;
+    std::unique_ptr<PimManager> manager;
+  };
+
+  void release(Partition partition);
+
+  std::mutex lock;
+  std::vector<Partition> idle;
+};
+
+#endif //_PIM_POOL_
@@ -0,0 +1,20 @@
+#ifndef _PIM_RESCALE_
+#define _PIM_RESCALE_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Constants of the rescale of the towers over q_0..q_{count-1} by the tower
+ * over last_mod, as passed to DCRTPolyImpl::DropLastElementAndScale and
+ * ModReduce. PimData::rescale lays them out in the rows of the DPU kernel
+ * (see struct pim_rescale).
+ */
+struct PimRescaleTables {
+  uint64_t last_mod;           // modulus of the last tower
+  std::vector<uint64_t> q;     // moduli of the towers kept
+  std::vector<uint64_t> scale; // factor of the last tower lifted to q_i
+  std::vector<uint64_t> q_inv; // factor of the tower over q_i
+};
+
+#endif //_PIM_RESCALE_
@@ -0,0 +1,40 @@
+#ifndef _PIM_STATS_
+#define _PIM_STATS_
+
+#include "PimBackend.h"
+#include "common.h"
+#include <cstdint>
+#include <string>
+
+// DPU time of one kernel of the resident program (see struct pim_stats)
+struct PimKernelStats {
+  uint64_t launches = 0;
+  // Cycles of the busiest DPU, which the launches lasted on the DPU side
+  uint64_t max_cycles = 0;
+  // Cycles of all the DPUs together
+  uint64_t total_cycles = 0;
+};
+
+/**
+ * Snapshot of the telemetry of a DPU set, from PimManager::get_stats. The
+ * host side counters tell how much time went to the transfers in each
+ * direction, to the loads and to the launches as seen from the host; the DPU
+ * cycles of each kernel tell how much of a launch was compute. The emulator
+ * counts nanoseconds of the host clock instead of cycles.
+ */
+struct PimStats {
+  std::string backend;
+  uint32_t nr_dpus = 0;
+  PimCounters counters;
+  // MRAM bytes in use on each DPU when the snapshot was taken
+  uint64_t mram_in_use = 0;
+  PimKernelStats kernels[PIM_OPCODES];
+
+  // Name of the kernel of an opcode, as used in the JSON export
+  static const char *kernel_name(enum pim_opcode opcode);
+
+  // The snapshot as a single JSON object, e.g. for the output of benchmarks
+  std::string to_json() const;
+};
+
+#endif //_PIM_STATS_
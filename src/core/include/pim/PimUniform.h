@@ -0,0 +1,108 @@
+#ifndef _PIM_UNIFORM_
+#define _PIM_UNIFORM_
+
+#include <array>
+#include <cstdint>
+
+/*
+  Uniform residues expanded from a seed, the host side of the uniform kernel
+  of the DPUs (see struct pim_uniform). Both compute the same words, so a
+  polynomial sampled on the DPUs can be regenerated on the host from its seed
+  alone.
+
+  The stream is the ChaCha20 block function of RFC 8439, keyed by the seed,
+  with the 96-bit nonce split in a rejection round and the 64-bit stream of
+  the tower. Coefficient k reads word k % 8 of block k / 8 (two 32-bit output
+  words, low first), masked to the bit length of q, and draws again from the
+  same word of the next round's block while it is not below q. Every
+  coefficient only depends on its index, the DPUs fill their slices without
+  talking to each other.
+*/
+
+// 256-bit key of the stream
+using PimUniformSeed = std::array<uint32_t, 8>;
+
+static inline uint32_t pim_chacha_rotl(uint32_t v, int c) {
+  return (v << c) | (v >> (32 - c));
+}
+
+#define PIM_CHACHA_QR(a, b, c, d)                                              \
+  a += b;                                                                      \
+  d = pim_chacha_rotl(d ^ a, 16);                                              \
+  c += d;                                                                      \
+  b = pim_chacha_rotl(b ^ c, 12);                                              \
+  a += b;                                                                      \
+  d = pim_chacha_rotl(d ^ a, 8);                                               \
+  c += d;                                                                      \
+  b = pim_chacha_rotl(b ^ c, 7)
+
+/**
+ * ChaCha20 block function (RFC 8439, section 2.3).
+ * @param out the 16 words of the block
+ */
+static inline void pim_chacha20_block(const uint32_t key[8], uint32_t counter,
+                                      const uint32_t nonce[3],
+                                      uint32_t out[16]) {
+  uint32_t x[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                    key[0],     key[1],     key[2],     key[3],
+                    key[4],     key[5],     key[6],     key[7],
+                    counter,    nonce[0],   nonce[1],   nonce[2]};
+  for (int i = 0; i < 16; ++i)
+    out[i] = x[i];
+  for (int i = 0; i < 10; ++i) {
+    PIM_CHACHA_QR(x[0], x[4], x[8], x[12]);
+    PIM_CHACHA_QR(x[1], x[5], x[9], x[13]);
+    PIM_CHACHA_QR(x[2], x[6], x[10], x[14]);
+    PIM_CHACHA_QR(x[3], x[7], x[11], x[15]);
+    PIM_CHACHA_QR(x[0], x[5], x[10], x[15]);
+    PIM_CHACHA_QR(x[1], x[6], x[11], x[12]);
+    PIM_CHACHA_QR(x[2], x[7], x[8], x[13]);
+    PIM_CHACHA_QR(x[3], x[4], x[9], x[14]);
+  }
+  for (int i = 0; i < 16; ++i)
+    out[i] += x[i];
+}
+
+#undef PIM_CHACHA_QR
+
+// Mask of the bit length of q
+static inline uint64_t pim_uniform_mask(uint64_t q) {
+  uint64_t mask = q - 1;
+  for (int s = 1; s < 64; s <<= 1)
+    mask |= mask >> s;
+  return mask;
+}
+
+/**
+ * Coefficients first .. first + count - 1 of the uniform tower over q of the
+ * given stream.
+ * @param out receives count residues below q
+ */
+static inline void pim_uniform_fill(const PimUniformSeed &seed,
+                                    uint64_t stream, uint64_t q,
+                                    uint64_t first, uint64_t count,
+                                    uint64_t *out) {
+  uint64_t mask = pim_uniform_mask(q);
+  uint32_t block[16];
+  uint64_t cached = UINT64_MAX;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t k = first + i;
+    uint32_t j = k & 7;
+    uint32_t nonce[3] = {0, (uint32_t)stream, (uint32_t)(stream >> 32)};
+    if (k >> 3 != cached) {
+      cached = k >> 3;
+      pim_chacha20_block(seed.data(), (uint32_t)cached, nonce, block);
+    }
+    uint64_t v = ((uint64_t)block[2 * j + 1] << 32 | block[2 * j]) & mask;
+    // The next rounds only matter to the rejected words
+    uint32_t retry[16];
+    while (v >= q) {
+      nonce[0]++;
+      pim_chacha20_block(seed.data(), (uint32_t)cached, nonce, retry);
+      v = ((uint64_t)retry[2 * j + 1] << 32 | retry[2 * j]) & mask;
+    }
+    out[i] = v;
+  }
+}
+
+#endif //_PIM_UNIFORM_
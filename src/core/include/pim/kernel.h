@@ -2,9 +2,7 @@
 #define __PIM_KERNEL__
 
 #define BOOT          "./src/pim/dpu/boot"
-#define ELEM_MOD_ADD  "./src/pim/dpu/add-mod"
-#define ELEM_MOD_MULT "./src/pim/dpu/mult-mod"
-#define ELEM_MOD_SUB  "./src/pim/dpu/sub-mod"
-#define ELEM_MOD_OPS  "./src/pim/dpu/mod-ops"
+// Resident binary holding all kernels, dispatched on pim_meta::opcode
+#define PIM_KERNELS   "./src/pim/dpu/pim-kernels"
 
-#endif
\ No newline at end of file
+#endif
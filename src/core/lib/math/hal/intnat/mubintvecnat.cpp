@@ -62,7 +62,8 @@ NativeVectorT<IntegerType>::NativeVectorT(usint length, const IntegerType& modul
 }
 
 template <class IntegerType>
-NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializer_list<std::string> rhs) noexcept {
+NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializer_list<std::string> rhs) {
+    PrepareHostWrite();
     const size_t len = rhs.size();
     if (m_data.size() < len)
         m_data.resize(len);
@@ -80,7 +81,8 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializ
 }
 
 template <class IntegerType>
-NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializer_list<uint64_t> rhs) noexcept {
+NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializer_list<uint64_t> rhs) {
+    PrepareHostWrite();
     const size_t len = rhs.size();
     if (m_data.size() < len)
         m_data.resize(len);
@@ -110,6 +112,7 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::operator=(std::initializ
 template <class IntegerType>
 void NativeVectorT<IntegerType>::SwitchModulus(const IntegerType& modulus) {
     // TODO: #ifdef NATIVEINT_BARRET_MOD
+    PrepareHostWrite();
     auto size{m_data.size()};
     auto halfQ{m_modulus.m_value >> 1};
     auto om{m_modulus.m_value};
@@ -137,7 +140,7 @@ void NativeVectorT<IntegerType>::SwitchModulus(const IntegerType& modulus) {
 
 template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::Mod(const IntegerType& modulus) const {
-    auto ans(*this);
+    auto ans(HostCopy());
     if (modulus.m_value == 2)
         return ans.ModByTwoEq();
     auto nm{modulus.m_value};
@@ -169,6 +172,7 @@ template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModEq(const IntegerType& modulus) {
     if (modulus.m_value == 2)
         return this->NativeVectorT::ModByTwoEq();
+    PrepareHostWrite();
     auto nm{modulus.m_value};
     auto halfQ{m_modulus.m_value >> 1};
     auto om{m_modulus.m_value};
@@ -196,11 +200,19 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModEq(const IntegerType&
 
 template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModAdd(const IntegerType& b) const {
-    auto ans(*this);
     auto mv{m_modulus};
     auto bv{b};
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB)) {
+            NativeVectorT ans(m_data.size(), mv);
+            PushToPim();
+            ans.m_pim = m_pim.ModAdd(bv.ConvertToInt(), mv.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans.m_data[i] = ans.m_data[i].ModAddFast(bv, mv);
     return ans;
@@ -212,6 +224,14 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModAddEq(const IntegerTy
     auto bv{b};
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB)) {
+            PushToPim();
+            m_pim.ModAddEq(bv.ConvertToInt(), mv.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i] = m_data[i].ModAddFast(bv, mv);
     return *this;
@@ -219,13 +239,14 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModAddEq(const IntegerTy
 
 template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModAddAtIndex(size_t i, const IntegerType& b) const {
-    auto ans(*this);
+    auto ans(HostCopy());
     ans.at(i).ModAddEq(b, m_modulus);
     return ans;
 }
 
 template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModAddAtIndexEq(size_t i, const IntegerType& b) {
+    PrepareHostWrite();
     this->NativeVectorT::at(i).ModAddEq(b, m_modulus);
     return *this;
 }
@@ -235,7 +256,17 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModAdd(const NativeVector
     if (m_modulus != b.m_modulus || m_data.size() != b.m_data.size())
         OPENFHE_THROW(lbcrypto::math_error, "ModAdd called on NativeVectorT's with different parameters.");
     auto mv{m_modulus};
-    auto ans(*this);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB, &b)) {
+            NativeVectorT ans(m_data.size(), mv);
+            PushToPim();
+            b.PushToPim(this);
+            ans.m_pim = m_pim.ModAdd(b.m_pim, mv.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
+    b.SyncToHost();
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans.m_data[i].ModAddFastEq(b[i], mv);
     return ans;
@@ -245,19 +276,17 @@ template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModAddEq(const NativeVectorT& b) {
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModAddEq called on NativeVectorT's with different parameters.");
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB, &b)) {
+            PushToPim();
+            b.PushToPim(this);
+            m_pim.ModAddEq(b.m_pim, m_modulus.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
+    b.SyncToHost();
     auto mv{m_modulus};
-
-    // #ifdef RUN_ON_DPU
-    //     if (pim != nullptr && !pim->Run_On_Pim(this, b))
-    //         std::cout << "Run On DPU failed" << std::endl;
-    //     else
-    //         for (size_t i = 0; i < m_data.size(); ++i)
-    //             m_data[i].ModAddFastEq(b[i], mv);
-    // #else
-    //     // for (size_t i = 0; i < m_data.size(); ++i)
-    //     //     m_data[i].ModAddFastEq(b[i], mv);
-    // #endif
-
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i].ModAddFastEq(b[i], mv);
     return *this;
@@ -267,9 +296,17 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModSub(const IntegerType& b) const {
     auto mv{m_modulus};
     auto bv{b};
-    auto ans(*this);
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB)) {
+            NativeVectorT ans(m_data.size(), mv);
+            PushToPim();
+            ans.m_pim = m_pim.ModSub(bv.ConvertToInt(), mv.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].ModSubFastEq(bv, mv);
     return ans;
@@ -281,6 +318,14 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModSubEq(const IntegerTy
     auto bv{b};
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB)) {
+            PushToPim();
+            m_pim.ModSubEq(bv.ConvertToInt(), mv.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i].ModSubFastEq(bv, mv);
     return *this;
@@ -291,7 +336,17 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModSub(const NativeVector
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModSub called on NativeVectorT's with different parameters.");
     auto mv{m_modulus};
-    auto ans(*this);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB, &b)) {
+            NativeVectorT ans(m_data.size(), mv);
+            PushToPim();
+            b.PushToPim(this);
+            ans.m_pim = m_pim.ModSub(b.m_pim, mv.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
+    b.SyncToHost();
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].ModSubFastEq(b[i], mv);
     return ans;
@@ -301,6 +356,16 @@ template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModSubEq(const NativeVectorT& b) {
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModSubEq called on NativeVectorT's with different parameters.");
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_ADD_SUB, &b)) {
+            PushToPim();
+            b.PushToPim(this);
+            m_pim.ModSubEq(b.m_pim, m_modulus.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
+    b.SyncToHost();
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i].ModSubFastEq(b[i], m_modulus);
     return *this;
@@ -310,9 +375,17 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModMul(const IntegerType& b) const {
     auto mv{m_modulus};
     auto bv{b};
-    auto ans(*this);
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_MULT)) {
+            NativeVectorT ans(m_data.size(), mv);
+            PushToPim();
+            ans.m_pim = m_pim.ModMul(bv.ConvertToInt(), mv.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
     auto bconst{bv.PrepModMulConst(mv)};
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].ModMulFastConstEq(bv, mv, bconst);
@@ -325,6 +398,14 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModMulEq(const IntegerTy
     auto bv{b};
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_MULT)) {
+            PushToPim();
+            m_pim.ModMulEq(bv.ConvertToInt(), mv.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
     auto bconst{bv.PrepModMulConst(mv)};
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i].ModMulFastConstEq(bv, mv, bconst);
@@ -335,7 +416,17 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModMul(const NativeVectorT& b) const {
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModMul called on NativeVectorT's with different parameters.");
-    auto ans(*this);
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_MULT, &b)) {
+            NativeVectorT ans(m_data.size(), m_modulus);
+            PushToPim();
+            b.PushToPim(this);
+            ans.m_pim = m_pim.ModMul(b.m_pim, m_modulus.ConvertToInt());
+            return ans;
+        }
+    }
+    auto ans(HostCopy());
+    b.SyncToHost();
     uint32_t size(m_data.size());
     auto mv{m_modulus};
 #ifdef NATIVEINT_BARRET_MOD
@@ -353,6 +444,16 @@ template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModMulEq(const NativeVectorT& b) {
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModMulEq called on NativeVectorT's with different parameters.");
+    if constexpr (sizeof(IntegerType) == sizeof(uint64_t)) {
+        if (OnPim(PIM_OP_MULT, &b)) {
+            PushToPim();
+            b.PushToPim(this);
+            m_pim.ModMulEq(b.m_pim, m_modulus.ConvertToInt());
+            return *this;
+        }
+    }
+    PrepareHostWrite();
+    b.SyncToHost();
     auto mv{m_modulus};
     size_t size{m_data.size()};
 #ifdef NATIVEINT_BARRET_MOD
@@ -368,7 +469,7 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModMulEq(const NativeVec
 
 template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModByTwo() const {
-    auto ans(*this);
+    auto ans(HostCopy());
     auto halfQ{m_modulus.m_value >> 1};
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].m_value = 0x1 & (ans[i].m_value ^ (ans[i].m_value > halfQ));
@@ -377,6 +478,7 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModByTwo() const {
 
 template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModByTwoEq() {
+    PrepareHostWrite();
     auto halfQ{m_modulus.m_value >> 1};
     for (size_t i = 0; i < m_data.size(); ++i)
         m_data[i].m_value = 0x1 & (m_data[i].m_value ^ (m_data[i].m_value > halfQ));
@@ -387,7 +489,7 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModExp(const IntegerType& b) const {
     auto mv{m_modulus};
     auto bv{b};
-    auto ans(*this);
+    auto ans(HostCopy());
     if (bv.m_value >= mv.m_value)
         bv.ModEq(mv);
     for (size_t i = 0; i < ans.m_data.size(); ++i)
@@ -397,6 +499,7 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::ModExp(const IntegerType&
 
 template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::ModExpEq(const IntegerType& b) {
+    PrepareHostWrite();
     auto mv{m_modulus};
     auto bv{b};
     if (bv.m_value >= mv.m_value)
@@ -410,7 +513,8 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::MultWithOutMod(const NativeVectorT& b) const {
     if (m_data.size() != b.m_data.size() || m_modulus != b.m_modulus)
         OPENFHE_THROW(lbcrypto::math_error, "ModMul called on NativeVectorT's with different parameters.");
-    auto ans(*this);
+    auto ans(HostCopy());
+    b.SyncToHost();
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].m_value = ans[i].m_value * b[i].m_value;
     return ans;
@@ -421,7 +525,7 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::MultiplyAndRound(const In
                                                                         const IntegerType& q) const {
     auto halfQ{m_modulus.m_value >> 1};
     auto mv{m_modulus};
-    auto ans(*this);
+    auto ans(HostCopy());
     for (size_t i = 0; i < ans.m_data.size(); ++i) {
         if (ans[i].m_value > halfQ) {
             auto&& tmp{mv - ans[i]};
@@ -436,6 +540,7 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::MultiplyAndRound(const In
 
 template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::MultiplyAndRoundEq(const IntegerType& p, const IntegerType& q) {
+    PrepareHostWrite();
     auto halfQ{m_modulus.m_value >> 1};
     auto mv{m_modulus};
     for (size_t i = 0; i < m_data.size(); ++i) {
@@ -454,7 +559,7 @@ template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::DivideAndRound(const IntegerType& q) const {
     auto halfQ{m_modulus.m_value >> 1};
     auto mv{m_modulus};
-    auto ans(*this);
+    auto ans(HostCopy());
     for (size_t i = 0; i < ans.m_data.size(); ++i) {
         if (ans[i].m_value > halfQ) {
             auto&& tmp{mv - ans[i]};
@@ -469,6 +574,7 @@ NativeVectorT<IntegerType> NativeVectorT<IntegerType>::DivideAndRound(const Inte
 
 template <class IntegerType>
 NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::DivideAndRoundEq(const IntegerType& q) {
+    PrepareHostWrite();
     auto halfQ{m_modulus.m_value >> 1};
     auto mv{m_modulus};
     for (size_t i = 0; i < m_data.size(); ++i) {
@@ -485,7 +591,7 @@ NativeVectorT<IntegerType>& NativeVectorT<IntegerType>::DivideAndRoundEq(const I
 
 template <class IntegerType>
 NativeVectorT<IntegerType> NativeVectorT<IntegerType>::GetDigitAtIndexForBase(usint index, usint base) const {
-    auto ans(*this);
+    auto ans(HostCopy());
     for (size_t i = 0; i < ans.m_data.size(); ++i)
         ans[i].m_value = static_cast<BasicInt>(ans[i].GetDigitAtIndexForBase(index, base));
     return ans;
@@ -0,0 +1,468 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Lazy Harvey NTT of NativeVector with AVX-512 and AVX2 butterflies
+ */
+
+#include "math/hal/intnat/transformnat-simd.h"
+
+#include "utils/exception.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define NTT_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+namespace intnat {
+
+namespace {
+
+constexpr uint64_t NTT_SIMD_MAX_MODULUS = uint64_t(1) << 62;
+
+#ifdef __SIZEOF_INT128__
+
+// a w mod q in [0, 2q) for any 64-bit a, with wPrecon = floor(w 2^64 / q)
+inline uint64_t MulShoupLazy(uint64_t a, uint64_t w, uint64_t wPrecon, uint64_t q) {
+    uint64_t h = static_cast<uint64_t>((static_cast<unsigned __int128>(a) * wPrecon) >> 64);
+    return a * w - h * q;
+}
+
+inline uint64_t ShoupPrecon(uint64_t w, uint64_t q) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(w) << 64) / q);
+}
+
+inline uint64_t Reduce2q(uint64_t x, uint64_t q2) {
+    return x >= q2 ? x - q2 : x;
+}
+
+// Forward stages m..n/2 in [0, 4q), reduced below q after the last one
+void ForwardScalar(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp, uint32_t m) {
+    const uint64_t q2 = q << 1;
+    for (uint32_t t = n / (m << 1); m < n; m <<= 1, t >>= 1) {
+        for (uint32_t i = 0; i < m; ++i) {
+            uint64_t omega = w[m + i], preconOmega = wp[m + i];
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; ++j) {
+                uint64_t lo = Reduce2q(x[j], q2);
+                uint64_t hi = MulShoupLazy(y[j], omega, preconOmega, q);
+                x[j] = lo + hi;
+                y[j] = lo - hi + q2;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t v = Reduce2q(a[i], q2);
+        a[i] = v >= q ? v - q : v;
+    }
+}
+
+// Inverse stages n/2..m+1 (m >= 1) in [0, 2q)
+void InverseScalar(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp, uint32_t m) {
+    const uint64_t q2 = q << 1;
+    for (uint32_t s = n >> 1, t = 1; s > m; s >>= 1, t <<= 1) {
+        for (uint32_t i = 0; i < s; ++i) {
+            uint64_t omega = w[s + i], preconOmega = wp[s + i];
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; ++j) {
+                uint64_t lo = x[j], hi = y[j];
+                x[j] = Reduce2q(lo + hi, q2);
+                y[j] = MulShoupLazy(lo - hi + q2, omega, preconOmega, q);
+            }
+        }
+    }
+}
+
+// Last inverse stage, scaled by nInv and reduced below q
+void InverseLastScalar(uint64_t* a, uint32_t n, uint64_t q, uint64_t nInv, uint64_t nInvPrecon, uint64_t wn,
+                       uint64_t wnPrecon, uint32_t first) {
+    const uint64_t q2 = q << 1;
+    uint32_t t = n >> 1;
+    for (uint32_t j = first; j < t; ++j) {
+        uint64_t lo = a[j], hi = a[j + t];
+        uint64_t x = MulShoupLazy(Reduce2q(lo + hi, q2), nInv, nInvPrecon, q);
+        uint64_t y = MulShoupLazy(lo - hi + q2, wn, wnPrecon, q);
+        a[j]     = x >= q ? x - q : x;
+        a[j + t] = y >= q ? y - q : y;
+    }
+}
+
+#endif  // __SIZEOF_INT128__
+
+#ifdef NTT_SIMD_X86
+
+    #define NTT_AVX512 __attribute__((target("avx512f,avx512dq")))
+    #define NTT_AVX2   __attribute__((target("avx2")))
+
+    #if defined(__GNUC__) && !defined(__clang__)
+        // GCC 12 flags the undefined pass-through vector of the unmasked AVX-512 intrinsics
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #endif
+
+// High word of the 64x64 products, from 32x32 ones: AVX-512F has no 64-bit
+// high multiply (IFMA only has 52 bits)
+NTT_AVX512 inline __m512i MulHi512(__m512i a, __m512i b, __m512i bHi) {
+    const __m512i lo32 = _mm512_set1_epi64(0xffffffff);
+    __m512i aHi        = _mm512_srli_epi64(a, 32);
+    __m512i ll         = _mm512_mul_epu32(a, b);
+    __m512i lh         = _mm512_mul_epu32(a, bHi);
+    __m512i hl         = _mm512_mul_epu32(aHi, b);
+    __m512i hh         = _mm512_mul_epu32(aHi, bHi);
+    __m512i mid        = _mm512_add_epi64(_mm512_srli_epi64(ll, 32), _mm512_and_si512(lh, lo32));
+    mid                = _mm512_add_epi64(mid, _mm512_and_si512(hl, lo32));
+    hh                 = _mm512_add_epi64(hh, _mm512_srli_epi64(lh, 32));
+    hh                 = _mm512_add_epi64(hh, _mm512_srli_epi64(hl, 32));
+    return _mm512_add_epi64(hh, _mm512_srli_epi64(mid, 32));
+}
+
+// Lazy Shoup product in [0, 2q)
+NTT_AVX512 inline __m512i MulShoup512(__m512i a, __m512i w, __m512i wp, __m512i wpHi, __m512i q) {
+    __m512i h = MulHi512(a, wp, wpHi);
+    return _mm512_sub_epi64(_mm512_mullo_epi64(a, w), _mm512_mullo_epi64(h, q));
+}
+
+NTT_AVX512 inline __m512i Reduce512(__m512i x, __m512i q) {
+    return _mm512_min_epu64(x, _mm512_sub_epi64(x, q));
+}
+
+// Forward stages with at least 8 butterflies per twiddle, returns the next stage
+NTT_AVX512 uint32_t ForwardAvx512(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp) {
+    const __m512i vq  = _mm512_set1_epi64(q);
+    const __m512i vq2 = _mm512_set1_epi64(q << 1);
+    uint32_t m = 1;
+    for (uint32_t t = n >> 1; t >= 8; m <<= 1, t >>= 1) {
+        for (uint32_t i = 0; i < m; ++i) {
+            __m512i omega       = _mm512_set1_epi64(w[m + i]);
+            __m512i preconOmega = _mm512_set1_epi64(wp[m + i]);
+            __m512i preconHi    = _mm512_set1_epi64(wp[m + i] >> 32);
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; j += 8) {
+                __m512i lo = Reduce512(_mm512_loadu_si512(x + j), vq2);
+                __m512i hi = MulShoup512(_mm512_loadu_si512(y + j), omega, preconOmega, preconHi, vq);
+                _mm512_storeu_si512(x + j, _mm512_add_epi64(lo, hi));
+                _mm512_storeu_si512(y + j, _mm512_add_epi64(_mm512_sub_epi64(lo, hi), vq2));
+            }
+        }
+    }
+    return m;
+}
+
+// Inverse stages from the one with 8 butterflies per twiddle down to m + 1
+NTT_AVX512 void InverseAvx512(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp,
+                              uint32_t m) {
+    const __m512i vq  = _mm512_set1_epi64(q);
+    const __m512i vq2 = _mm512_set1_epi64(q << 1);
+    for (uint32_t s = n >> 4, t = 8; s > m; s >>= 1, t <<= 1) {
+        for (uint32_t i = 0; i < s; ++i) {
+            __m512i omega       = _mm512_set1_epi64(w[s + i]);
+            __m512i preconOmega = _mm512_set1_epi64(wp[s + i]);
+            __m512i preconHi    = _mm512_set1_epi64(wp[s + i] >> 32);
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; j += 8) {
+                __m512i lo = _mm512_loadu_si512(x + j);
+                __m512i hi = _mm512_loadu_si512(y + j);
+                _mm512_storeu_si512(x + j, Reduce512(_mm512_add_epi64(lo, hi), vq2));
+                __m512i diff = _mm512_add_epi64(_mm512_sub_epi64(lo, hi), vq2);
+                _mm512_storeu_si512(y + j, MulShoup512(diff, omega, preconOmega, preconHi, vq));
+            }
+        }
+    }
+}
+
+// Vector part of the last inverse stage, returns the first butterfly left
+NTT_AVX512 uint32_t InverseLastAvx512(uint64_t* a, uint32_t n, uint64_t q, uint64_t nInv, uint64_t nInvPrecon,
+                                      uint64_t wn, uint64_t wnPrecon) {
+    const __m512i vq   = _mm512_set1_epi64(q);
+    const __m512i vq2  = _mm512_set1_epi64(q << 1);
+    const __m512i vn   = _mm512_set1_epi64(nInv);
+    const __m512i vnp  = _mm512_set1_epi64(nInvPrecon);
+    const __m512i vnpH = _mm512_set1_epi64(nInvPrecon >> 32);
+    const __m512i vw   = _mm512_set1_epi64(wn);
+    const __m512i vwp  = _mm512_set1_epi64(wnPrecon);
+    const __m512i vwpH = _mm512_set1_epi64(wnPrecon >> 32);
+    uint32_t t = n >> 1, j = 0;
+    for (; j + 8 <= t; j += 8) {
+        __m512i lo   = _mm512_loadu_si512(a + j);
+        __m512i hi   = _mm512_loadu_si512(a + j + t);
+        __m512i sum  = Reduce512(_mm512_add_epi64(lo, hi), vq2);
+        __m512i diff = _mm512_add_epi64(_mm512_sub_epi64(lo, hi), vq2);
+        _mm512_storeu_si512(a + j, Reduce512(MulShoup512(sum, vn, vnp, vnpH, vq), vq));
+        _mm512_storeu_si512(a + j + t, Reduce512(MulShoup512(diff, vw, vwp, vwpH, vq), vq));
+    }
+    return j;
+}
+
+    #if defined(__GNUC__) && !defined(__clang__)
+        #pragma GCC diagnostic pop
+    #endif
+
+NTT_AVX2 inline __m256i MulHi256(__m256i a, __m256i b, __m256i bHi) {
+    const __m256i lo32 = _mm256_set1_epi64x(0xffffffff);
+    __m256i aHi        = _mm256_srli_epi64(a, 32);
+    __m256i ll         = _mm256_mul_epu32(a, b);
+    __m256i lh         = _mm256_mul_epu32(a, bHi);
+    __m256i hl         = _mm256_mul_epu32(aHi, b);
+    __m256i hh         = _mm256_mul_epu32(aHi, bHi);
+    __m256i mid        = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_and_si256(lh, lo32));
+    mid                = _mm256_add_epi64(mid, _mm256_and_si256(hl, lo32));
+    hh                 = _mm256_add_epi64(hh, _mm256_srli_epi64(lh, 32));
+    hh                 = _mm256_add_epi64(hh, _mm256_srli_epi64(hl, 32));
+    return _mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32));
+}
+
+// Low word of the 64x64 products, AVX2 has no 64-bit multiply
+NTT_AVX2 inline __m256i MulLo256(__m256i a, __m256i b, __m256i bHi) {
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, bHi));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+// Lazy Shoup product in [0, 2q), the high halves of w, wp and q given
+NTT_AVX2 inline __m256i MulShoup256(__m256i a, __m256i w, __m256i wHi, __m256i wp, __m256i wpHi, __m256i q,
+                                    __m256i qHi) {
+    __m256i h = MulHi256(a, wp, wpHi);
+    return _mm256_sub_epi64(MulLo256(a, w, wHi), MulLo256(h, q, qHi));
+}
+
+// x - q if x >= q, unsigned compare through the sign bit
+NTT_AVX2 inline __m256i Reduce256(__m256i x, __m256i q) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    __m256i below      = _mm256_cmpgt_epi64(_mm256_xor_si256(q, sign), _mm256_xor_si256(x, sign));
+    return _mm256_sub_epi64(x, _mm256_andnot_si256(below, q));
+}
+
+NTT_AVX2 uint32_t ForwardAvx2(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp) {
+    const __m256i vq   = _mm256_set1_epi64x(q);
+    const __m256i vqHi = _mm256_srli_epi64(vq, 32);
+    const __m256i vq2  = _mm256_set1_epi64x(q << 1);
+    uint32_t m         = 1;
+    for (uint32_t t = n >> 1; t >= 4; m <<= 1, t >>= 1) {
+        for (uint32_t i = 0; i < m; ++i) {
+            __m256i omega       = _mm256_set1_epi64x(w[m + i]);
+            __m256i omegaHi     = _mm256_srli_epi64(omega, 32);
+            __m256i preconOmega = _mm256_set1_epi64x(wp[m + i]);
+            __m256i preconHi    = _mm256_srli_epi64(preconOmega, 32);
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; j += 4) {
+                __m256i lo = Reduce256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j)), vq2);
+                __m256i hi = MulShoup256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + j)), omega,
+                                         omegaHi, preconOmega, preconHi, vq, vqHi);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j), _mm256_add_epi64(lo, hi));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j),
+                                    _mm256_add_epi64(_mm256_sub_epi64(lo, hi), vq2));
+            }
+        }
+    }
+    return m;
+}
+
+NTT_AVX2 void InverseAvx2(uint64_t* a, uint32_t n, uint64_t q, const uint64_t* w, const uint64_t* wp, uint32_t m) {
+    const __m256i vq   = _mm256_set1_epi64x(q);
+    const __m256i vqHi = _mm256_srli_epi64(vq, 32);
+    const __m256i vq2  = _mm256_set1_epi64x(q << 1);
+    for (uint32_t s = n >> 3, t = 4; s > m; s >>= 1, t <<= 1) {
+        for (uint32_t i = 0; i < s; ++i) {
+            __m256i omega       = _mm256_set1_epi64x(w[s + i]);
+            __m256i omegaHi     = _mm256_srli_epi64(omega, 32);
+            __m256i preconOmega = _mm256_set1_epi64x(wp[s + i]);
+            __m256i preconHi    = _mm256_srli_epi64(preconOmega, 32);
+            uint64_t *x = a + 2 * i * t, *y = x + t;
+            for (uint32_t j = 0; j < t; j += 4) {
+                __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+                __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + j));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j), Reduce256(_mm256_add_epi64(lo, hi), vq2));
+                __m256i diff = _mm256_add_epi64(_mm256_sub_epi64(lo, hi), vq2);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j),
+                                    MulShoup256(diff, omega, omegaHi, preconOmega, preconHi, vq, vqHi));
+            }
+        }
+    }
+}
+
+NTT_AVX2 uint32_t InverseLastAvx2(uint64_t* a, uint32_t n, uint64_t q, uint64_t nInv, uint64_t nInvPrecon,
+                                  uint64_t wn, uint64_t wnPrecon) {
+    const __m256i vq   = _mm256_set1_epi64x(q);
+    const __m256i vqHi = _mm256_srli_epi64(vq, 32);
+    const __m256i vq2  = _mm256_set1_epi64x(q << 1);
+    const __m256i vn   = _mm256_set1_epi64x(nInv);
+    const __m256i vnH  = _mm256_srli_epi64(vn, 32);
+    const __m256i vnp  = _mm256_set1_epi64x(nInvPrecon);
+    const __m256i vnpH = _mm256_srli_epi64(vnp, 32);
+    const __m256i vw   = _mm256_set1_epi64x(wn);
+    const __m256i vwH  = _mm256_srli_epi64(vw, 32);
+    const __m256i vwp  = _mm256_set1_epi64x(wnPrecon);
+    const __m256i vwpH = _mm256_srli_epi64(vwp, 32);
+    uint32_t t = n >> 1, j = 0;
+    for (; j + 4 <= t; j += 4) {
+        __m256i lo   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i hi   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j + t));
+        __m256i sum  = Reduce256(_mm256_add_epi64(lo, hi), vq2);
+        __m256i diff = _mm256_add_epi64(_mm256_sub_epi64(lo, hi), vq2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + j),
+                            Reduce256(MulShoup256(sum, vn, vnH, vnp, vnpH, vq, vqHi), vq));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + j + t),
+                            Reduce256(MulShoup256(diff, vw, vwH, vwp, vwpH, vq, vqHi), vq));
+    }
+    return j;
+}
+
+#endif  // NTT_SIMD_X86
+
+NttSimdPath BestPath() {
+    for (auto path : {NttSimdPath::AVX512, NttSimdPath::AVX2, NttSimdPath::SCALAR}) {
+        if (NttSimdSupported(path))
+            return path;
+    }
+    return NttSimdPath::OFF;
+}
+
+NttSimdPath InitialPath() {
+    const char* env = std::getenv("OPENFHE_NTT_SIMD");
+    std::string name{env != nullptr ? env : ""};
+    if (name.empty())
+        return BestPath();
+    for (auto path : {NttSimdPath::OFF, NttSimdPath::SCALAR, NttSimdPath::AVX2, NttSimdPath::AVX512}) {
+        if (name == NttSimdPathName(path)) {
+            if (!NttSimdSupported(path))
+                OPENFHE_THROW(lbcrypto::config_error, "OPENFHE_NTT_SIMD: " + name + " is not supported by this CPU");
+            return path;
+        }
+    }
+    OPENFHE_THROW(lbcrypto::config_error, "OPENFHE_NTT_SIMD: unknown path " + name);
+}
+
+std::atomic<NttSimdPath>& SelectedPath() {
+    static std::atomic<NttSimdPath> path{InitialPath()};
+    return path;
+}
+
+}  // namespace
+
+bool NttSimdSupported(NttSimdPath path) {
+    switch (path) {
+        case NttSimdPath::OFF:
+            return true;
+#ifdef __SIZEOF_INT128__
+        case NttSimdPath::SCALAR:
+            return true;
+    #ifdef NTT_SIMD_X86
+        case NttSimdPath::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case NttSimdPath::AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+    #endif
+#endif
+        default:
+            return false;
+    }
+}
+
+NttSimdPath GetNttSimdPath() {
+    return SelectedPath().load(std::memory_order_relaxed);
+}
+
+void SetNttSimdPath(NttSimdPath path) {
+    if (!NttSimdSupported(path))
+        OPENFHE_THROW(lbcrypto::config_error, "NTT path " + NttSimdPathName(path) + " is not supported by this CPU");
+    SelectedPath().store(path, std::memory_order_relaxed);
+}
+
+std::string NttSimdPathName(NttSimdPath path) {
+    switch (path) {
+        case NttSimdPath::SCALAR:
+            return "scalar";
+        case NttSimdPath::AVX2:
+            return "avx2";
+        case NttSimdPath::AVX512:
+            return "avx512";
+        default:
+            return "off";
+    }
+}
+
+bool NttSimdForward(uint64_t* element, uint32_t n, uint64_t q, const uint64_t* rootOfUnityTable,
+                    const uint64_t* preconRootOfUnityTable) {
+    NttSimdPath path = GetNttSimdPath();
+    if (path == NttSimdPath::OFF || q >= NTT_SIMD_MAX_MODULUS || n < 2)
+        return false;
+#ifdef __SIZEOF_INT128__
+    uint32_t m = 1;
+    #ifdef NTT_SIMD_X86
+    if (path == NttSimdPath::AVX512)
+        m = ForwardAvx512(element, n, q, rootOfUnityTable, preconRootOfUnityTable);
+    else if (path == NttSimdPath::AVX2)
+        m = ForwardAvx2(element, n, q, rootOfUnityTable, preconRootOfUnityTable);
+    #endif
+    ForwardScalar(element, n, q, rootOfUnityTable, preconRootOfUnityTable, m);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NttSimdInverse(uint64_t* element, uint32_t n, uint64_t q, const uint64_t* rootOfUnityInverseTable,
+                    const uint64_t* preconRootOfUnityInverseTable, uint64_t cycloOrderInv,
+                    uint64_t preconCycloOrderInv) {
+    NttSimdPath path = GetNttSimdPath();
+    if (path == NttSimdPath::OFF || q >= NTT_SIMD_MAX_MODULUS || n < 2)
+        return false;
+#ifdef __SIZEOF_INT128__
+    const uint64_t* w  = rootOfUnityInverseTable;
+    const uint64_t* wp = preconRootOfUnityInverseTable;
+    // The stages with too few butterflies per twiddle for a vector stay scalar
+    uint32_t lanes = path == NttSimdPath::AVX512 ? 8 : path == NttSimdPath::AVX2 ? 4 : n;
+    uint32_t m     = n / (2 * lanes) > 1 ? n / (2 * lanes) : 1;
+    InverseScalar(element, n, q, w, wp, m);
+    // The last stage is scaled by n^-1: its twiddle is folded with it
+    uint64_t wn = static_cast<uint64_t>((static_cast<unsigned __int128>(w[1]) * cycloOrderInv) % q);
+    uint64_t wnPrecon = ShoupPrecon(wn, q);
+    uint32_t first    = 0;
+    #ifdef NTT_SIMD_X86
+    if (path == NttSimdPath::AVX512) {
+        InverseAvx512(element, n, q, w, wp, 1);
+        first = InverseLastAvx512(element, n, q, cycloOrderInv, preconCycloOrderInv, wn, wnPrecon);
+    }
+    else if (path == NttSimdPath::AVX2) {
+        InverseAvx2(element, n, q, w, wp, 1);
+        first = InverseLastAvx2(element, n, q, cycloOrderInv, preconCycloOrderInv, wn, wnPrecon);
+    }
+    #endif
+    InverseLastScalar(element, n, q, cycloOrderInv, preconCycloOrderInv, wn, wnPrecon, first);
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace intnat
@@ -0,0 +1,105 @@
+#ifndef __PIM_BASE_CONV__
+#define __PIM_BASE_CONV__
+
+/*
+  Fast base conversion of the coefficient slices held by this DPU, the device
+  side of DCRTPolyImpl::ApproxSwitchCRTBasis (see struct pim_base_conv). The
+  including program defines meta and my_barrier.
+
+  The tasklets take tiles of coefficients in turn. For a tile, the products
+  [x_i (Q/q_i)^-1]_{q_i} of every input tower are kept in WRAM; each output
+  tower then sums them against its row of [Q/q_i]_{p_j} in 128 bits and
+  reduces the sums with Barrett. Only the constants of the q_i stay in WRAM
+  for the whole launch, the row of an output tower is read per tile so that
+  the WRAM taken does not grow with size_p.
+*/
+
+// Reads bytes of MRAM at addr into WRAM, in transfers of at most
+// STREAM_DMA_MAX bytes
+static void base_conv_read(uint32_t addr, NativeInt *wram, uint32_t bytes) {
+  for (uint32_t done = 0; done < bytes; done += STREAM_DMA_MAX) {
+    uint32_t chunk =
+        bytes - done < STREAM_DMA_MAX ? bytes - done : STREAM_DMA_MAX;
+    mram_read((__mram_ptr void const *)(addr + done),
+              (uint8_t *)wram + done, chunk);
+  }
+}
+
+/*
+  Coefficients of a tile: each takes size_q + 1 words of WRAM next to the
+  5 size_q + 4 words of constants, offsets and row of a tasklet.
+*/
+static uint32_t base_conv_tile(uint32_t size_q, uint32_t len) {
+  uint32_t share = STREAM_WRAM_HEAP / NR_TASKLETS / sizeof(NativeInt);
+  uint32_t fixed = 5 * size_q + 4;
+  uint32_t tile = share > fixed ? (share - fixed) / (size_q + 1) : 1;
+  if (tile > STREAM_DMA_MAX / sizeof(NativeInt))
+    tile = STREAM_DMA_MAX / sizeof(NativeInt);
+  if (DIVROUNDUP(len, NR_TASKLETS) < tile)
+    tile = DIVROUNDUP(len, NR_TASKLETS);
+  return tile != 0 ? tile : 1;
+}
+
+int base_conv(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t size_q = meta.args.conv.size_q;
+  uint32_t size_p = meta.args.conv.size_p;
+  uint32_t len = meta.args.conv.len;
+  uint32_t record = size_q + 3;
+  uint32_t tile = base_conv_tile(size_q, len);
+  uint32_t heap = (uint32_t)DPU_MRAM_HEAP_POINTER;
+  uint32_t offsets = heap + meta.args.conv.towers;
+  uint32_t tables = heap + meta.args.conv.tables;
+  uint32_t rows = tables + 3 * size_q * sizeof(NativeInt);
+
+  // q_i, (Q/q_i)^-1 and its precomputation for each q_i, then the offsets of
+  // the input towers
+  NativeInt *in = (NativeInt *)mem_alloc(4 * size_q * sizeof(NativeInt));
+  NativeInt *row = (NativeInt *)mem_alloc(record * sizeof(NativeInt));
+  NativeInt *x = (NativeInt *)mem_alloc(size_q * tile * sizeof(NativeInt));
+  NativeInt *res = (NativeInt *)mem_alloc(tile * sizeof(NativeInt));
+  NativeInt *dst = (NativeInt *)mem_alloc(sizeof(NativeInt));
+  base_conv_read(tables, in, 3 * size_q * sizeof(NativeInt));
+  base_conv_read(offsets, in + 3 * size_q, size_q * sizeof(NativeInt));
+
+  for (uint32_t first = tasklet_id * tile; first < len;
+       first += tile * NR_TASKLETS) {
+    uint32_t words = len - first < tile ? len - first : tile;
+    uint32_t bytes = words * sizeof(NativeInt);
+    uint32_t skip = first * sizeof(NativeInt);
+
+    for (uint32_t i = 0; i < size_q; ++i) {
+      NativeInt *xi = x + i * tile;
+      mram_read((__mram_ptr void const *)(heap + in[3 * size_q + i] + skip),
+                xi, bytes);
+      for (uint32_t k = 0; k < words; ++k)
+        ModMulFastConstEq(&xi[k], in[3 * i + 1], in[3 * i], in[3 * i + 2]);
+    }
+
+    for (uint32_t j = 0; j < size_p; ++j) {
+      mram_read((__mram_ptr void const *)(offsets +
+                                          (size_q + j) * sizeof(NativeInt)),
+                dst, sizeof(NativeInt));
+      base_conv_read(rows + j * record * sizeof(NativeInt), row,
+                     record * sizeof(NativeInt));
+      for (uint32_t k = 0; k < words; ++k) {
+        struct typeD sum = {0, 0};
+        struct typeD prod;
+        for (uint32_t i = 0; i < size_q; ++i) {
+          MultD(x[i * tile + k], row[3 + i], &prod);
+          AddD(&sum, prod);
+        }
+        res[k] = BarrettDMod(sum, row[0], row[1], row[2]);
+      }
+      mram_write(res, (__mram_ptr void *)(heap + dst[0] + skip), bytes);
+    }
+  }
+  return 0;
+}
+
+#endif // __PIM_BASE_CONV__
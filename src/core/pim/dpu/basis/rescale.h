@@ -0,0 +1,83 @@
+#ifndef __PIM_RESCALE__
+#define __PIM_RESCALE__
+
+/*
+  Rescale of the tower slices held by this DPU by the slice of the last tower
+  (see struct pim_rescale). The including program defines meta and
+  my_barrier.
+
+  The tasklets take tiles of coefficients in turn. The tile of the last tower
+  stays in WRAM while the row and the tiles of every other tower are streamed
+  through it. The lifted coefficient is below last_mod + q, so a Shoup
+  product with it is still in [0, 2 q) for moduli of up to 62 bits.
+*/
+
+#define RESCALE_ROW 8
+
+int rescale(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t mode = meta.args.rescale.mode;
+  uint32_t count = meta.args.rescale.count;
+  uint32_t bytes = meta.args.rescale.len * sizeof(NativeInt);
+  NativeInt half = meta.args.rescale.last_mod >> 1;
+  uint32_t heap = (uint32_t)DPU_MRAM_HEAP_POINTER;
+  uint32_t last = heap + meta.args.rescale.last;
+  uint32_t rows = heap + meta.args.rescale.rows;
+
+  uint32_t tile = stream_tile_bytes(bytes, 3);
+  NativeInt *lifted = (NativeInt *)mem_alloc(tile);
+  NativeInt *x = (NativeInt *)mem_alloc(tile);
+  NativeInt *y = (NativeInt *)mem_alloc(tile);
+  NativeInt *row = (NativeInt *)mem_alloc(RESCALE_ROW * sizeof(NativeInt));
+
+  for (uint32_t first = tasklet_id * tile; first < bytes;
+       first += tile * NR_TASKLETS) {
+    uint32_t chunk = bytes - first < tile ? bytes - first : tile;
+    uint32_t words = chunk >> 3;
+
+    if (mode != RESCALE_ADD)
+      mram_read((__mram_ptr void const *)(last + first), lifted, chunk);
+
+    for (uint32_t i = 0; i < count; ++i) {
+      mram_read((__mram_ptr void const *)(rows + i * RESCALE_ROW *
+                                                     sizeof(NativeInt)),
+                row, RESCALE_ROW * sizeof(NativeInt));
+      NativeInt q = row[0];
+      uint32_t x_addr = heap + (uint32_t)row[6];
+      uint32_t y_addr = heap + (uint32_t)row[7];
+
+      // y = [last]_q scale, reduced below q
+      if (mode == RESCALE_ADD) {
+        mram_read((__mram_ptr void const *)(y_addr + first), y, chunk);
+      } else {
+        for (uint32_t k = 0; k < words; ++k) {
+          NativeInt v = lifted[k] > half ? lifted[k] + row[1] : lifted[k];
+          NativeInt prod = v * row[2] - MultDHi(v, row[3]) * q;
+          y[k] = prod >= q ? prod - q : prod;
+        }
+      }
+      if (mode == RESCALE_SWITCH) {
+        STREAM_DUMP(first, y, words);
+        mram_write(y, (__mram_ptr void *)(y_addr + first), chunk);
+        continue;
+      }
+
+      mram_read((__mram_ptr void const *)(x_addr + first), x, chunk);
+      for (uint32_t k = 0; k < words; ++k) {
+        ModMulFastConstEq(&x[k], row[4], q, row[5]);
+        NativeInt sum = x[k] + y[k];
+        x[k] = sum >= q ? sum - q : sum;
+      }
+      STREAM_DUMP(first, x, words);
+      mram_write(x, (__mram_ptr void *)(x_addr + first), chunk);
+    }
+  }
+  return 0;
+}
+
+#endif // __PIM_RESCALE__
@@ -0,0 +1,309 @@
+#ifndef __PIM_BLIND_ROTATE__
+#define __PIM_BLIND_ROTATE__
+
+/*
+  CGGI blind rotation of a gate bootstrapping on a single DPU, the device side
+  of BinFHEScheme::BootstrapGateCore and RingGSWAccumulatorCGGI::EvalAcc,
+  followed by the sample extraction of EvalBinGate (see struct
+  pim_blind_rotate). The including program defines meta and my_barrier and
+  includes ntt.h before.
+
+  The accumulator, its coefficient form and the digits of its decomposition
+  stay in MRAM. The tasklets take the tiles of BOOT_TILE coefficients in turn
+  and meet on the barrier between two phases, the NTTs run with all of them.
+  The WRAM buffers of the NTTs are reused by the other phases.
+*/
+
+// Coefficients of a tile, 4 BOOT_TILE words have to fit in the NTT_TILE words
+// of the data buffer of the NTTs
+#define BOOT_TILE 32
+
+// WRAM buffers of a tasklet
+struct boot_buffers {
+  NativeInt *data;     // NTT_TILE words
+  NativeInt *w;        // NTT_TILE / 2 words
+  NativeInt *w_precon; // NTT_TILE / 2 words
+  NativeInt *scale;    // 2 words
+};
+
+// MRAM addresses of the launch
+struct boot_layout {
+  uint32_t acc[2];  // accumulator, evaluation form
+  uint32_t coef[2]; // its coefficient form
+  uint32_t dct;     // digits of the decomposition, N words each
+  uint32_t powers; // monomials X^e - 1
+  uint32_t exponents;
+  uint32_t blocks; // MRAM offsets of the blocks of the key
+  uint32_t index; // monomial indexes of the ciphertext
+  uint32_t out;
+};
+
+static struct ntt_view boot_view(uint32_t data) {
+  struct ntt_view v;
+  v.data = data;
+  v.n = meta.args.boot.N;
+  v.len = v.n;
+  v.slice = 0;
+  v.tables = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.boot.ntt);
+  v.mod = meta.args.boot.mod;
+  return v;
+}
+
+// Accumulator of the test vector of the gate, as BootstrapGateCore builds it
+static void boot_init(const struct boot_layout *l, const struct pim_gate *job,
+                      const struct boot_buffers *buf) {
+  uint32_t N = meta.args.boot.N;
+  NativeInt Q = meta.args.boot.mod;
+  NativeInt q = job->q;
+  uint32_t factor = 2 * N / (uint32_t)q;
+  NativeInt *zero = buf->data;
+  NativeInt *m = buf->data + BOOT_TILE;
+
+  for (uint32_t j = 0; j < BOOT_TILE; ++j)
+    zero[j] = 0;
+  for (uint32_t k = me() * BOOT_TILE; k < N; k += NR_TASKLETS * BOOT_TILE) {
+    for (uint32_t j = 0; j < BOOT_TILE; ++j) {
+      uint32_t p = k + j;
+      m[j] = 0;
+      if (p % factor == 0) {
+        NativeInt temp = ModSubFast(job->b, p / factor, q);
+        int in_range = job->q1 < job->q2
+                           ? temp >= job->q1 && temp < job->q2
+                           : !(temp >= job->q2 && temp < job->q1);
+        m[j] = in_range ? Q - job->q2p : job->q2p;
+      }
+    }
+    mram_write(zero, (__mram_ptr void *)(l->acc[0] + k * sizeof(NativeInt)),
+               BOOT_TILE * sizeof(NativeInt));
+    mram_write(m, (__mram_ptr void *)(l->acc[1] + k * sizeof(NativeInt)),
+               BOOT_TILE * sizeof(NativeInt));
+  }
+  barrier_wait(&my_barrier);
+  struct ntt_view v = boot_view(l->acc[1]);
+  ntt_forward_view(&v, buf->data, buf->w, buf->w_precon);
+}
+
+/*
+  Signed digits of the coefficient form of the accumulator, as
+  RingGSWAccumulator::SignedDigitDecompose: the even digits come from the
+  first polynomial, the odd ones from the second, the first digit of each is
+  dropped by the approximate gadget decomposition.
+*/
+static void boot_decompose(const struct boot_layout *l,
+                           const struct boot_buffers *buf) {
+  uint32_t N = meta.args.boot.N;
+  SignedNativeInt Q = (SignedNativeInt)meta.args.boot.mod;
+  NativeInt q_half = meta.args.boot.mod >> 1;
+  uint32_t g_bits = meta.args.boot.g_bits;
+  uint32_t shift = 64 - g_bits;
+  SignedNativeInt *d[2] = {(SignedNativeInt *)buf->data,
+                           (SignedNativeInt *)buf->data + BOOT_TILE};
+  NativeInt *r[2] = {buf->data + 2 * BOOT_TILE, buf->data + 3 * BOOT_TILE};
+
+  for (uint32_t k = me() * BOOT_TILE; k < N; k += NR_TASKLETS * BOOT_TILE) {
+    for (uint32_t c = 0; c < 2; ++c) {
+      mram_read((__mram_ptr void const *)(l->coef[c] + k * sizeof(NativeInt)),
+                d[c], BOOT_TILE * sizeof(NativeInt));
+      for (uint32_t j = 0; j < BOOT_TILE; ++j) {
+        NativeInt t = (NativeInt)d[c][j];
+        SignedNativeInt x = t < q_half ? (SignedNativeInt)t : t - Q;
+        SignedNativeInt low = (SignedNativeInt)((NativeInt)x << shift) >> shift;
+        d[c][j] = (x - low) >> g_bits;
+      }
+    }
+    for (uint32_t digit = 0; digit < meta.args.boot.digits; digit += 2) {
+      for (uint32_t c = 0; c < 2; ++c) {
+        for (uint32_t j = 0; j < BOOT_TILE; ++j) {
+          SignedNativeInt x = d[c][j];
+          SignedNativeInt low =
+              (SignedNativeInt)((NativeInt)x << shift) >> shift;
+          d[c][j] = (x - low) >> g_bits;
+          r[c][j] = (NativeInt)(low < 0 ? low + Q : low);
+        }
+        uint32_t dst = l->dct + ((digit + c) * N + k) * sizeof(NativeInt);
+        mram_write(r[c], (__mram_ptr void *)dst,
+                   BOOT_TILE * sizeof(NativeInt));
+      }
+    }
+  }
+  barrier_wait(&my_barrier);
+}
+
+/*
+  acc += (dct * ek1) (X^a - 1) + (dct * ek2) (X^-a - 1) with the keys of the
+  coefficient i of the block at keys, as AddToAccCGGI. The monomials come from
+  the table of the key image: X^a - 1 at the slot j is its entry a e_j.
+*/
+static void boot_accumulate(const struct boot_layout *l, uint32_t i,
+                            uint32_t a, uint32_t keys,
+                            const struct boot_buffers *buf) {
+  uint32_t N = meta.args.boot.N;
+  uint32_t M = 2 * N;
+  uint32_t digits = meta.args.boot.digits;
+  NativeInt Q = meta.args.boot.mod;
+  NativeInt mu = meta.args.boot.mu;
+  uint32_t neg = (M - a) % M;
+  // s[2 secret + c], the sums of the products with the keys of the secrets 1
+  // and -1 for the two polynomials of the accumulator
+  NativeInt *s = buf->data;
+  NativeInt *digit = buf->w;
+  NativeInt *acc = buf->w + BOOT_TILE;
+  uint32_t *key = (uint32_t *)buf->w_precon;
+  uint32_t *exponent = key + BOOT_TILE;
+  NativeInt *mono = buf->w_precon + BOOT_TILE;
+
+  for (uint32_t k = me() * BOOT_TILE; k < N; k += NR_TASKLETS * BOOT_TILE) {
+    for (uint32_t j = 0; j < 4 * BOOT_TILE; ++j)
+      s[j] = 0;
+    for (uint32_t d = 0; d < digits; ++d) {
+      mram_read(
+          (__mram_ptr void const *)(l->dct + (d * N + k) * sizeof(NativeInt)),
+          digit, BOOT_TILE * sizeof(NativeInt));
+      for (uint32_t r = 0; r < 4; ++r) {
+        uint32_t secret = r >> 1, c = r & 1;
+        uint32_t row = ((i * 2 + secret) * digits + d) * 2 + c;
+        mram_read(
+            (__mram_ptr void const *)(keys + (row * N + k) * sizeof(uint32_t)),
+            key, BOOT_TILE * sizeof(uint32_t));
+        NativeInt *sum = s + r * BOOT_TILE;
+        for (uint32_t j = 0; j < BOOT_TILE; ++j)
+          sum[j] = ModAddFast(sum[j], ModMulFastB(digit[j], key[j], Q, mu), Q);
+      }
+    }
+
+    mram_read((__mram_ptr void const *)(l->exponents + k * sizeof(uint32_t)),
+              exponent, BOOT_TILE * sizeof(uint32_t));
+    for (uint32_t c = 0; c < 2; ++c) {
+      uint32_t addr = l->acc[c] + k * sizeof(NativeInt);
+      mram_read((__mram_ptr void const *)addr, acc,
+                BOOT_TILE * sizeof(NativeInt));
+      for (uint32_t j = 0; j < BOOT_TILE; ++j) {
+        uint32_t e = exponent[j];
+        uint32_t pos = (uint32_t)((uint64_t)a * e % M);
+        uint32_t nega = (uint32_t)((uint64_t)neg * e % M);
+        mram_read((__mram_ptr void const *)(l->powers + pos * sizeof(NativeInt)),
+                  &mono[0], sizeof(NativeInt));
+        mram_read((__mram_ptr void const *)(l->powers + nega * sizeof(NativeInt)),
+                  &mono[1], sizeof(NativeInt));
+        NativeInt t = ModAddFast(
+            ModMulFastB(s[c * BOOT_TILE + j], mono[0], Q, mu),
+            ModMulFastB(s[(2 + c) * BOOT_TILE + j], mono[1], Q, mu), Q);
+        acc[j] = ModAddFast(acc[j], t, Q);
+      }
+      mram_write(acc, (__mram_ptr void *)addr, BOOT_TILE * sizeof(NativeInt));
+    }
+  }
+  barrier_wait(&my_barrier);
+}
+
+// Copies the accumulator to its coefficient form
+static void boot_to_coef(const struct boot_layout *l,
+                         const struct boot_buffers *buf) {
+  uint32_t N = meta.args.boot.N;
+  for (uint32_t k = me() * BOOT_TILE; k < N; k += NR_TASKLETS * BOOT_TILE) {
+    for (uint32_t c = 0; c < 2; ++c) {
+      mram_read((__mram_ptr void const *)(l->acc[c] + k * sizeof(NativeInt)),
+                buf->data, BOOT_TILE * sizeof(NativeInt));
+      mram_write(buf->data,
+                 (__mram_ptr void *)(l->coef[c] + k * sizeof(NativeInt)),
+                 BOOT_TILE * sizeof(NativeInt));
+    }
+  }
+  barrier_wait(&my_barrier);
+  for (uint32_t c = 0; c < 2; ++c) {
+    struct ntt_view v = boot_view(l->coef[c]);
+    ntt_inverse_view(&v, buf->data, buf->w, buf->w_precon, buf->scale);
+  }
+}
+
+/*
+  LWE ciphertext of the accumulator under the transposed key, as EvalBinGate
+  extracts it: a is the first polynomial transposed, a(X^-1), and b the
+  constant term of the second one plus Q/8 + 1.
+*/
+static void boot_extract(const struct boot_layout *l,
+                         const struct boot_buffers *buf) {
+  uint32_t N = meta.args.boot.N;
+  NativeInt Q = meta.args.boot.mod;
+  NativeInt *a = buf->data;
+
+  for (uint32_t k = me() * BOOT_TILE; k < N; k += NR_TASKLETS * BOOT_TILE) {
+    for (uint32_t j = 0; j < BOOT_TILE; ++j) {
+      uint32_t src = k + j == 0 ? 0 : N - (k + j);
+      mram_read((__mram_ptr void const *)(l->coef[0] + src * sizeof(NativeInt)),
+                &a[j], sizeof(NativeInt));
+      if (k + j != 0 && a[j] != 0)
+        a[j] = Q - a[j];
+    }
+    mram_write(a, (__mram_ptr void *)(l->out + k * sizeof(NativeInt)),
+               BOOT_TILE * sizeof(NativeInt));
+  }
+  if (me() == 0) {
+    mram_read((__mram_ptr void const *)l->coef[1], a, sizeof(NativeInt));
+    a[0] = ModAddFast(a[0], (Q >> 3) + 1, Q);
+    a[1] = 0;
+    mram_write(a, (__mram_ptr void *)(l->out + N * sizeof(NativeInt)),
+               2 * sizeof(NativeInt));
+  }
+}
+
+int blind_rotate(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t N = meta.args.boot.N;
+  uint32_t jobs = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.boot.jobs);
+  struct pim_gate *job = (struct pim_gate *)mem_alloc(sizeof(struct pim_gate));
+  mram_read((__mram_ptr void const *)jobs, job, sizeof(struct pim_gate));
+  if (!job->valid)
+    return 0;
+
+  struct boot_buffers buf;
+  buf.data = (NativeInt *)mem_alloc(NTT_TILE * sizeof(NativeInt));
+  buf.w = (NativeInt *)mem_alloc(NTT_TILE / 2 * sizeof(NativeInt));
+  buf.w_precon = (NativeInt *)mem_alloc(NTT_TILE / 2 * sizeof(NativeInt));
+  buf.scale = (NativeInt *)mem_alloc(2 * sizeof(NativeInt));
+
+  struct boot_layout l;
+  uint32_t work = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.boot.work);
+  l.acc[0] = work;
+  l.acc[1] = l.acc[0] + N * sizeof(NativeInt);
+  l.coef[0] = l.acc[1] + N * sizeof(NativeInt);
+  l.coef[1] = l.coef[0] + N * sizeof(NativeInt);
+  l.dct = l.coef[1] + N * sizeof(NativeInt);
+  l.powers = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.boot.key);
+  l.exponents = l.powers + 2 * N * sizeof(NativeInt);
+  l.blocks = l.exponents + N * sizeof(uint32_t);
+  l.index = jobs + sizeof(struct pim_gate);
+  l.out = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.boot.out);
+
+  boot_init(&l, job, &buf);
+  for (uint32_t i = 0; i < meta.args.boot.n; ++i) {
+    // The indexes and offsets are 32-bit, the DMA reads them in pairs
+    uint32_t *pair = (uint32_t *)buf.scale;
+    mram_read((__mram_ptr void const *)(l.index + (i & ~1u) * sizeof(uint32_t)),
+              pair, 2 * sizeof(uint32_t));
+    uint32_t a = pair[i & 1];
+    uint32_t block = i / meta.args.boot.per_block;
+    mram_read(
+        (__mram_ptr void const *)(l.blocks + (block & ~1u) * sizeof(uint32_t)),
+        pair, 2 * sizeof(uint32_t));
+    uint32_t keys = (uint32_t)(DPU_MRAM_HEAP_POINTER + pair[block & 1]);
+
+    boot_to_coef(&l, &buf);
+    boot_decompose(&l, &buf);
+    for (uint32_t d = 0; d < meta.args.boot.digits; ++d) {
+      struct ntt_view v = boot_view(l.dct + d * N * sizeof(NativeInt));
+      ntt_forward_view(&v, buf.data, buf.w, buf.w_precon);
+    }
+    boot_accumulate(&l, i % meta.args.boot.per_block, a, keys, &buf);
+  }
+  boot_to_coef(&l, &buf);
+  boot_extract(&l, &buf);
+  return 0;
+}
+
+#endif // __PIM_BLIND_ROTATE__
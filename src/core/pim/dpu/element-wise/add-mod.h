@@ -0,0 +1,34 @@
+#ifndef __PIM_ADD_MOD__
+#define __PIM_ADD_MOD__
+
+/*
+  Element-wise modular addition kernels of the resident DPU program, selected by
+  meta.args.elem.kernel. The including program defines meta and my_barrier.
+*/
+
+int add_mod_scalar(void);
+int add_mod_scalar_eq(void);
+int add_mod_vector(void);
+int add_mod_vector_eq(void);
+
+int (*add_mod_kernels[])(void) = {add_mod_scalar, add_mod_scalar_eq,
+                                  add_mod_vector, add_mod_vector_eq};
+
+static void add_mod_scalar_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_addition_scalar_Eq(a, meta.args.elem.op2.start, elem_modulus(),
+                             words);
+}
+
+static void add_mod_vector_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_addition_vector_Eq(a, b, elem_modulus(), words);
+}
+
+int add_mod_scalar() { return stream_elem(add_mod_scalar_tile, 0, 0); }
+
+int add_mod_scalar_eq() { return stream_elem(add_mod_scalar_tile, 0, 1); }
+
+int add_mod_vector() { return stream_elem(add_mod_vector_tile, 1, 0); }
+
+int add_mod_vector_eq() { return stream_elem(add_mod_vector_tile, 1, 1); }
+
+#endif // __PIM_ADD_MOD__
@@ -0,0 +1,64 @@
+#ifndef __PIM_MAC__
+#define __PIM_MAC__
+
+/*
+  Fused multiply-accumulate of the resident DPU program (see struct pim_mac).
+  The including program defines meta and my_barrier.
+
+  A tasklet keeps the sum of a tile in WRAM and streams the tile of every
+  operand through a second buffer. The Shoup products are left in [0, 2 mod)
+  and the sum is kept below 2 mod, which holds for moduli of up to 62 bits;
+  the sum is reduced below mod only before it is written.
+*/
+
+int mac(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  NativeInt m = meta.args.mac.mod;
+  NativeInt m2 = m << 1;
+  uint32_t count = meta.args.mac.count;
+  uint32_t bytes = meta.args.mac.len * sizeof(NativeInt);
+  uint32_t heap = (uint32_t)DPU_MRAM_HEAP_POINTER;
+  uint32_t res = heap + meta.args.mac.res;
+
+  uint32_t tile = stream_tile_bytes(bytes, 2);
+  NativeInt *sum = (NativeInt *)mem_alloc(tile);
+  NativeInt *op = (NativeInt *)mem_alloc(tile);
+
+  for (uint32_t first = tasklet_id * tile; first < bytes;
+       first += tile * NR_TASKLETS) {
+    uint32_t chunk = bytes - first < tile ? bytes - first : tile;
+    uint32_t words = chunk >> 3;
+
+    if (meta.args.mac.accumulate)
+      mram_read((__mram_ptr void const *)(res + first), sum, chunk);
+    else
+      for (uint32_t k = 0; k < words; ++k)
+        sum[k] = 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+      NativeInt w = meta.args.mac.weights[i];
+      NativeInt precon = meta.args.mac.precons[i];
+      mram_read((__mram_ptr void const *)(heap + meta.args.mac.ops[i] + first),
+                op, chunk);
+      for (uint32_t k = 0; k < words; ++k) {
+        NativeInt prod = op[k] * w - MultDHi(op[k], precon) * m;
+        NativeInt acc = sum[k] + prod;
+        sum[k] = acc >= m2 ? acc - m2 : acc;
+      }
+    }
+
+    for (uint32_t k = 0; k < words; ++k)
+      if (sum[k] >= m)
+        sum[k] -= m;
+    STREAM_DUMP(first, sum, words);
+    mram_write(sum, (__mram_ptr void *)(res + first), chunk);
+  }
+  return 0;
+}
+
+#endif // __PIM_MAC__
@@ -0,0 +1,12 @@
+#ifndef __PIM_MEM_COPY__
+#define __PIM_MEM_COPY__
+
+/*
+  MRAM to MRAM copy of meta.args.elem.op1 into meta.args.elem.res, used to
+  duplicate a resident buffer without a round trip through the host. The
+  including program defines meta and my_barrier.
+*/
+
+int mem_copy(void) { return stream_elem(NULL, 0, 0); }
+
+#endif // __PIM_MEM_COPY__
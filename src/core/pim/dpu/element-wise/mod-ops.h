@@ -0,0 +1,92 @@
+#ifndef __PIM_MOD_OPS__
+#define __PIM_MOD_OPS__
+
+/*
+  Modulus kernels of the resident DPU program, selected by meta.args.mod.kernel.
+  The including program defines meta and my_barrier.
+*/
+
+int SwitchModulus(void);
+int MOD(void);
+int MODEq(void);
+int MODByTwo(void);
+int MODByTwoEq(void);
+int MODexp(void);
+int MODexpEq(void);
+int MODInverse(void);
+int MODInverseEq(void);
+int MULTIPLYAndRound(void);
+int MULTIPLYAndRoundEq(void);
+int DIVIDEAndRound(void);
+int DIVIDEAndRoundEq(void);
+
+int (*mod_ops_kernels[])(void) = {SwitchModulus,
+                                  MOD,
+                                  MODEq,
+                                  MODByTwo,
+                                  MODByTwoEq,
+                                  MODexp,
+                                  MODexpEq,
+                                  MODInverse,
+                                  MODInverseEq,
+                                  MULTIPLYAndRound,
+                                  MULTIPLYAndRoundEq,
+                                  DIVIDEAndRound,
+                                  DIVIDEAndRoundEq};
+
+static void switch_modulus_tile(NativeInt *a, NativeInt *b, size_t words) {
+  switch_modulus(a, mod_ops_modulus(), meta.args.mod.p, words);
+}
+
+static void mod_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modulus_Eq(a, mod_ops_modulus(), meta.args.mod.p, words);
+}
+
+static void mod_by_two_tile(NativeInt *a, NativeInt *b, size_t words) {
+  ModByTwoEq(a, mod_ops_modulus(), words);
+}
+
+static void mod_exp_tile(NativeInt *a, NativeInt *b, size_t words) {
+  Modular_Exp_Eq(a, meta.args.mod.p, mod_ops_modulus(), mod_ops_mu(), words);
+}
+
+static void mod_inverse_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_inverse_eq(a, mod_ops_modulus(), words);
+}
+
+static void multiply_and_round_tile(NativeInt *a, NativeInt *b, size_t words) {
+  MultiplyAndRoundEq_vector(a, mod_ops_modulus(), mod_ops_mu(), words,
+                            meta.args.mod.p, meta.args.mod.q);
+}
+
+static void divide_and_round_tile(NativeInt *a, NativeInt *b, size_t words) {
+  DivideAndRoundEq_vector(a, words, mod_ops_modulus(), meta.args.mod.p);
+}
+
+int SwitchModulus() { return stream_mod(switch_modulus_tile, 1); }
+
+int MOD() { return stream_mod(mod_tile, 0); }
+
+int MODEq() { return stream_mod(mod_tile, 1); }
+
+int MODByTwo() { return stream_mod(mod_by_two_tile, 0); }
+
+int MODByTwoEq() { return stream_mod(mod_by_two_tile, 1); }
+
+int MODexp() { return stream_mod(mod_exp_tile, 0); }
+
+int MODexpEq() { return stream_mod(mod_exp_tile, 1); }
+
+int MODInverse() { return stream_mod(mod_inverse_tile, 0); }
+
+int MODInverseEq() { return stream_mod(mod_inverse_tile, 1); }
+
+int MULTIPLYAndRound() { return stream_mod(multiply_and_round_tile, 0); }
+
+int MULTIPLYAndRoundEq() { return stream_mod(multiply_and_round_tile, 1); }
+
+int DIVIDEAndRound() { return stream_mod(divide_and_round_tile, 0); }
+
+int DIVIDEAndRoundEq() { return stream_mod(divide_and_round_tile, 1); }
+
+#endif // __PIM_MOD_OPS__
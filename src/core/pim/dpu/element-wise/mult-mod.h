@@ -0,0 +1,35 @@
+#ifndef __PIM_MULT_MOD__
+#define __PIM_MULT_MOD__
+
+/*
+  Element-wise modular multiplication kernels of the resident DPU program, selected by
+  meta.args.elem.kernel. The including program defines meta and my_barrier.
+*/
+
+int mult_mod_scalar(void);
+int mult_mod_scalar_eq(void);
+int mult_mod_vector(void);
+int mult_mod_vector_eq(void);
+
+int (*mult_mod_kernels[])(void) = {mult_mod_scalar, mult_mod_scalar_eq,
+                                  mult_mod_vector, mult_mod_vector_eq};
+
+static void mult_mod_scalar_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_multiplication_scalar_Eq(a, meta.args.elem.op2.start,
+                                   meta.args.elem.precon, elem_modulus(),
+                                   elem_mu(), words);
+}
+
+static void mult_mod_vector_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_multiplication_vector_Eq(a, b, elem_modulus(), elem_mu(), words);
+}
+
+int mult_mod_scalar() { return stream_elem(mult_mod_scalar_tile, 0, 0); }
+
+int mult_mod_scalar_eq() { return stream_elem(mult_mod_scalar_tile, 0, 1); }
+
+int mult_mod_vector() { return stream_elem(mult_mod_vector_tile, 1, 0); }
+
+int mult_mod_vector_eq() { return stream_elem(mult_mod_vector_tile, 1, 1); }
+
+#endif // __PIM_MULT_MOD__
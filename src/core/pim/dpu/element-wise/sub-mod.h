@@ -0,0 +1,34 @@
+#ifndef __PIM_SUB_MOD__
+#define __PIM_SUB_MOD__
+
+/*
+  Element-wise modular subtraction kernels of the resident DPU program, selected by
+  meta.args.elem.kernel. The including program defines meta and my_barrier.
+*/
+
+int sub_mod_scalar(void);
+int sub_mod_scalar_eq(void);
+int sub_mod_vector(void);
+int sub_mod_vector_eq(void);
+
+int (*sub_mod_kernels[])(void) = {sub_mod_scalar, sub_mod_scalar_eq,
+                                  sub_mod_vector, sub_mod_vector_eq};
+
+static void sub_mod_scalar_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_subtratcion_scalar_Eq(a, meta.args.elem.op2.start, elem_modulus(),
+                                words);
+}
+
+static void sub_mod_vector_tile(NativeInt *a, NativeInt *b, size_t words) {
+  modular_subtraction_vector_Eq(a, b, elem_modulus(), words);
+}
+
+int sub_mod_scalar() { return stream_elem(sub_mod_scalar_tile, 0, 0); }
+
+int sub_mod_scalar_eq() { return stream_elem(sub_mod_scalar_tile, 0, 1); }
+
+int sub_mod_vector() { return stream_elem(sub_mod_vector_tile, 1, 0); }
+
+int sub_mod_vector_eq() { return stream_elem(sub_mod_vector_tile, 1, 1); }
+
+#endif // __PIM_SUB_MOD__
@@ -24,7 +24,8 @@ struct mod_add_sub_mult {
   struct operands op2;
   struct operands res;
   uint64_t mod;
-  uint64_t mu;
+  uint64_t mu;     // Barrett constant of mod, 0 to compute it on the DPU
+  uint64_t precon; // Shoup precomputation of a scalar op2, 0 for none
   enum add_sub_mul_kernel kernel;
 };
 
@@ -53,6 +54,230 @@ struct mod_ops {
   enum mod_kernel kernel;
 };
 
-// Arguments for the
+// Modulus value in a header telling the kernels to use the modulus of the
+// RNS tower held by each DPU (see struct pim_tower) instead of a shared one
+#define PIM_TOWER_MODULUS 0
+
+// Per-DPU description of the slice of a spread mirror a DPU holds, or of the
+// pinned mirrors placed whole on it (see PimData), pushed to the "tower"
+// symbol
+struct pim_tower {
+  uint64_t mod;
+  uint64_t mu;
+  uint32_t slice; // slice of the tower held by this DPU
+  uint32_t valid; // 0 for DPUs left out of the launch
+  uint32_t twiddles; // MRAM offset of the NTT tables of mod (see pim_ntt)
+  uint32_t pad;
+};
+
+// Kernels of the resident DPU program, dispatched by main on meta.opcode
+enum pim_opcode {
+  OP_ELEM_MOD_ADD = 0,
+  OP_ELEM_MOD_SUB = 1,
+  OP_ELEM_MOD_MULT = 2,
+  OP_ELEM_MOD_OPS = 3,
+  OP_MEM_COPY = 4,
+  OP_NTT_FORWARD = 5,
+  OP_NTT_INVERSE = 6,
+  OP_BASE_CONV = 7,
+  OP_AUTOMORPHISM = 8,
+  OP_BLIND_ROTATE = 9,
+  OP_MAC = 10,
+  OP_RESCALE = 11,
+  OP_UNIFORM = 12,
+  PIM_OPCODES // number of kernels, new opcodes go before it
+};
+
+/*
+  Per-DPU telemetry of the resident program, accumulated in the "stats"
+  symbol by tasklet 0 at the end of every launch until the host clears it.
+  The cycles are counted by perfcounter from the start of main to the last
+  tasklet leaving the kernel.
+*/
+struct pim_stats {
+  uint64_t cycles[PIM_OPCODES];
+  uint64_t launches[PIM_OPCODES];
+};
+
+/*
+  Arguments of the negacyclic NTT kernels. A tower of n coefficients is split
+  in groups slices of n / groups words, the DPU holding slice tower.slice runs
+  the butterfly stages that stay within its slice; the stages crossing slices
+  are left to the host. With groups = 1 the tower sits whole on one DPU, which
+  runs every stage. The tables of the tower modulus sit at tower.twiddles:
+    [n] roots of unity in bit reversed order, [n] their Shoup precomputations,
+    [n] inverse roots, [n] their precomputations, n^-1 and its precomputation
+*/
+struct pim_ntt {
+  struct operands data;
+  uint32_t n;
+  uint32_t groups;
+};
+
+/*
+  Arguments of the fast base conversion of ApproxSwitchCRTBasis, from size_q
+  towers over q_i to size_p towers over p_j:
+    y_j = sum_i [x_i (Q/q_i)^-1]_{q_i} [Q/q_i]_{p_j} mod p_j
+  Every DPU holds the slice of len coefficients of each tower at the same MRAM
+  offsets, listed at towers: [size_q] input offsets then [size_p] output
+  ones. Whole towers (len = n) all sit on the one DPU running the kernel.
+  The tables at tables are
+    for each q_i: q_i, [(Q/q_i)^-1]_{q_i} and its Shoup precomputation
+    for each p_j: p_j, the low and high words of floor(2^128 / p_j), then
+                  [Q/q_i]_{p_j} for every q_i
+*/
+struct pim_base_conv {
+  uint32_t towers;
+  uint32_t tables;
+  uint32_t size_q;
+  uint32_t size_p;
+  uint32_t len;
+  uint32_t pad;
+};
+
+/*
+  Arguments of the automorphism of the evaluation form of a tower split in
+  slices of len words. Every word of a slice of the result comes from the same
+  slice of the input, the DPU holding that one computes it: word j of the
+  result is word map[j] of the input slice at in, with the len 32-bit indexes
+  of map uploaded to each DPU for its own slice. The result lands at out on
+  the DPU computing it, the host moves the slices to their DPUs afterwards.
+*/
+struct pim_automorphism {
+  uint32_t in;
+  uint32_t out;
+  uint32_t map;
+  uint32_t len;
+};
+
+/*
+  Arguments of the CGGI blind rotation of a gate bootstrapping, a whole
+  bootstrap per DPU (RingGSWAccumulatorCGGI::EvalAcc). The image of the
+  bootstrapping key is broadcast to every DPU once, at key:
+    [2N] the monomials X^e - 1 at the first slot of the evaluation form
+    (64-bit words), [N] the exponent e_j such that X at the slot j is X^e_j
+    at the first slot, then the MRAM offsets of the blocks of the key (32-bit,
+    padded to an even count)
+  Block b holds the LWE coefficients b per_block .. (b + 1) per_block - 1:
+  for each of them, for the secrets 1 and -1, digits RGSW rows of 2
+  polynomials of N 32-bit words in the evaluation form.
+  The DPU finds its ciphertext at jobs, a struct pim_gate followed by the n
+  32-bit monomial indexes of its a (-a_i mod q) 2N / q, and writes at out the
+  extracted LWE ciphertext under the transposed key, N words of a then b.
+  work is scratch for (4 + digits) N words.
+*/
+struct pim_blind_rotate {
+  uint64_t mod;  // Q
+  uint64_t mu;   // Barrett constant of Q
+  uint32_t n;    // LWE dimension
+  uint32_t N;    // ring dimension
+  uint32_t digits; // 2 (d_g - 1), the first digit is dropped
+  uint32_t g_bits; // log2 of the gadget base
+  uint32_t key;
+  uint32_t per_block;
+  uint32_t ntt; // MRAM offset of the NTT tables of Q (see pim_ntt)
+  uint32_t jobs;
+  uint32_t out;
+  uint32_t work;
+};
+
+// Ciphertext of a gate bootstrapping, after the additive gate operation
+struct pim_gate {
+  uint64_t b;
+  uint64_t q;   // modulus of the ciphertext
+  uint64_t q1;  // [q1, q2) is mapped to -Q/8, the rest to Q/8
+  uint64_t q2;
+  uint64_t q2p; // Q / 2p + 1
+  uint32_t valid; // 0 for DPUs left out of the launch
+  uint32_t pad;
+};
+
+// Terms of a single multiply-accumulate launch, longer sums chain launches
+#define PIM_MAC_TERMS 8
+
+/*
+  Arguments of the fused multiply-accumulate of count vectors with scalar
+  weights, the tower-wise weighted sums of EvalLinearWSum:
+    res = [accumulate ? res : 0] + sum_i weights[i] op[i] mod mod
+  Every DPU holds the slice of len words of each operand at the same MRAM
+  offset ops[i], or all of them whole (len = n) on the one DPU running the
+  kernel. The weights come with their Shoup precomputations, the
+  products are accumulated in WRAM below 2 mod and reduced once at the end.
+*/
+struct pim_mac {
+  uint64_t mod;
+  uint32_t res;
+  uint32_t len;
+  uint32_t count;
+  uint32_t accumulate;
+  uint32_t ops[PIM_MAC_TERMS];
+  uint64_t weights[PIM_MAC_TERMS];
+  uint64_t precons[PIM_MAC_TERMS];
+};
+
+enum pim_rescale_mode {
+  RESCALE_FUSED,  // x = x q_inv + [last]_q scale
+  RESCALE_SWITCH, // y = [last]_q scale
+  RESCALE_ADD     // x = x q_inv + y
+};
+
+/*
+  Arguments of the rescale of the towers of a polynomial by its last tower,
+  the device side of DCRTPolyImpl::DropLastElementAndScale and ModReduce. The
+  last tower, over last_mod and in the coefficient form, is brought to the
+  modulus q of every other tower as the host SwitchModulus does (centered
+  lift), then scaled. Every DPU holds the slice of len words of each tower at
+  the same MRAM offsets, so the last tower reaches the other moduli without
+  leaving the DPU. Whole towers (len = n) all sit on the one DPU running the
+  kernel. For each of the count towers, rows holds 8 words:
+    q, q - (last_mod mod q), scale and its Shoup precomputation,
+    q_inv and its Shoup precomputation, the offsets of x and of y
+  The evaluation form needs the NTT of [last]_q scale in between, it is
+  rescaled in a RESCALE_SWITCH and a RESCALE_ADD launch.
+*/
+struct pim_rescale {
+  uint64_t last_mod;
+  uint32_t last;
+  uint32_t rows;
+  uint32_t count;
+  uint32_t len;
+  uint32_t mode;
+  uint32_t pad;
+};
+
+/*
+  Arguments of the expansion of key into count uniform towers of n
+  coefficients, with the ChaCha20 stream of PimUniform.h. The DPU holding
+  slice tower.slice fills coefficients tower.slice len .. (tower.slice + 1)
+  len - 1 of every tower, the ones past n with zeros; a DPU holding whole
+  towers has slice 0 and len = n. For each tower, rows holds 4 words:
+    q, the mask of its bit length, its stream, the offset of the result
+*/
+struct pim_uniform {
+  uint32_t key[8];
+  uint32_t rows;
+  uint32_t count;
+  uint32_t len;
+  uint32_t n;
+};
+
+// Arguments broadcast to the "meta" symbol before every launch
+struct pim_meta {
+  enum pim_opcode opcode;
+  // Set by PimManager::launch_async for the launches given tower
+  // descriptions: the DPUs without a valid one skip the kernel
+  uint32_t described;
+  union {
+    struct mod_add_sub_mult elem;
+    struct mod_ops mod;
+    struct pim_ntt ntt;
+    struct pim_base_conv conv;
+    struct pim_automorphism autom;
+    struct pim_blind_rotate boot;
+    struct pim_mac mac;
+    struct pim_rescale rescale;
+    struct pim_uniform uniform;
+  } args;
+};
 
 #endif //__PIM_COMMON__
\ No newline at end of file
@@ -10,33 +10,22 @@
 #define CACHE_SIZE (1 << 8)
 #define SIZE (CACHE_SIZE >> 3)
 
-static void ModByTwo(NativeInt *m_data, NativeInt *res, NativeInt m_modulus,
-                     size_t size) {
-  NativeInt halfQ = m_modulus >> 1;
-  for (size_t i = 0; i < size; ++i)
-    res[i] = 0x1 & (m_data[i] ^ (m_data[i] > halfQ));
-}
-
 static void ModByTwoEq(NativeInt *m_data, NativeInt m_modulus, size_t size) {
   NativeInt halfQ = m_modulus >> 1;
   for (size_t i = 0; i < size; ++i)
     m_data[i] = 0x1 & (m_data[i] ^ (m_data[i] > halfQ));
 }
 
+// The host reduces the exponent bv (see PimData::ModExp)
 static void Modulus_Exp(NativeInt *m_data, NativeInt *res, NativeInt bv,
-                        NativeInt mv, size_t size) {
-  if (bv >= mv)
-    ModEq(&bv, mv);
+                        NativeInt mv, NativeInt mu, size_t size) {
   for (size_t i = 0; i < size; ++i)
-    res[i] = ModExp(m_data[i], bv, mv);
+    res[i] = ModExp(m_data[i], bv, mv, mu);
 }
 
 static void Modular_Exp_Eq(NativeInt *m_data, NativeInt bv, NativeInt mv,
-                           size_t size) {
-  if (bv >= mv)
-    ModEq(&bv, mv);
-  for (size_t i = 0; i < size; ++i)
-    m_data[i] = ModExp(m_data[i], bv, mv);
+                           NativeInt mu, size_t size) {
+  Modulus_Exp(m_data, m_data, bv, mv, mu, size);
 }
 
 static void switch_modulus(NativeInt *m_data, NativeInt m_modulus,
@@ -63,32 +52,6 @@ static void switch_modulus(NativeInt *m_data, NativeInt m_modulus,
   }
 }
 
-static void modulus(NativeInt *m_data, NativeInt *res, NativeInt m_modulus,
-                    NativeInt modulus, size_t size) {
-  if (modulus == 2)
-    return ModByTwoEq(m_data, m_modulus, size);
-  NativeInt nm = modulus;
-  NativeInt halfQ = m_modulus >> 1;
-  NativeInt om = m_modulus;
-  if (nm > om) {
-    NativeInt diff = nm - om;
-    for (size_t i = 0; i < size; ++i) {
-      NativeInt *v = &m_data[i];
-      if (*v > halfQ)
-        res[i] = *v + diff;
-    }
-  } else {
-    NativeInt diff = nm - (om % nm);
-    for (size_t i = 0; i < size; ++i) {
-      NativeInt *v = &m_data[i];
-      if (*v > halfQ)
-        res[i] = *v + diff;
-      if (*v >= nm)
-        res[i] = *v % nm;
-    }
-  }
-}
-
 static void modulus_Eq(NativeInt *m_data, NativeInt m_modulus,
                        NativeInt modulus, size_t size) {
   if (modulus == 2)
@@ -115,32 +78,15 @@ static void modulus_Eq(NativeInt *m_data, NativeInt m_modulus,
   }
 }
 
-// addition operations
-static void modular_addition_scalar(NativeInt *m_value, NativeInt b_m_value,
-                                    NativeInt *res, NativeInt modulus,
-                                    size_t size) {
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
-  for (size_t i = 0; i < size; i++)
-    *(res + i) = ModAddFast(*(m_value + i), b_m_value, modulus);
-}
-
+// addition operations, the host reduces the scalars below the modulus (see
+// PimData::common_do_ops)
 static void modular_addition_scalar_Eq(NativeInt *m_value, NativeInt b_m_value,
                                        NativeInt modulus, size_t size) {
   // printf("%ld\n", b_m_value);
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
   for (size_t i = 0; i < size; i++)
     ModAddFastEq(m_value + i, b_m_value, modulus);
 }
 
-static void modular_addition_vector(NativeInt *m_value, NativeInt *b_m_value,
-                                    NativeInt *res, NativeInt modulus_m_values,
-                                    size_t size) {
-  for (size_t i = 0; i < size; i++)
-    *(res + i) = ModAddFast(*(m_value + i), *(b_m_value + i), modulus_m_values);
-}
-
 static void modular_addition_vector_Eq(NativeInt *m_value, NativeInt *b_m_value,
                                        NativeInt modulus, size_t size) {
   for (size_t i = 0; i < size; i++)
@@ -148,32 +94,13 @@ static void modular_addition_vector_Eq(NativeInt *m_value, NativeInt *b_m_value,
 }
 
 // subtraction operations
-static void modular_subtraction_scalar(NativeInt *m_value, NativeInt b_m_value,
-                                       NativeInt *res, NativeInt modulus,
-                                       size_t size) {
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
-  for (size_t i = 0; i < size; i++)
-    *(res + i) = ModSubFast(*(m_value + i), b_m_value, modulus);
-}
-
 static void modular_subtratcion_scalar_Eq(NativeInt *m_value,
                                           NativeInt b_m_value,
                                           NativeInt modulus, size_t size) {
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
   for (size_t i = 0; i < size; i++)
     ModSubFastEq(m_value + i, b_m_value, modulus);
 }
 
-static void modular_subtraction_vector(NativeInt *m_value, NativeInt *b_m_value,
-                                       NativeInt *res,
-                                       NativeInt modulus_m_values,
-                                       size_t size) {
-  for (size_t i = 0; i < size; i++)
-    *(res + i) = ModSubFast(*(m_value + i), *(b_m_value + i), modulus_m_values);
-}
-
 static void modular_subtraction_vector_Eq(NativeInt *m_value,
                                           NativeInt *b_m_value,
                                           NativeInt modulus, size_t size) {
@@ -181,39 +108,36 @@ static void modular_subtraction_vector_Eq(NativeInt *m_value,
     ModSubFastEq(m_value + i, *(b_m_value + i), modulus);
 }
 
-// Multiplication operations
+// Multiplication operations. The host ships the Shoup precomputation of the
+// scalar and the Barrett constant of the modulus (see mod_add_sub_mult), a
+// scalar without precomputation falls back to Barrett.
 static void modular_multiplication_scalar(NativeInt *m_value,
-                                          NativeInt b_m_value, NativeInt *res,
-                                          NativeInt modulus, size_t size) {
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
-  NativeInt mu = ComputeMu(modulus);
+                                          NativeInt b_m_value,
+                                          NativeInt b_precon, NativeInt *res,
+                                          NativeInt modulus, NativeInt mu,
+                                          size_t size) {
+  if (b_precon != 0) {
+    for (size_t i = 0; i < size; i++)
+      *(res + i) = ModMulFastConst(*(m_value + i), b_m_value, modulus, b_precon);
+    return;
+  }
   for (size_t i = 0; i < size; i++)
     *(res + i) = ModMulFastB(*(m_value + i), b_m_value, modulus, mu);
 }
 
 static void modular_multiplication_scalar_Eq(NativeInt *m_value,
                                              NativeInt b_m_value,
-                                             NativeInt modulus, size_t size) {
-  if (b_m_value >= modulus)
-    ModEq(&b_m_value, modulus);
-  NativeInt mu = ComputeMu(modulus);
-  for (size_t i = 0; i < size; i++)
-    ModMulFastEqB(m_value + i, b_m_value, modulus, mu);
-}
-
-static void modular_multiplication_vector(NativeInt *m_value,
-                                          NativeInt *b_m_value, NativeInt *res,
-                                          NativeInt modulus, size_t size) {
-  NativeInt mu = ComputeMu(modulus);
-  for (size_t i = 0; i < size; i++)
-    *(res + i) = ModMulFastB(*(m_value + i), *(b_m_value + i), modulus, mu);
+                                             NativeInt b_precon,
+                                             NativeInt modulus, NativeInt mu,
+                                             size_t size) {
+  modular_multiplication_scalar(m_value, b_m_value, b_precon, m_value, modulus,
+                                mu, size);
 }
 
 static void modular_multiplication_vector_Eq(NativeInt *m_value,
                                              NativeInt *b_m_value,
-                                             NativeInt modulus, size_t size) {
-  NativeInt mu = ComputeMu(modulus);
+                                             NativeInt modulus, NativeInt mu,
+                                             size_t size) {
   for (size_t i = 0; i < size; i++)
     ModMulFastEqB(m_value + i, *(b_m_value + i), modulus, mu);
 }
@@ -225,22 +149,23 @@ void MultWithOutMod(NativeInt *m_data, NativeInt *b, NativeInt *res,
 }
 
 void MultiplyAndRound_vector(NativeInt *m_data, NativeInt *res,
-                             NativeInt m_modulus, size_t size, NativeInt p,
-                             NativeInt q) {
+                             NativeInt m_modulus, NativeInt mu, size_t size,
+                             NativeInt p, NativeInt q) {
   NativeInt halfQ = m_modulus >> 1;
   for (size_t i = 0; i < size; ++i) {
     if (m_data[i] > halfQ) {
       NativeInt tmp = m_modulus - m_data[i];
       res[i] = m_modulus - MultiplyAndRound(tmp, p, q);
     } else {
-      res[i] = Mod(MultiplyAndRound(m_data[i], p, q), m_modulus);
+      res[i] = ModB(MultiplyAndRound(m_data[i], p, q), m_modulus, mu);
     }
   }
 }
 
 void MultiplyAndRoundEq_vector(NativeInt *m_data, NativeInt m_modulus,
-                               size_t size, NativeInt p, NativeInt q) {
-  MultiplyAndRound_vector(m_data, m_data, m_modulus, size, p, q);
+                               NativeInt mu, size_t size, NativeInt p,
+                               NativeInt q) {
+  MultiplyAndRound_vector(m_data, m_data, m_modulus, mu, size, p, q);
 }
 
 void DivideAndRound_vector(NativeInt *m_data, NativeInt *res, size_t size,
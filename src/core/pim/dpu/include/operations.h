@@ -31,8 +31,14 @@ static unsigned int GetMSB(NativeInt n) {
 #endif
 }
 
+// Low word of x >> shift. Barrett shifts by up to msb + 5 bits, beyond the
+// low word for the 60-bit moduli
 static NativeInt RShiftD(const struct typeD *x, int64_t shift) {
   const int MaxBits = 64; // Assuming 64 bits for NativeInt
+  if (shift >= MaxBits)
+    return x->hi >> (shift - MaxBits);
+  if (shift == 0)
+    return x->lo;
   return (x->lo >> shift) | (x->hi << (MaxBits - shift));
 }
 
@@ -42,13 +48,16 @@ static void MultD(NativeInt a, NativeInt b, struct typeD *result) {
   NativeInt bHigh = b >> 32;
   NativeInt bLow = b & 0xFFFFFFFF;
 
-  NativeInt p1 = aHigh * bHigh;
-  NativeInt p2 = aLow * bLow;
-  NativeInt p3 = (aHigh + aLow) * (bHigh + bLow) - p1 - p2;
+  // Schoolbook product of the 32-bit halves, every partial product fits in
+  // 64 bits (the sums of halves of the Karatsuba variant do not)
+  NativeInt ll = aLow * bLow;
+  NativeInt lh = aLow * bHigh;
+  NativeInt hl = aHigh * bLow;
+  NativeInt hh = aHigh * bHigh;
+  NativeInt mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
 
-  // Combine the partial results to get the final high and low parts.
-  result->lo = p2 + ((p3 & 0xFFFFFFFF) << 32);
-  result->hi = p1 + (p3 >> 32) + ((p2 + ((p3 & 0xFFFFFFFF) << 32)) < p2);
+  result->lo = (mid << 32) | (ll & 0xFFFFFFFF);
+  result->hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
 }
 
 static void SubtractD(struct typeD *res, struct typeD a) {
@@ -61,30 +70,35 @@ static void SubtractD(struct typeD *res, struct typeD a) {
   res->hi -= a.hi;
 }
 
+static void AddD(struct typeD *res, struct typeD a) {
+  res->lo += a.lo;
+  res->hi += a.hi + (res->lo < a.lo);
+}
+
+/*
+  Barrett constant floor(2^(2 msb + 3) / m_value), as NativeIntegerT::ComputeMu
+  for moduli of up to 60 bits. The DPU has no divider, the quotient is built
+  one bit at a time; the host normally ships mu in the kernel arguments and
+  this is only the fallback.
+*/
 NativeInt ComputeMu(NativeInt m_value) {
   if (m_value == 0) {
     return 0;
   }
-  int64_t msb = GetMSB(m_value);
-
-  /*I changed the original code to accomodate the shifts operations for
-   * divisions and multiplication*/
-  NativeInt tmp = 1 << (msb << 1 | 3);
-
-  if ((m_value & (m_value - 1)) == 0) {
-    return tmp >> msb; // Equivalent to tmp / m_value
-  } else {
-    return tmp / m_value; // Use regular division
+  unsigned int msb = GetMSB(m_value);
+
+  // Restoring division of 2^(2 msb + 3), the remainder stays below m_value
+  NativeInt rem = 1;
+  NativeInt quot = 0;
+  for (unsigned int i = 0; i < 2 * msb + 3; ++i) {
+    rem <<= 1;
+    quot <<= 1;
+    if (rem >= m_value) {
+      rem -= m_value;
+      quot |= 1;
+    }
   }
-}
-
-// functions associated with modulus operations
-static NativeInt Mod(NativeInt m_value, const NativeInt modulus) {
-  return m_value % modulus;
-}
-
-static void ModEq(NativeInt *m_value, const NativeInt modulus) {
-  *m_value = *m_value % modulus;
+  return quot;
 }
 
 static void ModMu(struct typeD prod, NativeInt *a, const NativeInt mv,
@@ -112,34 +126,6 @@ static void ModEqB(NativeInt *m_value, const NativeInt modulus,
   ModMu(tmp, m_value, modulus, mu, GetMSB(modulus) - 2);
 }
 
-// functions associated with modulus additions
-NativeInt ModAdd(NativeInt av, NativeInt bv, const NativeInt mv) {
-  if (av >= mv)
-    av %= mv;
-  if (bv >= mv)
-    bv %= mv;
-  av += bv;
-  if (av >= mv)
-    av -= mv;
-  return av;
-}
-
-// In-place variant
-void ModAddEq(NativeInt *a, const NativeInt *b, const NativeInt mv) {
-  NativeInt bv = *b;
-
-  if (*a >= mv)
-    *a = *a % mv;
-
-  if (bv >= mv)
-    bv = bv % mv;
-
-  *a += bv;
-
-  if (*a >= mv)
-    *a -= mv;
-}
-
 // When the operands are less than modulus go faster
 // Normal:
 NativeInt ModAddFast(NativeInt av, NativeInt bv, const NativeInt mv) {
@@ -186,33 +172,10 @@ void ModAddEqB(NativeInt *av, NativeInt *bv, const NativeInt mv,
     *av -= mv;
 }
 
-// Modulus substractions operations
-// Normal
-NativeInt ModSub(NativeInt av, NativeInt bv, const NativeInt mv) {
-  if (av >= mv)
-    av %= mv;
-  if (bv >= mv)
-    bv %= mv;
-  if (av < bv)
-    return av + mv - bv;
-  return av - bv;
-}
-
-// In-place variants
-void ModSubEq(NativeInt *av, NativeInt *bv, const NativeInt mv) {
-  if (*av >= mv)
-    *av = *av % mv;
-  if (*bv >= mv)
-    *bv = *bv % mv;
-  if (*av < *bv)
-    *av = *av + mv - *bv;
-  *av = *av - *bv;
-}
-
 // Faster modular multiplications for operands < Modulus
 // Normal:
 NativeInt ModSubFast(NativeInt av, const NativeInt bv, const NativeInt mv) {
-  if (mv < bv)
+  if (av < bv)
     return av + mv - bv;
   return av - bv;
 }
@@ -221,7 +184,8 @@ NativeInt ModSubFast(NativeInt av, const NativeInt bv, const NativeInt mv) {
 void ModSubFastEq(NativeInt *av, NativeInt bv, const NativeInt mv) {
   if (*av < bv)
     *av = *av + mv - bv;
-  *av = *av - bv;
+  else
+    *av = *av - bv;
 }
 
 // barret subtractions
@@ -243,50 +207,15 @@ void ModSubEqB(NativeInt *av, NativeInt *bv, const NativeInt mv,
     ModEqB(av, mv, mu);
   if (*bv >= mv)
     ModEqB(bv, mv, mu);
-  if (av < bv)
+  if (*av < *bv)
     *av = *av + mv - *bv;
-  *av = *av - *bv;
+  else
+    *av = *av - *bv;
 }
 
 /* Functions associated with the polynomial modular element-wise multiplications
  */
 
-NativeInt ModMul(NativeInt av, NativeInt bv, const NativeInt mv) {
-  struct typeD tmp;
-  NativeInt mu = ComputeMu(mv);
-  int64_t n = GetMSB(mv) - 2;
-  if (av >= mv)
-    ModMu(tmp, &av, mv, mu, n);
-  if (bv >= mv)
-    ModMu(tmp, &bv, mv, mu, n);
-  MultD(av, bv, &tmp);
-  struct typeD r = tmp;
-  MultD(RShiftD(&tmp, n), mu, &tmp);
-  MultD(RShiftD(&tmp, n + 7), mv, &tmp);
-  SubtractD(&r, tmp);
-  if (r.lo >= mv)
-    r.lo -= mv;
-  return r.lo;
-}
-
-void ModMulEq(NativeInt *av, NativeInt bv, const NativeInt mv) {
-  struct typeD tmp;
-  NativeInt mu = ComputeMu(mv);
-  int64_t n = GetMSB(mv) - 2;
-  if (*av >= mv)
-    ModMu(tmp, av, mv, mu, n);
-  if (bv >= mv)
-    ModMu(tmp, &bv, mv, mu, n);
-  MultD(*av, bv, &tmp);
-  struct typeD r = tmp;
-  MultD(RShiftD(&tmp, n), mu, &tmp);
-  MultD(RShiftD(&tmp, n + 7), mv, &tmp);
-  SubtractD(&r, tmp);
-  *av = r.lo;
-  if (r.lo >= mv)
-    av -= mv;
-}
-
 // Barret reduction
 NativeInt ModMulB(NativeInt av, NativeInt bv, const NativeInt mv,
                   const NativeInt mu) {
@@ -324,33 +253,6 @@ void ModMulEqB(NativeInt *av, NativeInt bv, const NativeInt mv,
     *av -= mv;
 }
 
-// operands are < modulus hence go faster
-NativeInt ModMulFast(NativeInt av, NativeInt bv, const NativeInt mv) {
-  int64_t n = GetMSB(mv) - 2;
-  struct typeD prod;
-  MultD(av, bv, &prod);
-  struct typeD r = prod;
-  MultD(RShiftD(&prod, n), ComputeMu(mv), &prod);
-  MultD(RShiftD(&prod, n + 7), mv, &prod);
-  SubtractD(&r, prod);
-  if (r.lo >= mv)
-    r.lo -= mv;
-  return r.lo;
-}
-
-void ModMulFastEq(NativeInt *av, NativeInt bv, NativeInt mv) {
-  int64_t n = GetMSB(mv) - 2;
-  struct typeD prod;
-  MultD(*av, bv, &prod);
-  struct typeD r = prod;
-  MultD(RShiftD(&prod, n), ComputeMu(mv), &prod);
-  MultD(RShiftD(&prod, n + 7), mv, &prod);
-  SubtractD(&r, prod);
-  *av = r.lo;
-  if (r.lo >= mv)
-    *av -= mv;
-}
-
 // Barret variant
 NativeInt ModMulFastB(NativeInt av, NativeInt bv, const NativeInt mv,
                       const NativeInt mu) {
@@ -395,9 +297,43 @@ void ModMulFastConstEq(NativeInt *m_value, NativeInt b_m_value,
   (*m_value) = (NativeInt)(yprime >= 0 ? yprime : yprime + modulus_m_value);
 }
 
-NativeInt ModExp(NativeInt m_value, NativeInt b, NativeInt mod) {
-  NativeInt t = m_value % mod;
-  NativeInt mu = ComputeMu(mod);
+// Shoup multiplication by a constant b with its precomputation
+// floor(b 2^64 / modulus), for operands below a modulus of up to 62 bits
+NativeInt ModMulFastConst(NativeInt av, NativeInt b_m_value,
+                          NativeInt modulus_m_value, NativeInt bInv_mvalue) {
+  ModMulFastConstEq(&av, b_m_value, modulus_m_value, bInv_mvalue);
+  return av;
+}
+
+/*
+  Reduction of a 128-bit a by a modulus of up to 64 bits with the 128-bit
+  Barrett constant floor(2^128 / modulus), as BarrettUint128ModUint64 on the
+  host: only the low word of the quotient estimate is needed.
+*/
+static NativeInt BarrettDMod(struct typeD a, NativeInt modulus,
+                             NativeInt mu_lo, NativeInt mu_hi) {
+  struct typeD prod;
+  MultD(a.lo, mu_lo, &prod);
+  NativeInt left_hi = prod.hi;
+
+  MultD(a.lo, mu_hi, &prod);
+  NativeInt tmp1 = prod.lo + left_hi;
+  NativeInt tmp2 = prod.hi + (tmp1 < left_hi);
+
+  MultD(a.hi, mu_lo, &prod);
+  NativeInt sum = prod.lo + tmp1;
+  left_hi = prod.hi + (sum < tmp1);
+
+  NativeInt quot = a.hi * mu_hi + tmp2 + left_hi;
+  NativeInt result = a.lo - quot * modulus;
+  while (result >= modulus)
+    result -= modulus;
+  return result;
+}
+
+// m_value^b mod mod for m_value < mod, with the Barrett constant mu of mod
+NativeInt ModExp(NativeInt m_value, NativeInt b, NativeInt mod, NativeInt mu) {
+  NativeInt t = m_value;
   NativeInt r = 1;
   if (b & 0x1)
     ModMulFastEqB(&r, t, mod, mu);
@@ -429,7 +365,7 @@ NativeInt DivideAndRound(NativeInt m_value, NativeInt q) {
   if (q == 0)
     printf(" DivideAndRound: zero");
   NativeInt ans = m_value / q;
-  NativeInt rem = m_value % q;
+  NativeInt rem = m_value - ans * q;
   NativeInt halfQ = q >> 1;
   if (rem > halfQ)
     return ans + 1;
@@ -442,7 +378,7 @@ void DivideAndRoundEq(NativeInt *m_value, NativeInt q) {
 
 NativeInt ModInverse(NativeInt m_value, NativeInt mod) {
   SignedNativeInt modulus = mod;
-  SignedNativeInt a = m_value % mod;
+  SignedNativeInt a = m_value;
   if (a == 0) {
     printf("Does no have a mod inverse\n");
   }
@@ -454,7 +390,7 @@ NativeInt ModInverse(NativeInt m_value, NativeInt mod) {
   while (a > 1) {
     SignedNativeInt t = modulus;
     SignedNativeInt q = a / t;
-    modulus = a % t;
+    modulus = a - q * t;
     a = t;
     t = y;
     y = x - q * y;
@@ -0,0 +1,116 @@
+#ifndef __PIM_STREAM__
+#define __PIM_STREAM__
+
+/*
+  Streaming of MRAM operands through WRAM, shared by the element-wise kernels
+  of the resident DPU program. The including program defines meta and
+  my_barrier.
+
+  The operands are cut in tiles of stream_tile_bytes() that the tasklets take
+  in turn, the last tile of a buffer is shorter when the buffer is not a
+  multiple of the tile. A tasklet keeps one WRAM buffer per input operand and
+  computes its result in place of the first one before writing it out.
+*/
+
+// WRAM left to the tile buffers of all tasklets, the rest of the 64 KB holds
+// the tasklet stacks and the globals of the program
+#ifndef STREAM_WRAM_HEAP
+#define STREAM_WRAM_HEAP (40 << 10)
+#endif
+
+// Largest transfer of a single mram_read or mram_write
+#define STREAM_DMA_MAX 2048
+
+// Operand address of the kernels without a second vector operand
+#define STREAM_NONE ((uint32_t)-1)
+
+/*
+  Computes the results of words elements in place of a. b holds the matching
+  elements of the second operand of the vector kernels, NULL otherwise.
+*/
+typedef void (*stream_tile_fn)(NativeInt *a, NativeInt *b, size_t words);
+
+#ifdef PIM_DEBUG
+static void stream_dump(uint32_t offset, const NativeInt *tile, size_t words) {
+  printf("tasklet %u, offset %u:", me(), offset);
+  for (size_t i = 0; i < words; i++)
+    printf(" %lu", (unsigned long)tile[i]);
+  printf("\n");
+}
+#define STREAM_DUMP(offset, tile, words) stream_dump(offset, tile, words)
+#else
+#define STREAM_DUMP(offset, tile, words)
+#endif
+
+/*
+  Bytes of a tile for buffers WRAM buffers per tasklet: as large as the WRAM
+  share of a tasklet and a single DMA allow, but no larger than the share of
+  the operand of a tasklet so that short slices still keep every tasklet busy.
+*/
+static inline uint32_t stream_tile_bytes(uint32_t bytes, uint32_t buffers) {
+  uint32_t tile = STREAM_WRAM_HEAP / NR_TASKLETS / buffers;
+  if (tile > STREAM_DMA_MAX)
+    tile = STREAM_DMA_MAX;
+  tile &= ~7u;
+  uint32_t share = ((bytes + NR_TASKLETS - 1) / NR_TASKLETS + 7) & ~7u;
+  if (share < tile)
+    tile = share;
+  return tile != 0 ? tile : 8;
+}
+
+/*
+  Streams bytes of the operand at a, and of the one at b unless it is
+  STREAM_NONE, through fn and writes the result at res, which may be a. A NULL
+  fn copies a to res.
+*/
+static int stream_run(uint32_t a, uint32_t b, uint32_t res, uint32_t bytes,
+                      stream_tile_fn fn) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t tile = stream_tile_bytes(bytes, b == STREAM_NONE ? 1 : 2);
+  NativeInt *cache_A = (NativeInt *)mem_alloc(tile);
+  NativeInt *cache_B = b == STREAM_NONE ? NULL : (NativeInt *)mem_alloc(tile);
+
+  uint32_t mram_base_addr_A = (uint32_t)(DPU_MRAM_HEAP_POINTER + a);
+  uint32_t mram_base_addr_B = (uint32_t)(DPU_MRAM_HEAP_POINTER + b);
+  uint32_t mram_base_addr_res = (uint32_t)(DPU_MRAM_HEAP_POINTER + res);
+
+  for (uint32_t bytes_index = tasklet_id * tile; bytes_index < bytes;
+       bytes_index += tile * NR_TASKLETS) {
+    uint32_t chunk = bytes - bytes_index < tile ? bytes - bytes_index : tile;
+
+    mram_read((__mram_ptr void const *)(mram_base_addr_A + bytes_index),
+              cache_A, chunk);
+    if (cache_B != NULL)
+      mram_read((__mram_ptr void const *)(mram_base_addr_B + bytes_index),
+                cache_B, chunk);
+    if (fn != NULL)
+      fn(cache_A, cache_B, chunk >> 3);
+    STREAM_DUMP(bytes_index, cache_A, chunk >> 3);
+    mram_write(cache_A, (__mram_ptr void *)(mram_base_addr_res + bytes_index),
+               chunk);
+  }
+  return 0;
+}
+
+// Kernels on meta.args.elem, in_place ones write their result back to op1
+static inline int stream_elem(stream_tile_fn fn, int vector, int in_place) {
+  return stream_run(meta.args.elem.op1.start,
+                    vector ? meta.args.elem.op2.start : STREAM_NONE,
+                    in_place ? meta.args.elem.op1.start
+                             : meta.args.elem.res.start,
+                    meta.args.elem.op1.size, fn);
+}
+
+// Kernels on meta.args.mod, in_place ones write their result back to op
+static inline int stream_mod(stream_tile_fn fn, int in_place) {
+  return stream_run(meta.args.mod.op.start, STREAM_NONE,
+                    in_place ? meta.args.mod.op.start : meta.args.mod.res.start,
+                    meta.args.mod.op.size, fn);
+}
+
+#endif // __PIM_STREAM__
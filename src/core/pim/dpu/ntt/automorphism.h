@@ -0,0 +1,46 @@
+#ifndef __PIM_AUTOMORPHISM__
+#define __PIM_AUTOMORPHISM__
+
+/*
+  Automorphism of the evaluation form of a tower, the device side of
+  PolyImpl::AutomorphismTransform: the DPU permutes its slice of the input
+  into the slice of the result coming from it (see struct pim_automorphism).
+  The including program defines meta and my_barrier.
+
+  The tasklets take the tiles of the index map in turn. The indexes of a tile
+  are spread over the whole input slice, the words are gathered one DMA each.
+*/
+
+// Words of a tile, a tasklet also holds the indexes of the tile
+#define AUTOMORPHISM_TILE 128
+
+int automorphism(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t len = meta.args.autom.len;
+  uint32_t tile = AUTOMORPHISM_TILE < len ? AUTOMORPHISM_TILE : len;
+  uint32_t *index = (uint32_t *)mem_alloc(tile * sizeof(uint32_t));
+  NativeInt *data = (NativeInt *)mem_alloc(tile * sizeof(NativeInt));
+  uint32_t in = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.autom.in);
+  uint32_t out = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.autom.out);
+  uint32_t map = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.autom.map);
+
+  // len is even, so are the tiles: the indexes of a tile are whole 8 bytes
+  for (uint32_t k = tasklet_id * tile; k < len; k += NR_TASKLETS * tile) {
+    uint32_t words = len - k < tile ? len - k : tile;
+    mram_read((__mram_ptr void const *)(map + k * sizeof(uint32_t)), index,
+              words * sizeof(uint32_t));
+    for (uint32_t j = 0; j < words; ++j)
+      mram_read((__mram_ptr void const *)(in + index[j] * sizeof(NativeInt)),
+                &data[j], sizeof(NativeInt));
+    mram_write(data, (__mram_ptr void *)(out + k * sizeof(NativeInt)),
+               words * sizeof(NativeInt));
+  }
+  return 0;
+}
+
+#endif // __PIM_AUTOMORPHISM__
@@ -1,6 +0,0 @@
-#include <stdio.h>
-
-int main() {
-  printf("PIM started !!\n");
-  return 0;
-}
@@ -0,0 +1,220 @@
+#ifndef __PIM_NTT__
+#define __PIM_NTT__
+
+/*
+  Negacyclic NTT of the slice of a tower held by this DPU, the device side of
+  NumberTheoreticTransformNat::ForwardTransformToBitReverseInPlace and
+  InverseTransformFromBitReverseInPlace restricted to the butterfly stages that
+  stay within the slice (see struct pim_ntt). The including program defines
+  meta, tower and my_barrier.
+
+  A stage is cut in tiles of NTT_TILE words. When the butterfly groups are
+  smaller than a tile, a tile holds whole groups and their consecutive
+  twiddles; otherwise it holds half a tile of lower and half a tile of upper
+  inputs sharing a single twiddle. The tasklets take the tiles in turn and meet
+  on the barrier between two stages.
+*/
+
+// Words of a tile, a tasklet needs twice as much WRAM with the twiddles
+#define NTT_TILE 128
+
+// Cooley-Tukey butterfly of the forward transform
+static inline void ntt_ct_butterfly(NativeInt *lo, NativeInt *hi, NativeInt w,
+                                    NativeInt w_precon, NativeInt mod) {
+  NativeInt omega_factor = *hi;
+  ModMulFastConstEq(&omega_factor, w, mod, w_precon);
+  NativeInt lo_val = *lo;
+  NativeInt hi_val = lo_val + omega_factor;
+  if (hi_val >= mod)
+    hi_val -= mod;
+  if (lo_val < omega_factor)
+    lo_val += mod;
+  *lo = hi_val;
+  *hi = lo_val - omega_factor;
+}
+
+// Gentleman-Sande butterfly of the inverse transform
+static inline void ntt_gs_butterfly(NativeInt *lo, NativeInt *hi, NativeInt w,
+                                    NativeInt w_precon, NativeInt mod) {
+  NativeInt lo_val = *lo;
+  NativeInt hi_val = *hi;
+  NativeInt omega_factor = lo_val;
+  if (omega_factor < hi_val)
+    omega_factor += mod;
+  omega_factor -= hi_val;
+  lo_val += hi_val;
+  if (lo_val >= mod)
+    lo_val -= mod;
+  ModMulFastConstEq(&omega_factor, w, mod, w_precon);
+  *lo = lo_val;
+  *hi = omega_factor;
+}
+
+/*
+  Runs the butterflies of one tile, groups butterfly groups laid out one after
+  the other in data (a tile of a single group holds its lower inputs followed
+  by the upper ones). scale points to {n^-1, precon} in the first inverse
+  stage, NULL otherwise.
+*/
+static void ntt_tile(NativeInt *data, uint32_t words, uint32_t groups,
+                     const NativeInt *w, const NativeInt *w_precon,
+                     int inverse, const NativeInt *scale, NativeInt mod) {
+  uint32_t t = words / groups / 2;
+  for (uint32_t g = 0; g < groups; ++g) {
+    NativeInt *lo = data + 2 * t * g;
+    for (uint32_t j = 0; j < t; ++j) {
+      if (inverse)
+        ntt_gs_butterfly(lo + j, lo + j + t, w[g], w_precon[g], mod);
+      else
+        ntt_ct_butterfly(lo + j, lo + j + t, w[g], w_precon[g], mod);
+    }
+  }
+  if (scale != NULL) {
+    for (uint32_t j = 0; j < words; ++j)
+      ModMulFastConstEq(&data[j], scale[0], mod, scale[1]);
+  }
+}
+
+// A tower, or the slice of one, transformed by the stages below
+struct ntt_view {
+  uint32_t data;   // MRAM address of the slice
+  uint32_t n;      // ring dimension
+  uint32_t len;    // words of the slice
+  uint32_t slice;  // index of the slice within the tower
+  uint32_t tables; // MRAM address of the tables (see struct pim_ntt)
+  NativeInt mod;
+};
+
+/*
+  One stage of m butterfly groups of 2t words over the whole tower. roots is
+  the MRAM address of the twiddles of the direction, their precomputations
+  follow n words after.
+*/
+static void ntt_stage(const struct ntt_view *v, uint32_t m, uint32_t t,
+                      uint32_t roots, int inverse, const NativeInt *scale,
+                      NativeInt *data, NativeInt *w, NativeInt *w_precon) {
+  unsigned int tasklet_id = me();
+  uint32_t len = v->len;
+  uint32_t tile = NTT_TILE < len ? NTT_TILE : len;
+  uint32_t half = tile / 2;
+  uint32_t precons = roots + v->n * sizeof(NativeInt);
+  uint32_t mram_base_addr = v->data;
+  // Table index of the first butterfly group of this slice
+  uint32_t first = m + v->slice * (len / (2 * t));
+
+  for (uint32_t k = tasklet_id; k < len / tile; k += NR_TASKLETS) {
+    if (2 * t <= tile) {
+      uint32_t groups = tile / (2 * t);
+      uint32_t addr = mram_base_addr + k * tile * sizeof(NativeInt);
+      uint32_t index = (first + k * groups) * sizeof(NativeInt);
+
+      mram_read((__mram_ptr void const *)addr, data, tile * sizeof(NativeInt));
+      mram_read((__mram_ptr void const *)(roots + index), w,
+                groups * sizeof(NativeInt));
+      mram_read((__mram_ptr void const *)(precons + index), w_precon,
+                groups * sizeof(NativeInt));
+      ntt_tile(data, tile, groups, w, w_precon, inverse, scale, v->mod);
+      mram_write(data, (__mram_ptr void *)addr, tile * sizeof(NativeInt));
+    } else {
+      uint32_t tiles_per_group = t / half;
+      uint32_t g = k / tiles_per_group;
+      uint32_t lo_addr =
+          mram_base_addr +
+          (2 * t * g + (k % tiles_per_group) * half) * sizeof(NativeInt);
+      uint32_t hi_addr = lo_addr + t * sizeof(NativeInt);
+      uint32_t index = (first + g) * sizeof(NativeInt);
+
+      mram_read((__mram_ptr void const *)lo_addr, data,
+                half * sizeof(NativeInt));
+      mram_read((__mram_ptr void const *)hi_addr, data + half,
+                half * sizeof(NativeInt));
+      mram_read((__mram_ptr void const *)(roots + index), w,
+                sizeof(NativeInt));
+      mram_read((__mram_ptr void const *)(precons + index), w_precon,
+                sizeof(NativeInt));
+      ntt_tile(data, tile, 1, w, w_precon, inverse, scale, v->mod);
+      mram_write(data, (__mram_ptr void *)lo_addr, half * sizeof(NativeInt));
+      mram_write(data + half, (__mram_ptr void *)hi_addr,
+                 half * sizeof(NativeInt));
+    }
+  }
+  barrier_wait(&my_barrier);
+}
+
+/*
+  Forward stages m = n/len .. n/2, the slice is in bit reversed order after.
+  Every tasklet runs it with its own WRAM buffers: data of NTT_TILE words, w
+  and w_precon of half as many.
+*/
+static void ntt_forward_view(const struct ntt_view *v, NativeInt *data,
+                             NativeInt *w, NativeInt *w_precon) {
+  for (uint32_t m = v->n / v->len, t = v->len / 2; t >= 1; m <<= 1, t >>= 1)
+    ntt_stage(v, m, t, v->tables, 0, NULL, data, w, w_precon);
+}
+
+/*
+  Inverse stages m = n/2 .. n/len, the first one also scales by n^-1, read
+  into the two words of scale.
+*/
+static void ntt_inverse_view(const struct ntt_view *v, NativeInt *data,
+                             NativeInt *w, NativeInt *w_precon,
+                             NativeInt *scale) {
+  uint32_t n = v->n;
+  uint32_t roots = v->tables + 2 * n * sizeof(NativeInt);
+
+  mram_read((__mram_ptr void const *)(v->tables + 4 * n * sizeof(NativeInt)),
+            scale, 2 * sizeof(NativeInt));
+  for (uint32_t m = n / 2, t = 1; m >= n / v->len; m >>= 1, t <<= 1)
+    ntt_stage(v, m, t, roots, 1, m == n / 2 ? scale : NULL, data, w, w_precon);
+}
+
+// The slice of the launch, from meta and tower
+static struct ntt_view ntt_launch_view(void) {
+  struct ntt_view v;
+  v.data = (uint32_t)(DPU_MRAM_HEAP_POINTER + meta.args.ntt.data.start);
+  v.n = meta.args.ntt.n;
+  v.len = v.n / meta.args.ntt.groups;
+  v.slice = tower.slice;
+  v.tables = (uint32_t)(DPU_MRAM_HEAP_POINTER + tower.twiddles);
+  v.mod = tower.mod;
+  return v;
+}
+
+int ntt_forward(void) {
+  if (!tower.valid)
+    return 0;
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  struct ntt_view v = ntt_launch_view();
+  uint32_t tile = NTT_TILE < v.len ? NTT_TILE : v.len;
+  NativeInt *data = (NativeInt *)mem_alloc(tile * sizeof(NativeInt));
+  NativeInt *w = (NativeInt *)mem_alloc(tile / 2 * sizeof(NativeInt));
+  NativeInt *w_precon = (NativeInt *)mem_alloc(tile / 2 * sizeof(NativeInt));
+  ntt_forward_view(&v, data, w, w_precon);
+  return 0;
+}
+
+int ntt_inverse(void) {
+  if (!tower.valid)
+    return 0;
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  struct ntt_view v = ntt_launch_view();
+  uint32_t tile = NTT_TILE < v.len ? NTT_TILE : v.len;
+  NativeInt *data = (NativeInt *)mem_alloc(tile * sizeof(NativeInt));
+  NativeInt *w = (NativeInt *)mem_alloc(tile / 2 * sizeof(NativeInt));
+  NativeInt *w_precon = (NativeInt *)mem_alloc(tile / 2 * sizeof(NativeInt));
+  NativeInt *scale = (NativeInt *)mem_alloc(2 * sizeof(NativeInt));
+  ntt_inverse_view(&v, data, w, w_precon, scale);
+  return 0;
+}
+
+#endif // __PIM_NTT__
@@ -0,0 +1,110 @@
+/*
+  Resident DPU program bundling every PIM kernel. It is loaded once when the
+  DPUs are allocated; each launch selects its kernel through meta.opcode, so
+  switching operations costs a WRAM broadcast instead of a dpu_load.
+*/
+#include "../include/common.h"
+#include "../include/element-wise-ops.h"
+#include <barrier.h>
+#include <perfcounter.h>
+#include <stdint.h>
+#include <stdio.h>
+
+__host struct pim_meta meta;
+
+__host struct pim_tower tower;
+
+__host struct pim_stats stats;
+
+BARRIER_INIT(my_barrier, NR_TASKLETS);
+
+// Moduli of the kernels, resolving PIM_TOWER_MODULUS to the tower of this DPU
+static inline uint64_t elem_modulus(void) {
+  return meta.args.elem.mod == PIM_TOWER_MODULUS ? tower.mod
+                                                 : meta.args.elem.mod;
+}
+
+// Barrett constant of elem_modulus(), shipped by the host; computed here only
+// when it was left out
+static inline uint64_t elem_mu(void) {
+  uint64_t mu = meta.args.elem.mod == PIM_TOWER_MODULUS ? tower.mu
+                                                        : meta.args.elem.mu;
+  return mu != 0 ? mu : ComputeMu(elem_modulus());
+}
+
+static inline uint64_t mod_ops_modulus(void) {
+  return meta.args.mod.mod == PIM_TOWER_MODULUS ? tower.mod
+                                                : meta.args.mod.mod;
+}
+
+// Barrett constant of mod_ops_modulus(), computed here for a shared modulus
+static inline uint64_t mod_ops_mu(void) {
+  return meta.args.mod.mod == PIM_TOWER_MODULUS ? tower.mu
+                                                : ComputeMu(meta.args.mod.mod);
+}
+
+#include "../include/stream.h"
+
+#include "../basis/base-conv.h"
+#include "../basis/rescale.h"
+#include "../element-wise/add-mod.h"
+#include "../element-wise/mac.h"
+#include "../element-wise/mem-copy.h"
+#include "../element-wise/mod-ops.h"
+#include "../element-wise/mult-mod.h"
+#include "../element-wise/sub-mod.h"
+#include "../ntt/automorphism.h"
+#include "../ntt/ntt.h"
+#include "../sampling/uniform.h"
+
+#include "../binfhe/blind-rotate.h"
+
+static int run_kernel(void) {
+  switch (meta.opcode) {
+  case OP_ELEM_MOD_ADD:
+    return add_mod_kernels[meta.args.elem.kernel]();
+  case OP_ELEM_MOD_SUB:
+    return sub_mod_kernels[meta.args.elem.kernel]();
+  case OP_ELEM_MOD_MULT:
+    return mult_mod_kernels[meta.args.elem.kernel]();
+  case OP_ELEM_MOD_OPS:
+    return mod_ops_kernels[meta.args.mod.kernel]();
+  case OP_MEM_COPY:
+    return mem_copy();
+  case OP_NTT_FORWARD:
+    return ntt_forward();
+  case OP_NTT_INVERSE:
+    return ntt_inverse();
+  case OP_BASE_CONV:
+    return base_conv();
+  case OP_AUTOMORPHISM:
+    return automorphism();
+  case OP_BLIND_ROTATE:
+    return blind_rotate();
+  case OP_MAC:
+    return mac();
+  case OP_RESCALE:
+    return rescale();
+  case OP_UNIFORM:
+    return uniform();
+  case PIM_OPCODES:
+    break;
+  }
+  return -1;
+}
+
+int main(void) {
+  if (me() == 0)
+    perfcounter_config(COUNT_CYCLES, true);
+
+  // A launch given tower descriptions only runs on the DPUs holding one
+  int ret = meta.described && !tower.valid ? 0 : run_kernel();
+
+  // The launch lasts until the slowest tasklet is done
+  barrier_wait(&my_barrier);
+  if (me() == 0 && meta.opcode < PIM_OPCODES) {
+    stats.cycles[meta.opcode] += perfcounter_get();
+    stats.launches[meta.opcode]++;
+  }
+  return ret;
+}
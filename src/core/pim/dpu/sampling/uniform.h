@@ -0,0 +1,118 @@
+#ifndef __PIM_UNIFORM__
+#define __PIM_UNIFORM__
+
+/*
+  Uniform towers expanded from a key (see struct pim_uniform), word for word
+  the ones of pim_uniform_fill on the host. The including program defines
+  meta, tower and my_barrier.
+
+  The tasklets take tiles of the slice in turn. A ChaCha20 block gives the
+  first draw of 8 coefficients, a rejected word is drawn again from the
+  blocks of the next rounds.
+*/
+
+#define UNIFORM_ROW 4
+
+static inline uint32_t chacha_rotl(uint32_t v, int c) {
+  return (v << c) | (v >> (32 - c));
+}
+
+#define CHACHA_QR(a, b, c, d)                                                  \
+  a += b;                                                                      \
+  d = chacha_rotl(d ^ a, 16);                                                  \
+  c += d;                                                                      \
+  b = chacha_rotl(b ^ c, 12);                                                  \
+  a += b;                                                                      \
+  d = chacha_rotl(d ^ a, 8);                                                   \
+  c += d;                                                                      \
+  b = chacha_rotl(b ^ c, 7)
+
+// ChaCha20 block function (RFC 8439, section 2.3)
+static void chacha20_block(const uint32_t *key, uint32_t counter,
+                           const uint32_t *nonce, uint32_t *out) {
+  uint32_t x[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                    key[0],     key[1],     key[2],     key[3],
+                    key[4],     key[5],     key[6],     key[7],
+                    counter,    nonce[0],   nonce[1],   nonce[2]};
+  for (int i = 0; i < 16; ++i)
+    out[i] = x[i];
+  for (int i = 0; i < 10; ++i) {
+    CHACHA_QR(x[0], x[4], x[8], x[12]);
+    CHACHA_QR(x[1], x[5], x[9], x[13]);
+    CHACHA_QR(x[2], x[6], x[10], x[14]);
+    CHACHA_QR(x[3], x[7], x[11], x[15]);
+    CHACHA_QR(x[0], x[5], x[10], x[15]);
+    CHACHA_QR(x[1], x[6], x[11], x[12]);
+    CHACHA_QR(x[2], x[7], x[8], x[13]);
+    CHACHA_QR(x[3], x[4], x[9], x[14]);
+  }
+  for (int i = 0; i < 16; ++i)
+    out[i] += x[i];
+}
+
+#undef CHACHA_QR
+
+int uniform(void) {
+  unsigned int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset(); // Resets the heap
+  }
+  barrier_wait(&my_barrier);
+
+  uint32_t count = meta.args.uniform.count;
+  uint32_t bytes = meta.args.uniform.len * sizeof(NativeInt);
+  uint32_t n = meta.args.uniform.n;
+  uint32_t base = tower.slice * meta.args.uniform.len;
+  uint32_t heap = (uint32_t)DPU_MRAM_HEAP_POINTER;
+  uint32_t rows = heap + meta.args.uniform.rows;
+
+  uint32_t tile = stream_tile_bytes(bytes, 1);
+  NativeInt *out = (NativeInt *)mem_alloc(tile);
+  NativeInt *row = (NativeInt *)mem_alloc(UNIFORM_ROW * sizeof(NativeInt));
+  uint32_t *block = (uint32_t *)mem_alloc(16 * sizeof(uint32_t));
+  uint32_t *retry = (uint32_t *)mem_alloc(16 * sizeof(uint32_t));
+
+  for (uint32_t first = tasklet_id * tile; first < bytes;
+       first += tile * NR_TASKLETS) {
+    uint32_t chunk = bytes - first < tile ? bytes - first : tile;
+    uint32_t words = chunk >> 3;
+
+    for (uint32_t i = 0; i < count; ++i) {
+      mram_read((__mram_ptr void const *)(rows + i * UNIFORM_ROW *
+                                                     sizeof(NativeInt)),
+                row, UNIFORM_ROW * sizeof(NativeInt));
+      NativeInt q = row[0];
+      NativeInt mask = row[1];
+      uint32_t nonce[3] = {0, (uint32_t)row[2], (uint32_t)(row[2] >> 32)};
+      uint32_t cached = UINT32_MAX;
+
+      for (uint32_t w = 0; w < words; ++w) {
+        uint32_t k = base + (first >> 3) + w;
+        if (k >= n) {
+          out[w] = 0;
+          continue;
+        }
+        uint32_t j = k & 7;
+        if (k >> 3 != cached) {
+          cached = k >> 3;
+          chacha20_block(meta.args.uniform.key, cached, nonce, block);
+        }
+        NativeInt v =
+            ((NativeInt)block[2 * j + 1] << 32 | block[2 * j]) & mask;
+        uint32_t round[3] = {0, nonce[1], nonce[2]};
+        while (v >= q) {
+          round[0]++;
+          chacha20_block(meta.args.uniform.key, cached, round, retry);
+          v = ((NativeInt)retry[2 * j + 1] << 32 | retry[2 * j]) & mask;
+        }
+        out[w] = v;
+      }
+      STREAM_DUMP(first, out, words);
+      mram_write(out, (__mram_ptr void *)(heap + (uint32_t)row[3] + first),
+                 chunk);
+    }
+  }
+  return 0;
+}
+
+#endif // __PIM_UNIFORM__
@@ -0,0 +1,14 @@
+#ifndef __PIM_EMU_ALLOC__
+#define __PIM_EMU_ALLOC__
+
+/*
+  Host stand-in for the alloc.h of the DPU runtime, the WRAM heap is shared by
+  the tasklets of a DPU.
+*/
+#include "pim-emu.h"
+
+static inline void *mem_alloc(size_t size) { return pim_emu_mem_alloc(size); }
+
+static inline void mem_reset(void) { pim_emu_mem_reset(); }
+
+#endif // __PIM_EMU_ALLOC__
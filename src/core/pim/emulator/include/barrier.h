@@ -0,0 +1,20 @@
+#ifndef __PIM_EMU_BARRIER__
+#define __PIM_EMU_BARRIER__
+
+/*
+  Host stand-in for the barrier.h of the DPU runtime. The emulator has a
+  single barrier per DPU spanning all its tasklets, which is what the kernels
+  declare.
+*/
+#include "pim-emu.h"
+
+typedef int barrier_t;
+
+#define BARRIER_INIT(_name, _count) barrier_t _name
+
+static inline void barrier_wait(barrier_t *barrier) {
+  (void)barrier;
+  pim_emu_barrier_wait();
+}
+
+#endif // __PIM_EMU_BARRIER__
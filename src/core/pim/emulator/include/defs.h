@@ -0,0 +1,21 @@
+#ifndef __PIM_EMU_DEFS__
+#define __PIM_EMU_DEFS__
+
+/*
+  Host stand-in for the defs.h of the DPU runtime. WRAM variables shared with
+  the host become thread local: every tasklet thread gets the values the host
+  pushed before the launch.
+*/
+#include "pim-emu.h"
+
+#define __host _Thread_local
+#define __mram_ptr
+#define __mram_noinit
+#define __dma_aligned __attribute__((aligned(8)))
+#define __noinline __attribute__((noinline))
+
+typedef unsigned sysname_t;
+
+static inline sysname_t me(void) { return pim_emu_me(); }
+
+#endif // __PIM_EMU_DEFS__
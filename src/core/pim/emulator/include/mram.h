@@ -0,0 +1,20 @@
+#ifndef __PIM_EMU_MRAM__
+#define __PIM_EMU_MRAM__
+
+/*
+  Host stand-in for the mram.h of the DPU runtime. MRAM addresses are offsets
+  in the simulated MRAM of the DPU, the heap starts at its beginning.
+*/
+#include "defs.h"
+
+#define DPU_MRAM_HEAP_POINTER ((uintptr_t)0)
+
+static inline void mram_read(const void *from, void *to, unsigned bytes) {
+  pim_emu_mram_read((uintptr_t)from, to, bytes);
+}
+
+static inline void mram_write(const void *from, void *to, unsigned bytes) {
+  pim_emu_mram_write(from, (uintptr_t)to, bytes);
+}
+
+#endif // __PIM_EMU_MRAM__
@@ -0,0 +1,32 @@
+#ifndef __PIM_EMU_PERFCOUNTER__
+#define __PIM_EMU_PERFCOUNTER__
+
+/*
+  Host stand-in for the perfcounter.h of the DPU runtime, the counter of an
+  emulated DPU runs at the host clock (nanoseconds) whatever the config.
+*/
+#include "pim-emu.h"
+#include <stdbool.h>
+
+typedef uint64_t perfcounter_t;
+
+typedef enum _perfcounter_config_t {
+  COUNT_SAME,
+  COUNT_CYCLES,
+  COUNT_INSTRUCTIONS,
+  COUNT_NOTHING,
+} perfcounter_config_t;
+
+static inline perfcounter_t perfcounter_config(perfcounter_config_t config,
+                                               bool reset_value) {
+  (void)config;
+  perfcounter_t value = pim_emu_perfcounter_get();
+  pim_emu_perfcounter_config(reset_value);
+  return value;
+}
+
+static inline perfcounter_t perfcounter_get(void) {
+  return pim_emu_perfcounter_get();
+}
+
+#endif // __PIM_EMU_PERFCOUNTER__
@@ -0,0 +1,39 @@
+#ifndef __PIM_EMU__
+#define __PIM_EMU__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  Services of an emulated DPU, implemented by the emulator backend for the
+  kernels compiled for the host. They act on the DPU and the tasklet run by
+  the calling thread.
+*/
+unsigned pim_emu_me(void);
+void *pim_emu_mem_alloc(size_t size);
+void pim_emu_mem_reset(void);
+void pim_emu_mram_read(uintptr_t from, void *to, uint32_t bytes);
+void pim_emu_mram_write(const void *from, uintptr_t to, uint32_t bytes);
+void pim_emu_barrier_wait(void);
+void pim_emu_perfcounter_config(int reset);
+uint64_t pim_emu_perfcounter_get(void);
+int pim_emu_printf(const char *format, ...);
+
+/*
+  Entry points of the resident program compiled for the host. Its __host
+  variables are thread local, pim_emu_symbol gives the copy of the calling
+  thread, index by index until it returns NULL.
+*/
+int pim_emu_kernel_main(void);
+unsigned pim_emu_nr_tasklets(void);
+void *pim_emu_symbol(unsigned index, const char **name, uint32_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PIM_EMU__
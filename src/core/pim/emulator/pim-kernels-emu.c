@@ -0,0 +1,45 @@
+/*
+  The resident DPU program compiled for the host and run by the emulator
+  backend. The headers in include/ stand in for the DPU runtime, the kernels
+  themselves are used unchanged.
+*/
+#include "pim-emu.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef NR_TASKLETS
+#define NR_TASKLETS 16
+#endif
+
+// Kernel output goes to the log of the emulated DPU, as with dpu_log_read
+#define printf pim_emu_printf
+
+// MRAM addresses are 32-bit on the DPU, the kernels cast them to pointers
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+
+#define main pim_emu_kernel_main
+#include "../dpu/resident/pim-kernels.c"
+#undef main
+
+unsigned pim_emu_nr_tasklets(void) { return NR_TASKLETS; }
+
+// Every __host variable of the resident program has to be listed here
+void *pim_emu_symbol(unsigned index, const char **name, uint32_t *size) {
+  switch (index) {
+  case 0:
+    *name = "meta";
+    *size = sizeof(meta);
+    return &meta;
+  case 1:
+    *name = "tower";
+    *size = sizeof(tower);
+    return &tower;
+  case 2:
+    *name = "stats";
+    *size = sizeof(stats);
+    return &stats;
+  }
+  return NULL;
+}
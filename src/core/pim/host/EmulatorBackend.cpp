@@ -0,0 +1,346 @@
+#include "../emulator/include/pim-emu.h"
+#include "pim/PimBackend.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Sizes of the memories of an emulated DPU, as on the UPMEM DPUs
+const uint32_t EMU_MRAM_SIZE = 64 << 20;
+const uint32_t EMU_WRAM_HEAP_SIZE = 64 << 10;
+// Largest single MRAM DMA transfer of a DPU
+const uint32_t EMU_DMA_MAX = 2048;
+
+class EmulatedBarrier {
+public:
+  void reset(uint32_t count) { expected = count; }
+
+  void wait() {
+    std::unique_lock<std::mutex> guard(lock);
+    uint64_t gen = generation;
+    if (++arrived == expected) {
+      arrived = 0;
+      generation++;
+      cv.notify_all();
+      return;
+    }
+    cv.wait(guard, [&] { return gen != generation; });
+  }
+
+private:
+  std::mutex lock;
+  std::condition_variable cv;
+  uint32_t expected = 0;
+  uint32_t arrived = 0;
+  uint64_t generation = 0;
+};
+
+struct EmulatedDpu {
+  // calloc keeps the untouched MRAM pages out of the host memory
+  std::unique_ptr<uint8_t, decltype(&std::free)> mram{
+      static_cast<uint8_t *>(std::calloc(EMU_MRAM_SIZE, 1)), &std::free};
+  std::vector<uint64_t> heap = std::vector<uint64_t>(EMU_WRAM_HEAP_SIZE / 8);
+  uint32_t heap_used = 0;
+  std::map<std::string, std::vector<uint8_t>> symbols;
+  std::string log;
+  std::mutex lock;
+  EmulatedBarrier barrier;
+  std::chrono::steady_clock::time_point perf_start;
+};
+
+thread_local EmulatedDpu *current_dpu = nullptr;
+thread_local unsigned current_tasklet = 0;
+
+[[noreturn]] void fault(const char *what) {
+  std::cerr << "PIM emulator: DPU fault in tasklet " << current_tasklet << ", "
+            << what << std::endl;
+  std::abort();
+}
+
+void check_dma(uintptr_t mram, const void *wram, uint32_t bytes) {
+  if (bytes == 0 || bytes > EMU_DMA_MAX || bytes % 8 != 0)
+    fault("MRAM transfer size must be a multiple of 8 up to 2048 bytes");
+  if (mram % 8 != 0 || reinterpret_cast<uintptr_t>(wram) % 8 != 0)
+    fault("unaligned MRAM transfer");
+  if (mram + bytes > EMU_MRAM_SIZE)
+    fault("MRAM access out of bounds");
+}
+
+} // namespace
+
+extern "C" {
+
+unsigned pim_emu_me(void) { return current_tasklet; }
+
+void *pim_emu_mem_alloc(size_t size) {
+  std::lock_guard<std::mutex> guard(current_dpu->lock);
+  uint32_t aligned = (size + 7) & ~size_t(7);
+  if (current_dpu->heap_used + aligned > EMU_WRAM_HEAP_SIZE)
+    fault("WRAM heap exhausted");
+  void *ptr = reinterpret_cast<uint8_t *>(current_dpu->heap.data()) +
+              current_dpu->heap_used;
+  current_dpu->heap_used += aligned;
+  return ptr;
+}
+
+void pim_emu_mem_reset(void) {
+  std::lock_guard<std::mutex> guard(current_dpu->lock);
+  current_dpu->heap_used = 0;
+}
+
+void pim_emu_mram_read(uintptr_t from, void *to, uint32_t bytes) {
+  check_dma(from, to, bytes);
+  std::memcpy(to, current_dpu->mram.get() + from, bytes);
+}
+
+void pim_emu_mram_write(const void *from, uintptr_t to, uint32_t bytes) {
+  check_dma(to, from, bytes);
+  std::memcpy(current_dpu->mram.get() + to, from, bytes);
+}
+
+void pim_emu_barrier_wait(void) { current_dpu->barrier.wait(); }
+
+void pim_emu_perfcounter_config(int reset) {
+  if (reset)
+    current_dpu->perf_start = std::chrono::steady_clock::now();
+}
+
+uint64_t pim_emu_perfcounter_get(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - current_dpu->perf_start)
+      .count();
+}
+
+int pim_emu_printf(const char *format, ...) {
+  char line[1024];
+  va_list args;
+  va_start(args, format);
+  int written = std::vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (current_dpu == nullptr)
+    return std::fputs(line, stdout);
+  std::lock_guard<std::mutex> guard(current_dpu->lock);
+  current_dpu->log += line;
+  return written;
+}
+}
+
+/**
+ * Backend running the resident program compiled for the host. Every DPU has
+ * its own MRAM, WRAM heap, barrier and host symbols and runs its tasklets
+ * on threads of their own; the DPUs themselves are spread over the host
+ * cores. Submitted operations are executed in order by a queue thread, the
+ * way a rank runs its asynchronous jobs.
+ */
+class EmulatorBackend : public PimBackend {
+public:
+  explicit EmulatorBackend(uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+      dpus.push_back(std::make_unique<EmulatedDpu>());
+      if (dpus.back()->mram == nullptr)
+        throw std::runtime_error("PimBackend: cannot allocate emulated MRAM");
+      const char *name = nullptr;
+      uint32_t size = 0;
+      for (unsigned s = 0; pim_emu_symbol(s, &name, &size) != nullptr; ++s)
+        dpus.back()->symbols[name].assign(size, 0);
+    }
+    worker = std::thread([this] { run_queue(); });
+  }
+
+  ~EmulatorBackend() override {
+    {
+      std::lock_guard<std::mutex> guard(queue_lock);
+      stopping = true;
+    }
+    queue_cv.notify_all();
+    worker.join();
+  }
+
+  uint32_t get_nr_dpus() const override { return dpus.size(); }
+
+  std::string name() const override { return "emulator"; }
+
+  void load(const std::string &binary) override {
+    if (binary.find("pim-kernels") == std::string::npos)
+      throw std::invalid_argument(
+          "PimBackend: the emulator only runs the resident program, not " +
+          binary);
+    // A load resets the WRAM of the DPUs
+    submit(
+        [this] {
+          for (auto &dpu : dpus)
+            for (auto &symbol : dpu->symbols)
+              std::fill(symbol.second.begin(), symbol.second.end(), 0);
+        },
+        false);
+  }
+
+  void launch(bool async) override {
+    submit([this] { run_dpus(); }, async);
+  }
+
+  void xfer(const std::vector<void *> &bufs, bool to_pim,
+            const std::string &symbol, uint32_t offset, uint32_t bytes,
+            bool async) override {
+    std::vector<std::pair<uint8_t *, uint8_t *>> copies;
+    for (uint32_t i = 0; i < bufs.size() && i < dpus.size(); ++i) {
+      if (bufs[i] != nullptr)
+        copies.push_back({static_cast<uint8_t *>(bufs[i]),
+                          locate(*dpus[i], symbol, offset, bytes)});
+    }
+    submit(
+        [copies, to_pim, bytes] {
+          for (auto &copy : copies) {
+            if (to_pim)
+              std::memcpy(copy.second, copy.first, bytes);
+            else
+              std::memcpy(copy.first, copy.second, bytes);
+          }
+        },
+        async);
+  }
+
+  void broadcast(const std::string &symbol, uint32_t offset, const void *buf,
+                 uint32_t bytes, bool async) override {
+    std::vector<void *> bufs(dpus.size(), const_cast<void *>(buf));
+    xfer(bufs, true, symbol, offset, bytes, async);
+  }
+
+  void callback(std::function<void()> fn) override { submit(fn, true); }
+
+  void sync() override {
+    std::unique_lock<std::mutex> guard(queue_lock);
+    done_cv.wait(guard, [this] { return completed == submitted; });
+  }
+
+  void log(FILE *out) override {
+    sync();
+    for (auto &dpu : dpus)
+      std::fputs(dpu->log.c_str(), out);
+  }
+
+private:
+  // Memory behind a symbol, checked here so that a bad transfer throws in
+  // the caller instead of faulting in the queue
+  uint8_t *locate(EmulatedDpu &dpu, const std::string &symbol,
+                  uint32_t offset, uint32_t bytes) {
+    if (symbol == DPU_MRAM_HEAP_POINTER_NAME) {
+      if (uint64_t(offset) + bytes > EMU_MRAM_SIZE)
+        throw std::out_of_range("PimBackend: MRAM transfer out of bounds");
+      return dpu.mram.get() + offset;
+    }
+    auto it = dpu.symbols.find(symbol);
+    if (it == dpu.symbols.end())
+      throw std::invalid_argument("PimBackend: unknown symbol " + symbol);
+    if (uint64_t(offset) + bytes > it->second.size())
+      throw std::out_of_range("PimBackend: transfer past symbol " + symbol);
+    return it->second.data() + offset;
+  }
+
+  void submit(std::function<void()> op, bool async) {
+    uint64_t ticket;
+    {
+      std::lock_guard<std::mutex> guard(queue_lock);
+      queue.push_back(std::move(op));
+      ticket = ++submitted;
+    }
+    queue_cv.notify_all();
+    if (!async) {
+      std::unique_lock<std::mutex> guard(queue_lock);
+      done_cv.wait(guard, [&] { return completed >= ticket; });
+    }
+  }
+
+  void run_queue() {
+    for (;;) {
+      std::function<void()> op;
+      {
+        std::unique_lock<std::mutex> guard(queue_lock);
+        queue_cv.wait(guard, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+          return;
+        op = std::move(queue.front());
+        queue.pop_front();
+      }
+      op();
+      {
+        std::lock_guard<std::mutex> guard(queue_lock);
+        completed++;
+      }
+      done_cv.notify_all();
+    }
+  }
+
+  void run_dpus() {
+    uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t nr_workers = std::min<uint32_t>(dpus.size(), cores);
+    std::atomic<uint32_t> next{0};
+    auto drive = [&] {
+      for (uint32_t d = next++; d < dpus.size(); d = next++)
+        run_dpu(*dpus[d]);
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < nr_workers; ++i)
+      workers.emplace_back(drive);
+    drive();
+    for (auto &w : workers)
+      w.join();
+  }
+
+  void run_dpu(EmulatedDpu &dpu) {
+    uint32_t nr_tasklets = pim_emu_nr_tasklets();
+    dpu.log.clear();
+    dpu.barrier.reset(nr_tasklets);
+    dpu.perf_start = std::chrono::steady_clock::now();
+
+    auto tasklet = [&dpu](unsigned id) {
+      current_dpu = &dpu;
+      current_tasklet = id;
+      const char *name = nullptr;
+      uint32_t size = 0;
+      void *addr = nullptr;
+      for (unsigned s = 0; (addr = pim_emu_symbol(s, &name, &size)); ++s)
+        std::memcpy(addr, dpu.symbols[name].data(), size);
+
+      pim_emu_kernel_main();
+
+      // The copy of tasklet 0 is the one the host reads back
+      if (id == 0) {
+        for (unsigned s = 0; (addr = pim_emu_symbol(s, &name, &size)); ++s)
+          std::memcpy(dpu.symbols[name].data(), addr, size);
+      }
+    };
+
+    std::vector<std::thread> tasklets;
+    for (unsigned id = 0; id < nr_tasklets; ++id)
+      tasklets.emplace_back(tasklet, id);
+    for (auto &t : tasklets)
+      t.join();
+  }
+
+  std::vector<std::unique_ptr<EmulatedDpu>> dpus;
+  std::thread worker;
+  std::mutex queue_lock;
+  std::condition_variable queue_cv;
+  std::condition_variable done_cv;
+  std::deque<std::function<void()>> queue;
+  uint64_t submitted = 0;
+  uint64_t completed = 0;
+  bool stopping = false;
+};
+
+std::unique_ptr<PimBackend> make_emulator_backend(uint32_t nr_dpus) {
+  return std::make_unique<EmulatorBackend>(nr_dpus);
+}
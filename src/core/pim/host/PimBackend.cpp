@@ -0,0 +1,32 @@
+#include "pim/PimBackend.h"
+#include <cstdlib>
+#include <stdexcept>
+
+static std::string backend_name() {
+  const char *env = std::getenv("PIM_BACKEND");
+  std::string name = env != nullptr ? env : "";
+  if (name.empty()) {
+#ifdef RUN_ON_DPU
+    name = "upmem";
+#else
+    name = "emulator";
+#endif
+  }
+  if (name != "emulator" && name != "upmem")
+    throw std::invalid_argument("PimBackend: unknown backend " + name);
+  return name;
+}
+
+std::unique_ptr<PimBackend> PimBackend::create(uint32_t nr_dpus,
+                                               const std::string &profile) {
+  if (backend_name() == "emulator")
+    return make_emulator_backend(nr_dpus);
+  return make_upmem_backend(nr_dpus, profile);
+}
+
+std::unique_ptr<PimBackend>
+PimBackend::create_ranks(uint32_t nr_ranks, const std::string &profile) {
+  if (backend_name() == "emulator")
+    return make_emulator_backend(nr_ranks * EMU_RANK_DPUS);
+  return make_upmem_rank_backend(nr_ranks, profile);
+}
@@ -0,0 +1,85 @@
+#include "pim/PimBlindRotate.h"
+#include "pim/PimManager.h"
+#include "pim/PimModArith.h"
+
+bool pim_blind_rotate(PimManager &pim,
+                      const std::shared_ptr<const void> &owner,
+                      const PimBootKey &key,
+                      const std::vector<PimGateInput> &inputs,
+                      std::vector<PimGateOutput> &outputs) {
+  int32_t key_addr = pim.boot_key(owner, key);
+  if (key_addr == -1)
+    return false;
+
+  uint32_t N = key.N;
+  uint32_t nr_dpus = pim.getNumDpus();
+  uint32_t job_words = sizeof(struct pim_gate) / sizeof(uint64_t) +
+                       DIVROUNDUP(key.n, 2);
+  uint32_t out_words = N + 2;
+  uint32_t work_words = (4 + key.digits) * N;
+  auto jobs = pim.allocate(size_t(job_words) * sizeof(uint64_t) * nr_dpus);
+  auto out = pim.allocate(size_t(out_words) * sizeof(uint64_t) * nr_dpus);
+  auto work = pim.allocate(size_t(work_words) * sizeof(uint64_t) * nr_dpus);
+  if (jobs.empty() || out.empty() || work.empty()) {
+    pim.deallocate(jobs);
+    pim.deallocate(out);
+    pim.deallocate(work);
+    return false;
+  }
+
+  struct pim_meta meta;
+  meta.opcode = OP_BLIND_ROTATE;
+  meta.args.boot.mod = key.modulus;
+  meta.args.boot.mu = pim_barrett_mu(key.modulus);
+  meta.args.boot.n = key.n;
+  meta.args.boot.N = N;
+  meta.args.boot.digits = key.digits;
+  meta.args.boot.g_bits = key.g_bits;
+  meta.args.boot.key = key_addr;
+  meta.args.boot.per_block = key.per_block();
+  meta.args.boot.ntt = pim.ntt_tables(key.modulus, N, key.ntt);
+  meta.args.boot.jobs = jobs[0].second;
+  meta.args.boot.out = out[0].second;
+  meta.args.boot.work = work[0].second;
+
+  // One bootstrap per DPU, the DPUs left over in the last round get an
+  // invalid job
+  std::vector<std::vector<uint64_t>> job_bufs(
+      nr_dpus, std::vector<uint64_t>(job_words));
+  std::vector<std::vector<uint64_t>> out_bufs(
+      nr_dpus, std::vector<uint64_t>(out_words));
+  std::vector<const void *> to(nr_dpus);
+  std::vector<void *> from(nr_dpus);
+  outputs.resize(inputs.size());
+  for (size_t first = 0; first < inputs.size(); first += nr_dpus) {
+    for (uint32_t d = 0; d < nr_dpus; ++d) {
+      auto *job = reinterpret_cast<struct pim_gate *>(job_bufs[d].data());
+      job->valid = first + d < inputs.size();
+      if (job->valid) {
+        const PimGateInput &in = inputs[first + d];
+        job->b = in.b;
+        job->q = in.q;
+        job->q1 = in.q1;
+        job->q2 = in.q2;
+        job->q2p = in.q2p;
+        std::copy(in.index.begin(), in.index.end(),
+                  reinterpret_cast<uint32_t *>(job + 1));
+      }
+      to[d] = job_bufs[d].data();
+      from[d] = job->valid ? out_bufs[d].data() : nullptr;
+    }
+    pim.scatter_to_pim(to, job_words * sizeof(uint64_t), jobs[0].second);
+    pim.launch(meta);
+    pim.gather_from_pim(from, out_words * sizeof(uint64_t), out[0].second);
+    for (uint32_t d = 0; d < nr_dpus && first + d < inputs.size(); ++d) {
+      PimGateOutput &res = outputs[first + d];
+      res.a.assign(out_bufs[d].begin(), out_bufs[d].begin() + N);
+      res.b = out_bufs[d][N];
+    }
+  }
+
+  pim.deallocate(jobs);
+  pim.deallocate(out);
+  pim.deallocate(work);
+  return true;
+}
@@ -0,0 +1,136 @@
+#include "pim/PimKeyCache.h"
+#include <stdexcept>
+
+void PimKeyCache::Lease::drop() {
+  if (cache == nullptr)
+    return;
+  std::lock_guard<std::mutex> guard(cache->lock);
+  auto it = cache->entries.find(key);
+  if (it != cache->entries.end() && it->second.leases > 0)
+    it->second.leases--;
+  cache = nullptr;
+}
+
+PimKeyCache::Lease
+PimKeyCache::acquire(const std::shared_ptr<const void> &owner,
+                     const std::string &tag, uint32_t index, size_t bytes,
+                     const std::function<void()> &pin,
+                     std::function<void()> unpin) {
+  std::unique_lock<std::mutex> guard(lock);
+  Key key{tag, index};
+  clock++;
+
+  auto it = entries.find(key);
+  // Another acquirer is uploading the key, it is ready or gone afterwards
+  while (it != entries.end() && !it->second.ready) {
+    uploaded.wait(guard);
+    it = entries.find(key);
+  }
+  if (it != entries.end()) {
+    Entry &entry = it->second;
+    if (entry.id == owner.get() && !entry.owner.expired()) {
+      stats.hits++;
+      entry.uses++;
+      entry.last = clock;
+      entry.leases++;
+      return Lease(this, key);
+    }
+    // The key was regenerated, the old one goes unless a switch still uses it
+    if (entry.leases > 0) {
+      stats.misses++;
+      return Lease();
+    }
+    evict(it);
+  }
+
+  stats.misses++;
+  if (!make_room(bytes))
+    return Lease();
+  // The entry is reserved, with its room and a lease, while the key crosses
+  // the bus without the lock
+  entries[key] = Entry{owner, owner.get(), bytes, 1, clock, 1, false, unpin};
+  stats.bytes += bytes;
+  stats.entries++;
+  guard.unlock();
+  try {
+    pin();
+  } catch (const std::runtime_error &) {
+    // The MRAM is taken by other data, what was pinned goes back
+    unpin();
+    guard.lock();
+    cancel(key);
+    return Lease();
+  } catch (...) {
+    guard.lock();
+    cancel(key);
+    throw;
+  }
+  guard.lock();
+  entries.find(key)->second.ready = true;
+  uploaded.notify_all();
+  return Lease(this, key);
+}
+
+void PimKeyCache::set_capacity(size_t bytes) {
+  std::lock_guard<std::mutex> guard(lock);
+  capacity = bytes;
+  make_room(0);
+}
+
+void PimKeyCache::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+  for (auto it = entries.begin(); it != entries.end();) {
+    auto next = std::next(it);
+    if (it->second.leases == 0)
+      evict(it);
+    it = next;
+  }
+}
+
+PimKeyCacheStats PimKeyCache::get_stats() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return stats;
+}
+
+void PimKeyCache::evict(std::map<Key, Entry>::iterator it) {
+  // A key whose owner is gone released its MRAM with it
+  if (!it->second.owner.expired())
+    it->second.unpin();
+  stats.bytes -= it->second.bytes;
+  stats.entries--;
+  stats.evictions++;
+  entries.erase(it);
+}
+
+void PimKeyCache::cancel(const Key &key) {
+  auto it = entries.find(key);
+  stats.bytes -= it->second.bytes;
+  stats.entries--;
+  entries.erase(it);
+  uploaded.notify_all();
+}
+
+bool PimKeyCache::make_room(size_t bytes) {
+  if (bytes > capacity)
+    return false;
+  while (stats.bytes + bytes > capacity) {
+    auto victim = entries.end();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      const Entry &entry = it->second;
+      if (entry.leases > 0)
+        continue;
+      if (entry.owner.expired()) {
+        victim = it;
+        break;
+      }
+      if (victim == entries.end() || entry.uses < victim->second.uses ||
+          (entry.uses == victim->second.uses &&
+           entry.last < victim->second.last))
+        victim = it;
+    }
+    if (victim == entries.end())
+      return false;
+    evict(victim);
+  }
+  return true;
+}
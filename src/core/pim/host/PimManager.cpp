@@ -1,97 +1,583 @@
 #include "pim/PimManager.h"
 #include "pim/kernel.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 void PimManager::copy_to_pim(void *buf, uint32_t size, uint32_t offset,
                              uint8_t type, const std::string &memory) {
-  struct dpu_set_t dpu;
-  uint32_t each_dpu = 0;
-  uint32_t size_pr_dpu = 0;
-  uint32_t size_pr_dpu_bytes = 0;
-  uint64_t *uintPtr = static_cast<uint64_t *>(buf);
+  push_to_pim(buf, size, offset, type, memory).wait();
+}
+
+PimEvent PimManager::copy_to_pim_async(void *buf, uint32_t size,
+                                       uint32_t offset, uint8_t type,
+                                       const std::string &memory) {
+  return push_to_pim(buf, size, offset, type, memory);
+}
+
+// Buffers of the slices of size words of buf over nr_dpus DPUs. The slices
+// lying whole in an 8-byte aligned buf point into it; the other ones point
+// into staging, which gets slice words per staged DPU, listed in staged.
+static std::vector<void *> split(uint64_t *buf, uint32_t size,
+                                 uint32_t nr_dpus, uint32_t slice,
+                                 std::vector<uint64_t> &staging,
+                                 std::vector<uint32_t> &staged) {
+  bool aligned = reinterpret_cast<uintptr_t>(buf) % sizeof(uint64_t) == 0;
+  std::vector<void *> bufs(nr_dpus);
+  for (uint32_t d = 0; d < nr_dpus; ++d)
+    if (!aligned || size_t(d + 1) * slice > size)
+      staged.push_back(d);
+  staging.assign(staged.size() * size_t(slice), 0);
+  for (uint32_t d = 0, s = 0; d < nr_dpus; ++d) {
+    if (s < staged.size() && staged[s] == d)
+      bufs[d] = &staging[size_t(s++) * slice];
+    else
+      bufs[d] = &buf[size_t(d) * slice];
+  }
+  return bufs;
+}
+
+// Words of the slice of DPU d held in a vector of size words
+static uint32_t slice_used(uint32_t d, uint32_t slice, uint32_t size) {
+  size_t first = size_t(d) * slice;
+  return first >= size ? 0 : std::min<size_t>(slice, size - first);
+}
 
+PimEvent PimManager::push_to_pim(void *buf, uint32_t size, uint32_t offset,
+                                 uint8_t type, const std::string &memory) {
   switch (type) {
-  case 0:
-    // Here i would need to div and round up and append zeros to the end of the
-    // array
-    size_pr_dpu = DIV(size, nr_dpus);
-    size_pr_dpu_bytes = size_pr_dpu * sizeof(uint64_t);
-
-    DPU_FOREACH(set, dpu, each_dpu) {
-      DPU_ASSERT(dpu_prepare_xfer(dpu, &uintPtr[each_dpu * size_pr_dpu]));
-    }
-    DPU_ASSERT(dpu_push_xfer(set, DPU_XFER_TO_DPU, memory.c_str(), offset,
-                             size_pr_dpu_bytes, DPU_XFER_DEFAULT));
-    break;
+  case 0: {
+    uint32_t slice = slice_words(size);
+    if (slice == 0)
+      return PimEvent();
+    uint64_t *words = static_cast<uint64_t *>(buf);
+    auto staging = std::make_shared<std::vector<uint64_t>>();
+    std::vector<uint32_t> staged;
+    std::vector<void *> bufs =
+        split(words, size, nr_dpus, slice, *staging, staged);
+    for (size_t s = 0; s < staged.size(); ++s)
+      if (uint32_t used = slice_used(staged[s], slice, size))
+        std::memcpy(&(*staging)[s * slice], words + size_t(staged[s]) * slice,
+                    used * sizeof(uint64_t));
 
-  case 1:
-    // std::cout<< memory << size<<std::endl;
-    DPU_ASSERT(
-        dpu_broadcast_to(set, memory.c_str(), 0, buf, size, DPU_XFER_DEFAULT));
-    break;
+    std::lock_guard<std::mutex> guard(submit_lock);
+    enqueue_xfer(bufs, true, slice * sizeof(uint64_t), offset, memory);
+    return enqueue_event(staging);
+  }
+
+  case 1: {
+    std::lock_guard<std::mutex> guard(submit_lock);
+    enqueue_broadcast(memory, 0, buf, size);
+    return enqueue_event();
+  }
 
   default:
     std::cout << "Not Available copy option" << std::endl;
-    break;
+    return PimEvent();
   }
 }
 
 uint32_t PimManager::copy_from_pim(uint64_t *buf, uint32_t size,
                                    uint32_t offset) {
-  struct dpu_set_t dpu;
-  uint32_t each_dpu = 0;
-  uint32_t size_pr_dpu = 0;
-  uint32_t size_pr_dpu_bytes = 0;
-  size_pr_dpu = DIV(size, nr_dpus);
-  size_pr_dpu_bytes = size_pr_dpu * sizeof(uint64_t);
-
-  DPU_FOREACH(set, dpu, each_dpu) {
-    DPU_ASSERT(dpu_prepare_xfer(dpu, &buf[each_dpu * size_pr_dpu]));
-  }
-  DPU_ASSERT(dpu_push_xfer(set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME,
-                           offset, size_pr_dpu_bytes, DPU_XFER_DEFAULT));
+  pull_from_pim(buf, size, offset).wait();
   return 0;
 }
 
-std::vector<std::pair<size_t, uint32_t>> PimManager::allocate(size_t size) {
-  std::vector<std::pair<size_t, uint32_t>> allocated_addrs;
-  size_t size_per_chunk =
-      DIVROUNDUP(size, PimManager::nr_dpus); // Round up to split evenly
-
-  for (size_t i = 0; i < chunks.size(); ++i) {
-    int32_t addr = chunks[i]->allocate(size_per_chunk);
-    if (addr != -1) {
-      allocated_addrs.push_back({i, addr});
-      size -= size_per_chunk;
-      if (size <= 0)
-        break;
+PimEvent PimManager::copy_from_pim_async(uint64_t *buf, uint32_t size,
+                                         uint32_t offset) {
+  return pull_from_pim(buf, size, offset);
+}
+
+PimEvent PimManager::pull_from_pim(uint64_t *buf, uint32_t size,
+                                   uint32_t offset) {
+  uint32_t slice = slice_words(size);
+  if (slice == 0)
+    return PimEvent();
+  auto staging = std::make_shared<std::vector<uint64_t>>();
+  std::vector<uint32_t> staged;
+  std::vector<void *> bufs = split(buf, size, nr_dpus, slice, *staging, staged);
+
+  std::lock_guard<std::mutex> guard(submit_lock);
+  enqueue_xfer(bufs, false, slice * sizeof(uint64_t), offset,
+               DPU_MRAM_HEAP_POINTER_NAME);
+  // The staged slices are copied out once read, before the event completes
+  if (!staged.empty())
+    backend->callback([buf, size, slice, staging, staged]() {
+      for (size_t s = 0; s < staged.size(); ++s)
+        if (uint32_t used = slice_used(staged[s], slice, size))
+          std::memcpy(buf + size_t(staged[s]) * slice, &(*staging)[s * slice],
+                      used * sizeof(uint64_t));
+    });
+  return enqueue_event(staging);
+}
+
+// The backends only read the buffers of a transfer to the DPUs
+static std::vector<void *> to_raw(const std::vector<const void *> &bufs) {
+  std::vector<void *> raw(bufs.size());
+  for (size_t i = 0; i < bufs.size(); ++i)
+    raw[i] = const_cast<void *>(bufs[i]);
+  return raw;
+}
+
+void PimManager::scatter_to_pim(const std::vector<const void *> &bufs,
+                                uint32_t bytes, uint32_t offset,
+                                const std::string &memory) {
+  xfer_prepared(to_raw(bufs), true, bytes, offset, memory).wait();
+}
+
+void PimManager::gather_from_pim(const std::vector<void *> &bufs,
+                                 uint32_t bytes, uint32_t offset,
+                                 const std::string &memory) {
+  xfer_prepared(bufs, false, bytes, offset, memory).wait();
+}
+
+PimEvent PimManager::scatter_to_pim_async(const std::vector<const void *> &bufs,
+                                          uint32_t bytes, uint32_t offset,
+                                          const std::string &memory) {
+  return xfer_prepared(to_raw(bufs), true, bytes, offset, memory);
+}
+
+PimEvent PimManager::gather_from_pim_async(const std::vector<void *> &bufs,
+                                           uint32_t bytes, uint32_t offset,
+                                           const std::string &memory) {
+  return xfer_prepared(bufs, false, bytes, offset, memory);
+}
+
+PimEvent PimManager::xfer_prepared(const std::vector<void *> &bufs,
+                                   bool to_pim, uint32_t bytes,
+                                   uint32_t offset,
+                                   const std::string &memory) {
+  std::lock_guard<std::mutex> guard(submit_lock);
+  enqueue_xfer(bufs, to_pim, bytes, offset, memory);
+  return enqueue_event();
+}
+
+void PimManager::enqueue_xfer(const std::vector<void *> &bufs, bool to_pim,
+                              uint32_t bytes, uint32_t offset,
+                              const std::string &memory) {
+  uint32_t active = 0;
+  for (uint32_t i = 0; i < bufs.size() && i < nr_dpus; ++i)
+    active += bufs[i] != nullptr;
+
+  auto submitted = std::chrono::steady_clock::now();
+  backend->xfer(bufs, to_pim, memory, offset, bytes, true);
+  {
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    if (to_pim) {
+      counters.xfers_to_pim++;
+      counters.bytes_to_pim += uint64_t(bytes) * active;
     } else {
-      std::cerr << "Allocation failed in one of the chunks.\n";
-      deallocate(allocated_addrs); // Rollback allocation if any chunk fails
-      return {};
+      counters.xfers_from_pim++;
+      counters.bytes_from_pim += uint64_t(bytes) * active;
     }
   }
+  time_op(to_pim ? &PimCounters::to_pim_ns : &PimCounters::from_pim_ns,
+          submitted);
+}
 
-  if (size > 0) {
-    std::cerr << "Insufficient memory across all chunks.\n";
-    deallocate(allocated_addrs); // Rollback allocation if not enough memory
-    return {};
+void PimManager::enqueue_broadcast(const std::string &memory, uint32_t offset,
+                                   const void *buf, uint32_t bytes) {
+  auto submitted = std::chrono::steady_clock::now();
+  backend->broadcast(memory, offset, buf, bytes, true);
+  {
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters.xfers_to_pim++;
+    counters.bytes_to_pim += uint64_t(bytes) * nr_dpus;
+  }
+  time_op(&PimCounters::to_pim_ns, submitted);
+}
+
+void PimManager::enqueue_launch() {
+  auto submitted = std::chrono::steady_clock::now();
+  backend->launch(true);
+  {
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters.launches++;
+  }
+  time_op(&PimCounters::launch_ns, submitted);
+}
+
+void PimManager::upload(uint32_t addr,
+                        std::shared_ptr<const std::vector<uint64_t>> image) {
+  std::lock_guard<std::mutex> guard(submit_lock);
+  enqueue_broadcast(DPU_MRAM_HEAP_POINTER_NAME, addr, image->data(),
+                    image->size() * sizeof(uint64_t));
+  enqueue_event(std::move(image));
+}
+
+void PimManager::enqueue_towers(const std::vector<struct pim_tower> &info) {
+  bool same = info.size() == towers.size();
+  for (size_t i = 0; same && i < info.size(); ++i)
+    same = std::memcmp(&info[i], &towers[i], sizeof(struct pim_tower)) == 0;
+  if (same)
+    return;
+
+  // The queued transfer reads its own copy, towers changes with the next
+  // descriptions
+  auto copy = std::make_shared<const std::vector<struct pim_tower>>(info);
+  std::vector<void *> bufs(copy->size());
+  for (size_t i = 0; i < copy->size(); ++i)
+    bufs[i] = const_cast<struct pim_tower *>(&(*copy)[i]);
+  enqueue_xfer(bufs, true, sizeof(struct pim_tower), 0, "tower");
+  enqueue_event(copy);
+  towers = info;
+}
+
+uint32_t PimManager::ntt_tables(uint64_t modulus, uint32_t n,
+                                const PimNttTables &tables) {
+  std::lock_guard<std::mutex> guard(tables_lock);
+  auto key = std::make_pair(modulus, n);
+  auto it = twiddles.find(key);
+  if (it != twiddles.end())
+    return it->second;
+
+  // Layout of struct pim_ntt, a single broadcast for the whole set
+  auto image = std::make_shared<std::vector<uint64_t>>(4 * size_t(n) + 2);
+  std::copy(tables.root, tables.root + n, image->begin());
+  std::copy(tables.root_precon, tables.root_precon + n, image->begin() + n);
+  std::copy(tables.root_inv, tables.root_inv + n, image->begin() + 2 * n);
+  std::copy(tables.root_inv_precon, tables.root_inv_precon + n,
+            image->begin() + 3 * n);
+  (*image)[4 * n] = tables.n_inv;
+  (*image)[4 * n + 1] = tables.n_inv_precon;
+
+  int32_t addr = heap_allocate(image->size() * sizeof(uint64_t));
+  if (addr == -1)
+    throw std::runtime_error("PimManager: no MRAM left for the NTT tables");
+  // The kernels reading the tables are queued behind the broadcast, nothing
+  // has to wait for it
+  upload(addr, image);
+  twiddles[key] = addr;
+  return addr;
+}
+
+uint32_t PimManager::base_conv_tables(const PimBaseConvTables &tables) {
+  size_t size_q = tables.q.size();
+  size_t size_p = tables.p.size();
+
+  // Layout of struct pim_base_conv
+  std::vector<uint64_t> image;
+  image.reserve(3 * size_q + (size_q + 3) * size_p);
+  for (size_t i = 0; i < size_q; ++i) {
+    image.push_back(tables.q[i]);
+    image.push_back(tables.q_hat_inv[i]);
+    image.push_back(tables.q_hat_inv_precon[i]);
+  }
+  for (size_t j = 0; j < size_p; ++j) {
+    image.push_back(tables.p[j]);
+    image.push_back(uint64_t(tables.p_mu[j]));
+    image.push_back(uint64_t(tables.p_mu[j] >> 64));
+    for (size_t i = 0; i < size_q; ++i)
+      image.push_back(tables.q_hat_modp[i * size_p + j]);
+  }
+
+  std::lock_guard<std::mutex> guard(tables_lock);
+  auto it = conversions.find(image);
+  if (it != conversions.end())
+    return it->second;
+
+  int32_t addr = heap_allocate(image.size() * sizeof(uint64_t));
+  if (addr == -1)
+    throw std::runtime_error(
+        "PimManager: no MRAM left for the base conversion tables");
+  upload(addr, std::make_shared<const std::vector<uint64_t>>(image));
+  conversions[image] = addr;
+  return addr;
+}
+
+int32_t PimManager::automorphism_maps(uint32_t k, uint32_t n, uint32_t groups,
+                                      std::vector<uint32_t> &slices) {
+  std::lock_guard<std::mutex> guard(tables_lock);
+  auto key = std::make_tuple(k, n, groups);
+  auto it = automorphisms.find(key);
+  if (it != automorphisms.end()) {
+    slices = it->second.second;
+    return it->second.first;
+  }
+
+  // A failure is remembered as well, the maps are not cheap to build
+  auto maps = std::make_shared<std::vector<uint32_t>>();
+  int32_t addr = -1;
+  uint32_t len = n / groups;
+  if (n % groups == 0 && len % 2 == 0 &&
+      pim_automorphism_maps(k, n, groups, slices, *maps)) {
+    uint32_t bytes = len * sizeof(uint32_t);
+    addr = heap_allocate(bytes);
+    if (addr == -1)
+      throw std::runtime_error(
+          "PimManager: no MRAM left for the automorphism maps");
+    std::vector<void *> bufs(nr_dpus);
+    for (uint32_t d = 0; d < nr_dpus; ++d)
+      bufs[d] = maps->data() + size_t(d % groups) * len;
+    std::lock_guard<std::mutex> submit_guard(submit_lock);
+    enqueue_xfer(bufs, true, bytes, addr, DPU_MRAM_HEAP_POINTER_NAME);
+    enqueue_event(maps);
+  } else {
+    slices.clear();
+  }
+  automorphisms[key] = std::make_pair(addr, slices);
+  return addr;
+}
+
+int32_t PimManager::boot_key(const std::shared_ptr<const void> &owner,
+                             const PimBootKey &key) {
+  std::lock_guard<std::mutex> guard(tables_lock);
+  // The keys whose owner is gone give their MRAM back
+  for (auto it = boot_keys.begin(); it != boot_keys.end();) {
+    if (it->second.owner.expired()) {
+      for (uint32_t addr : it->second.addrs)
+        heap_deallocate(addr);
+      it = boot_keys.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto it = boot_keys.find(owner.get());
+  if (it != boot_keys.end())
+    return it->second.addrs[0];
+
+  // Layout of struct pim_blind_rotate: monomials, exponents, block offsets
+  uint32_t N = key.N;
+  uint32_t per_block = key.per_block();
+  uint32_t blocks = DIVROUNDUP(key.n, per_block);
+  auto image = std::make_shared<std::vector<uint64_t>>(
+      2 * size_t(N) + N / 2 + DIVROUNDUP(blocks, 2));
+  std::copy(key.monomials.begin(), key.monomials.end(), image->begin());
+  uint32_t *words = reinterpret_cast<uint32_t *>(image->data() + 2 * N);
+  std::copy(key.exponents.begin(), key.exponents.end(), words);
+
+  ResidentKey resident{owner, {}};
+  std::vector<uint32_t> sizes{uint32_t(image->size() * sizeof(uint64_t))};
+  for (uint32_t b = 0; b < blocks; ++b)
+    sizes.push_back(std::min(per_block, key.n - b * per_block) *
+                    key.row_bytes());
+  for (uint32_t bytes : sizes) {
+    int32_t addr = heap_allocate(bytes);
+    if (addr == -1) {
+      for (uint32_t done : resident.addrs)
+        heap_deallocate(done);
+      return -1;
+    }
+    resident.addrs.push_back(addr);
+  }
+  std::copy(resident.addrs.begin() + 1, resident.addrs.end(), words + N);
+  upload(resident.addrs[0], image);
+
+  // One broadcast per block, the rows of a block are built while the one
+  // before it is transferred
+  PimEvent previous;
+  for (uint32_t b = 1; b <= blocks; ++b) {
+    uint32_t first = (b - 1) * per_block;
+    auto rows = std::make_shared<std::vector<uint32_t>>(sizes[b] /
+                                                        sizeof(uint32_t));
+    for (uint32_t i = first; i < std::min(first + per_block, key.n); ++i)
+      key.rows(i, rows->data() + (i - first) * key.row_bytes() /
+                                     sizeof(uint32_t));
+    previous.wait();
+    std::lock_guard<std::mutex> submit_guard(submit_lock);
+    enqueue_broadcast(DPU_MRAM_HEAP_POINTER_NAME, resident.addrs[b],
+                      rows->data(), sizes[b]);
+    previous = enqueue_event(rows);
+  }
+  int32_t addr = resident.addrs[0];
+  boot_keys[owner.get()] = std::move(resident);
+  return addr;
+}
+
+PimEvent PimManager::launch_async(const struct pim_meta &meta,
+                                  const std::vector<struct pim_tower> *towers) {
+  // The broadcast reads the header when the rank gets to it, so the queued
+  // copy is kept alive by the event
+  auto header = std::make_shared<struct pim_meta>(meta);
+  header->described = towers != nullptr;
+  std::lock_guard<std::mutex> guard(submit_lock);
+  if (towers != nullptr)
+    enqueue_towers(*towers);
+  enqueue_broadcast("meta", 0, header.get(), sizeof(meta));
+  enqueue_launch();
+  return enqueue_event(header);
+}
+
+PimEvent PimManager::record_event(std::shared_ptr<const void> keep_alive) {
+  std::lock_guard<std::mutex> guard(submit_lock);
+  return enqueue_event(std::move(keep_alive));
+}
+
+PimEvent PimManager::enqueue_event(std::shared_ptr<const void> keep_alive) {
+  auto state = std::make_shared<PimEvent::State>();
+  state->keep_alive = std::move(keep_alive);
+  PimEvent event(state);
+
+  // Called once for the whole set, after all DPUs went through the
+  // operations queued before it
+  backend->callback([event]() { event.complete(); });
+  return event;
+}
+
+void PimManager::time_op(uint64_t PimCounters::*field,
+                         std::chrono::steady_clock::time_point submitted) {
+  if (!timing)
+    return;
+  backend->callback([this, field, submitted]() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters.*field += elapsed_ns(std::max(submitted, last_done), now);
+    last_done = now;
+  });
+}
+
+PimStats PimManager::get_stats() {
+  std::vector<struct pim_stats> dpus(nr_dpus);
+  std::vector<void *> bufs(nr_dpus);
+  for (uint32_t i = 0; i < nr_dpus; ++i)
+    bufs[i] = &dpus[i];
+  PimEvent read;
+  {
+    // Straight to the backend, reading the telemetry is not a transfer of
+    // the application
+    std::lock_guard<std::mutex> guard(submit_lock);
+    backend->xfer(bufs, false, "stats", 0, sizeof(struct pim_stats), true);
+    read = enqueue_event();
   }
+  read.wait();
 
-  allocations[allocated_addrs[0]] = allocated_addrs;
+  PimStats stats;
+  stats.backend = backend->name();
+  stats.nr_dpus = nr_dpus;
+  stats.counters = get_counters();
+  {
+    std::lock_guard<std::mutex> heap_guard(heap_lock);
+    stats.mram_in_use = heap.bytes_in_use();
+  }
+  for (int op = 0; op < PIM_OPCODES; ++op) {
+    PimKernelStats &k = stats.kernels[op];
+    for (const struct pim_stats &dpu : dpus) {
+      // Every DPU of the set runs every launch
+      k.launches = std::max(k.launches, dpu.launches[op]);
+      k.max_cycles = std::max(k.max_cycles, dpu.cycles[op]);
+      k.total_cycles += dpu.cycles[op];
+    }
+  }
+  return stats;
+}
+
+void PimManager::reset_stats() {
+  struct pim_stats zero = {};
+  PimEvent cleared;
+  {
+    std::lock_guard<std::mutex> guard(submit_lock);
+    backend->broadcast("stats", 0, &zero, sizeof(zero), true);
+    cleared = enqueue_event();
+  }
+  cleared.wait();
+  reset_counters();
+}
+
+int32_t PimManager::heap_allocate(size_t bytes) {
+  std::lock_guard<std::mutex> heap_guard(heap_lock);
+  return heap_take(bytes);
+}
+
+int32_t PimManager::heap_take(size_t bytes) {
+  int32_t addr = heap.allocate(bytes);
+  if (addr != -1) {
+    std::lock_guard<std::mutex> stats_guard(stats_lock);
+    counters.mram_high_water =
+        std::max<uint64_t>(counters.mram_high_water, heap.bytes_in_use());
+  }
+  return addr;
+}
+
+void PimManager::heap_deallocate(uint32_t addr) {
+  std::lock_guard<std::mutex> heap_guard(heap_lock);
+  heap.deallocate(addr);
+}
+
+std::vector<std::pair<size_t, uint32_t>> PimManager::allocate(size_t size) {
+  // Round up to split evenly, a single decision for the whole set. The MRAM
+  // transfers move whole 8-byte words.
+  size_t share = DIVROUNDUP(size, nr_dpus);
+  int32_t addr = heap_allocate(DIVROUNDUP(share, sizeof(uint64_t)) *
+                               sizeof(uint64_t));
+  if (addr == -1)
+    return {};
+
+  std::vector<std::pair<size_t, uint32_t>> allocated_addrs;
+  for (uint32_t i = 0; i < nr_dpus; ++i)
+    allocated_addrs.push_back({i, uint32_t(addr)});
   return allocated_addrs;
 }
 
 void PimManager::deallocate(
     const std::vector<std::pair<size_t, uint32_t>> &addrs) {
-  for (const auto &[chunk_index, addr] : addrs) {
-    chunks[chunk_index]->deallocate(addr);
+  if (!addrs.empty())
+    heap_deallocate(addrs[0].second);
+}
+
+// Size of the heap block holding bytes, the allocations of allocate_on of the
+// same block size share their blocks
+static size_t block_of(size_t bytes) {
+  size_t block = BLOCK_SIZE;
+  while (block < bytes)
+    block *= 2;
+  return block;
+}
+
+int32_t PimManager::allocate_on(uint32_t dpu, size_t size) {
+  if (dpu >= nr_dpus)
+    return -1;
+  size_t bytes = block_of(DIVROUNDUP(size, sizeof(uint64_t)) * sizeof(uint64_t));
+  std::lock_guard<std::mutex> heap_guard(heap_lock);
+  std::set<uint32_t> &slots = free_slots[dpu][bytes];
+  int32_t addr;
+  if (!slots.empty()) {
+    addr = *slots.begin();
+    slots.erase(slots.begin());
+    shared[addr].count++;
+  } else {
+    addr = heap_take(bytes);
+    if (addr == -1)
+      return -1;
+    shared[addr] = {bytes, 1};
+    for (uint32_t d = 0; d < nr_dpus; ++d)
+      if (d != dpu)
+        free_slots[d][bytes].insert(addr);
   }
-  if (!addrs.empty() && allocations.find(addrs[0]) != allocations.end()) {
-    allocations.erase(addrs[0]);
+  add_load(dpu, bytes, true);
+  return addr;
+}
+
+bool PimManager::deallocate_on(uint32_t dpu, uint32_t addr) {
+  std::lock_guard<std::mutex> heap_guard(heap_lock);
+  auto it = shared.find(addr);
+  if (dpu >= nr_dpus || it == shared.end())
+    return false;
+  size_t bytes = it->second.bytes;
+  // A free slot of dpu is not an allocation of it
+  if (!free_slots[dpu][bytes].insert(addr).second)
+    return false;
+  add_load(dpu, bytes, false);
+  if (--it->second.count == 0) {
+    for (uint32_t d = 0; d < nr_dpus; ++d)
+      free_slots[d][bytes].erase(addr);
+    heap.deallocate(addr);
+    shared.erase(it);
   }
+  return true;
 }
 
+void PimManager::add_load(uint32_t dpu, size_t bytes, bool taken) {
+  by_load.erase({loads[dpu], dpu});
+  loads[dpu] = taken ? loads[dpu] + bytes : loads[dpu] - bytes;
+  by_load.insert({loads[dpu], dpu});
+}
+
+uint32_t PimManager::least_loaded() const {
+  std::lock_guard<std::mutex> heap_guard(heap_lock);
+  return by_load.begin()->second;
+}
 
-PimManager *PimManager::pim = nullptr;
-std::mutex PimManager::mutex_;
\ No newline at end of file
+std::atomic<PimManager *> PimManager::pim{nullptr};
+std::mutex PimManager::mutex_;
+thread_local PimManager *PimManager::bound = nullptr;
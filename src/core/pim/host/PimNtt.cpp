@@ -0,0 +1,97 @@
+#include "pim/PimNtt.h"
+
+// Shoup multiplication by a constant with its precomputation, a < modulus
+static inline uint64_t mul_shoup(uint64_t a, uint64_t w, uint64_t w_precon,
+                                 uint64_t modulus) {
+  uint64_t q = uint64_t((unsigned __int128)a * w_precon >> 64);
+  uint64_t r = a * w - q * modulus;
+  return r >= modulus ? r - modulus : r;
+}
+
+void pim_ntt_forward_cross_stages(uint64_t *data, uint32_t n, uint32_t groups,
+                                  uint64_t modulus,
+                                  const PimNttTables &tables) {
+  for (uint32_t m = 1, t = n >> 1; m < groups; m <<= 1, t >>= 1) {
+    for (uint32_t i = 0; i < m; ++i) {
+      uint64_t w = tables.root[i + m];
+      uint64_t w_precon = tables.root_precon[i + m];
+      uint64_t *lo = data + 2 * i * t;
+      for (uint32_t j = 0; j < t; ++j) {
+        uint64_t omega_factor = mul_shoup(lo[j + t], w, w_precon, modulus);
+        uint64_t lo_val = lo[j];
+        uint64_t hi_val = lo_val + omega_factor;
+        if (hi_val >= modulus)
+          hi_val -= modulus;
+        if (lo_val < omega_factor)
+          lo_val += modulus;
+        lo[j] = hi_val;
+        lo[j + t] = lo_val - omega_factor;
+      }
+    }
+  }
+}
+
+void pim_ntt_inverse_cross_stages(uint64_t *data, uint32_t n, uint32_t groups,
+                                  uint64_t modulus,
+                                  const PimNttTables &tables) {
+  for (uint32_t m = groups >> 1, t = n / groups; m >= 1; m >>= 1, t <<= 1) {
+    for (uint32_t i = 0; i < m; ++i) {
+      uint64_t w = tables.root_inv[i + m];
+      uint64_t w_precon = tables.root_inv_precon[i + m];
+      uint64_t *lo = data + 2 * i * t;
+      for (uint32_t j = 0; j < t; ++j) {
+        uint64_t lo_val = lo[j];
+        uint64_t hi_val = lo[j + t];
+        uint64_t omega_factor = lo_val;
+        if (omega_factor < hi_val)
+          omega_factor += modulus;
+        omega_factor -= hi_val;
+        lo_val += hi_val;
+        if (lo_val >= modulus)
+          lo_val -= modulus;
+        lo[j] = lo_val;
+        lo[j + t] = mul_shoup(omega_factor, w, w_precon, modulus);
+      }
+    }
+  }
+}
+
+static inline uint32_t reverse_bits(uint32_t x, uint32_t bits) {
+  uint32_t r = 0;
+  for (uint32_t b = 0; b < bits; ++b, x >>= 1)
+    r = (r << 1) | (x & 1);
+  return r;
+}
+
+bool pim_automorphism_maps(uint32_t k, uint32_t n, uint32_t groups,
+                           std::vector<uint32_t> &slices,
+                           std::vector<uint32_t> &maps) {
+  uint32_t logn = 0;
+  while ((1u << logn) < n)
+    ++logn;
+  uint32_t len = n / groups;
+  uint32_t mask = 2 * n - 1;
+
+  // Word jrev of the result is word idxrev of the input
+  std::vector<uint32_t> source(n);
+  for (uint32_t j = 0; j < n; ++j) {
+    uint32_t idx = (((2 * j + 1) * k) & mask) >> 1;
+    source[reverse_bits(j, logn)] = reverse_bits(idx, logn);
+  }
+
+  slices.assign(groups, groups);
+  maps.assign(n, 0);
+  for (uint32_t d = 0; d < groups; ++d) {
+    uint32_t s = source[d * len] / len;
+    if (slices[s] != groups)
+      return false;
+    slices[s] = d;
+    for (uint32_t j = 0; j < len; ++j) {
+      uint32_t i = source[d * len + j];
+      if (i / len != s)
+        return false;
+      maps[s * len + j] = i % len;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,223 @@
+#include "pim/PimPlanner.h"
+#include "pim/PimData.h"
+#include "pim/PimModArith.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+// Words of the calibration buffers, held whole by one DPU
+#define CALIBRATION_WORDS (8 * 1024)
+
+PimPlanner &PimPlanner::get() {
+  static PimPlanner planner;
+  return planner;
+}
+
+PimPlanner::PimPlanner() {
+  const char *env = std::getenv("PIM_OFFLOAD_PLANNER");
+  if (env != nullptr && std::string(env) == "1")
+    enable(true);
+}
+
+std::string PimPlanner::calibration_path() {
+  const char *env = std::getenv("PIM_CALIBRATION");
+  if (env != nullptr)
+    return env;
+  const char *home = std::getenv("HOME");
+  return home != nullptr ? std::string(home) + "/.openfhe-pim-calibration"
+                         : "";
+}
+
+void PimPlanner::enable(bool enable) {
+  if (enable) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (calibration.nr_dpus == 0) {
+      PimManager *pim = PimManager::current();
+      std::string path = calibration_path();
+      PimCalibration saved;
+      if (saved.load(path) && saved.backend == pim->get_backend_name() &&
+          saved.nr_dpus == pim->getNumDpus()) {
+        calibration = saved;
+      } else {
+        measure();
+        calibration.save(path);
+      }
+    }
+  }
+  on = enable;
+}
+
+bool PimPlanner::offload(enum pim_op_class op, uint32_t words,
+                         uint32_t towers, uint32_t to_push,
+                         uint32_t to_pull) const {
+  const PimCalibration &c = calibration;
+  if (c.nr_dpus == 0)
+    return false;
+  // The vector is held whole by one DPU, which goes through all of it
+  double bytes = double(words) * sizeof(uint64_t);
+  double host = words * c.host_word_ns[op] +
+                to_pull * (c.from_pim_ns + bytes * c.from_pim_byte_ns);
+  double pim = c.launch_ns + words * c.pim_word_ns[op] +
+               to_push * (c.to_pim_ns + bytes * c.to_pim_byte_ns);
+  return pim * std::max(towers, 1u) < host;
+}
+
+void PimPlanner::calibrate() {
+  std::lock_guard<std::mutex> guard(lock);
+  measure();
+  calibration.save(calibration_path());
+}
+
+// Best of a few runs of fn, in nanoseconds
+template <typename Fn> static double best_ns(Fn fn) {
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+// Barrett product of NativeIntegerT::ModMulFastEq, the host side of the
+// vector ModMul kernel
+static inline uint64_t host_mod_mul(uint64_t a, uint64_t b, uint64_t modulus,
+                                    uint64_t mu, unsigned n) {
+  unsigned __int128 prod = (unsigned __int128)a * b;
+  unsigned __int128 quot = (prod >> n) * mu;
+  uint64_t r = uint64_t(prod - (unsigned __int128)modulus * (quot >> (n + 7)));
+  return r >= modulus ? r - modulus : r;
+}
+
+void PimPlanner::measure() {
+  PimManager *pim = PimManager::current();
+  PimCalibration c;
+  c.backend = pim->get_backend_name();
+  c.nr_dpus = pim->getNumDpus();
+
+  const uint64_t q = 1152921504606846577ULL; // 60-bit NTT friendly prime
+  const uint64_t mu = pim_barrett_mu(q);
+  const unsigned n = 64 - __builtin_clzll(q) - 2;
+  const uint32_t words = CALIBRATION_WORDS;
+  std::vector<uint64_t> a(words), b(words), word(1);
+  uint64_t seed = 1;
+  for (uint32_t i = 0; i < words; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    a[i] = (seed >> 4) % q;
+    b[i] = (seed >> 3) % q;
+  }
+
+  // A single word gives the latency of a transfer, the full buffers the cost
+  // of the bytes on top of it. The operands of the kernels share a DPU, as
+  // the towers of a polynomial do.
+  PimData small(1, PimLayout::WHOLE), x(words, PimLayout::WHOLE),
+      y(words, PimLayout::WHOLE);
+  small.materialize(pim);
+  x.materialize(pim);
+  y.place_near(x);
+  double bytes = double(words - 1) * sizeof(uint64_t);
+  c.to_pim_ns = best_ns([&] {
+    small.host_modified();
+    small.to_pim(word.data());
+  });
+  c.to_pim_byte_ns = std::max(0.0, best_ns([&] {
+                                     x.host_modified();
+                                     x.to_pim(a.data());
+                                   }) - c.to_pim_ns) /
+                     bytes;
+  c.from_pim_ns = best_ns([&] {
+    small.pim_modified();
+    small.to_host(word.data());
+  });
+  c.from_pim_byte_ns = std::max(0.0, best_ns([&] {
+                                       x.pim_modified();
+                                       x.to_host(a.data());
+                                     }) - c.from_pim_ns) /
+                       bytes;
+
+  // The kernels on a single word are all launch
+  y.to_pim(b.data());
+  c.launch_ns = best_ns([&] {
+    small.ModAddEq(small, q);
+    pim->sync();
+  });
+  c.pim_word_ns[PIM_OP_ADD_SUB] = std::max(0.0, best_ns([&] {
+                                                  x.ModAddEq(y, q);
+                                                  pim->sync();
+                                                }) - c.launch_ns) /
+                                  words;
+  c.pim_word_ns[PIM_OP_MULT] = std::max(0.0, best_ns([&] {
+                                               x.ModMulEq(y, q);
+                                               pim->sync();
+                                             }) - c.launch_ns) /
+                               words;
+
+  volatile uint64_t sink = 0;
+  c.host_word_ns[PIM_OP_ADD_SUB] = best_ns([&] {
+                                     for (uint32_t i = 0; i < words; ++i) {
+                                       uint64_t r = a[i] + b[i];
+                                       a[i] = r >= q ? r - q : r;
+                                     }
+                                     sink = a[words / 2];
+                                   }) /
+                                   words;
+  c.host_word_ns[PIM_OP_MULT] = best_ns([&] {
+                                  for (uint32_t i = 0; i < words; ++i)
+                                    a[i] = host_mod_mul(a[i], b[i], q, mu, n);
+                                  sink = a[words / 2];
+                                }) /
+                                words;
+  calibration = c;
+}
+
+bool PimCalibration::load(const std::string &path) {
+  std::ifstream in(path);
+  if (path.empty() || !in)
+    return false;
+  PimCalibration c;
+  std::string key;
+  while (in >> key) {
+    if (key == "backend")
+      in >> c.backend;
+    else if (key == "nr_dpus")
+      in >> c.nr_dpus;
+    else if (key == "host_word_ns")
+      in >> c.host_word_ns[PIM_OP_ADD_SUB] >> c.host_word_ns[PIM_OP_MULT];
+    else if (key == "pim_word_ns")
+      in >> c.pim_word_ns[PIM_OP_ADD_SUB] >> c.pim_word_ns[PIM_OP_MULT];
+    else if (key == "launch_ns")
+      in >> c.launch_ns;
+    else if (key == "to_pim_ns")
+      in >> c.to_pim_ns >> c.to_pim_byte_ns;
+    else if (key == "from_pim_ns")
+      in >> c.from_pim_ns >> c.from_pim_byte_ns;
+    else
+      return false;
+    if (!in)
+      return false;
+  }
+  *this = c;
+  return true;
+}
+
+bool PimCalibration::save(const std::string &path) const {
+  if (path.empty())
+    return false;
+  std::ofstream out(path);
+  out.precision(std::numeric_limits<double>::max_digits10);
+  out << "backend " << backend << "\n"
+      << "nr_dpus " << nr_dpus << "\n"
+      << "host_word_ns " << host_word_ns[PIM_OP_ADD_SUB] << " "
+      << host_word_ns[PIM_OP_MULT] << "\n"
+      << "pim_word_ns " << pim_word_ns[PIM_OP_ADD_SUB] << " "
+      << pim_word_ns[PIM_OP_MULT] << "\n"
+      << "launch_ns " << launch_ns << "\n"
+      << "to_pim_ns " << to_pim_ns << " " << to_pim_byte_ns << "\n"
+      << "from_pim_ns " << from_pim_ns << " " << from_pim_byte_ns << "\n";
+  return bool(out);
+}
@@ -0,0 +1,42 @@
+#include "pim/PimPool.h"
+
+PimPool &PimPool::get() {
+  static PimPool pool;
+  return pool;
+}
+
+PimLease PimPool::lease(uint32_t ranks, const std::string &profile) {
+  Partition partition{ranks, profile, nullptr};
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+      if (it->ranks == ranks && it->profile == profile) {
+        partition.manager = std::move(it->manager);
+        idle.erase(it);
+        break;
+      }
+    }
+  }
+  // Allocating and loading the ranks is slow, it is done outside the lock
+  if (partition.manager == nullptr)
+    partition.manager.reset(
+        new PimManager(PimBackend::create_ranks(ranks, profile)));
+
+  PimManager *manager = partition.manager.release();
+  return PimLease(manager, [this, ranks, profile](PimManager *released) {
+    release(Partition{ranks, profile, std::unique_ptr<PimManager>(released)});
+  });
+}
+
+size_t PimPool::idle_partitions() {
+  std::lock_guard<std::mutex> guard(lock);
+  return idle.size();
+}
+
+void PimPool::release(Partition partition) {
+  // The keys cached on the partition go back to the host with it
+  partition.manager->key_cache().clear();
+  partition.manager->reset_stats();
+  std::lock_guard<std::mutex> guard(lock);
+  idle.push_back(std::move(partition));
+}
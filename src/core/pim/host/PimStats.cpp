@@ -0,0 +1,60 @@
+#include "pim/PimStats.h"
+#include <sstream>
+
+const char *PimStats::kernel_name(enum pim_opcode opcode) {
+  switch (opcode) {
+  case OP_ELEM_MOD_ADD:
+    return "mod_add";
+  case OP_ELEM_MOD_SUB:
+    return "mod_sub";
+  case OP_ELEM_MOD_MULT:
+    return "mod_mult";
+  case OP_ELEM_MOD_OPS:
+    return "mod_ops";
+  case OP_MEM_COPY:
+    return "mem_copy";
+  case OP_NTT_FORWARD:
+    return "ntt_forward";
+  case OP_NTT_INVERSE:
+    return "ntt_inverse";
+  case OP_BASE_CONV:
+    return "base_conv";
+  case OP_AUTOMORPHISM:
+    return "automorphism";
+  case OP_BLIND_ROTATE:
+    return "blind_rotate";
+  case OP_MAC:
+    return "mac";
+  case OP_RESCALE:
+    return "rescale";
+  case OP_UNIFORM:
+    return "uniform";
+  case PIM_OPCODES:
+    break;
+  }
+  return "unknown";
+}
+
+std::string PimStats::to_json() const {
+  const PimCounters &c = counters;
+  std::ostringstream out;
+  // The backend names are plain identifiers, nothing to escape
+  out << "{\"backend\": \"" << backend << "\", \"nr_dpus\": " << nr_dpus
+      << ", \"loads\": " << c.loads << ", \"load_ns\": " << c.load_ns
+      << ", \"launches\": " << c.launches << ", \"launch_ns\": " << c.launch_ns
+      << ", \"to_pim\": {\"xfers\": " << c.xfers_to_pim
+      << ", \"bytes\": " << c.bytes_to_pim << ", \"ns\": " << c.to_pim_ns
+      << "}, \"from_pim\": {\"xfers\": " << c.xfers_from_pim
+      << ", \"bytes\": " << c.bytes_from_pim << ", \"ns\": " << c.from_pim_ns
+      << "}, \"mram\": {\"in_use\": " << mram_in_use
+      << ", \"high_water\": " << c.mram_high_water << "}, \"kernels\": {";
+  for (int op = 0; op < PIM_OPCODES; ++op) {
+    const PimKernelStats &k = kernels[op];
+    out << (op ? ", \"" : "\"") << kernel_name(static_cast<pim_opcode>(op))
+        << "\": {\"launches\": " << k.launches
+        << ", \"max_cycles\": " << k.max_cycles
+        << ", \"total_cycles\": " << k.total_cycles << "}";
+  }
+  out << "}}";
+  return out.str();
+}
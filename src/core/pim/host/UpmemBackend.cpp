@@ -0,0 +1,119 @@
+#include "pim/PimBackend.h"
+#include <stdexcept>
+
+#ifdef RUN_ON_DPU
+
+extern "C" {
+#include <assert.h>
+#include <dpu.h>
+#include <dpu_log.h>
+}
+
+/**
+ * Backend over the UPMEM runtime, the DPU set comes from dpu_alloc (or
+ * dpu_alloc_ranks for whole ranks) so the profile selects between the
+ * hardware and the UPMEM simulator.
+ */
+class UpmemBackend : public PimBackend {
+public:
+  UpmemBackend(uint32_t count, const std::string &profile, bool ranks) {
+    if (ranks) {
+      // Running out of ranks is expected with a pool, not a fatal error
+      if (dpu_alloc_ranks(count, profile.c_str(), &set) != DPU_OK)
+        throw std::runtime_error("PimBackend: cannot allocate " +
+                                 std::to_string(count) + " ranks");
+    } else {
+      DPU_ASSERT(dpu_alloc(count, profile.c_str(), &set));
+    }
+    DPU_ASSERT(dpu_get_nr_dpus(set, &nr_dpus));
+  }
+
+  ~UpmemBackend() override { DPU_ASSERT(dpu_free(set)); }
+
+  uint32_t get_nr_dpus() const override { return nr_dpus; }
+
+  std::string name() const override { return "upmem"; }
+
+  void load(const std::string &binary) override {
+    DPU_ASSERT(dpu_load(set, binary.c_str(), NULL));
+  }
+
+  void launch(bool async) override {
+    DPU_ASSERT(dpu_launch(set, async ? DPU_ASYNCHRONOUS : DPU_SYNCHRONOUS));
+  }
+
+  void xfer(const std::vector<void *> &bufs, bool to_pim,
+            const std::string &symbol, uint32_t offset, uint32_t bytes,
+            bool async) override {
+    struct dpu_set_t dpu;
+    uint32_t each_dpu = 0;
+
+    // DPUs without a prepared buffer are skipped by the runtime
+    DPU_FOREACH(set, dpu, each_dpu) {
+      if (each_dpu < bufs.size() && bufs[each_dpu] != nullptr)
+        DPU_ASSERT(dpu_prepare_xfer(dpu, bufs[each_dpu]));
+    }
+    DPU_ASSERT(dpu_push_xfer(set, to_pim ? DPU_XFER_TO_DPU : DPU_XFER_FROM_DPU,
+                             symbol.c_str(), offset, bytes,
+                             async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+  }
+
+  void broadcast(const std::string &symbol, uint32_t offset, const void *buf,
+                 uint32_t bytes, bool async) override {
+    DPU_ASSERT(dpu_broadcast_to(set, symbol.c_str(), offset, buf, bytes,
+                                async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+  }
+
+  void callback(std::function<void()> fn) override {
+    // Called once for the whole set, after all ranks went through the
+    // operations queued before it
+    DPU_ASSERT(dpu_callback(
+        set, &UpmemBackend::on_callback, new std::function<void()>(fn),
+        static_cast<dpu_callback_flags_t>(DPU_CALLBACK_ASYNC |
+                                          DPU_CALLBACK_SINGLE_CALL)));
+  }
+
+  void sync() override { DPU_ASSERT(dpu_sync(set)); }
+
+  void log(FILE *out) override {
+    struct dpu_set_t dpu;
+    DPU_FOREACH(set, dpu) { DPU_ASSERT(dpu_log_read(dpu, out)); }
+  }
+
+private:
+  static dpu_error_t on_callback(struct dpu_set_t set, uint32_t rank_id,
+                                 void *arg) {
+    auto *fn = static_cast<std::function<void()> *>(arg);
+    (*fn)();
+    delete fn;
+    return DPU_OK;
+  }
+
+  struct dpu_set_t set;
+  uint32_t nr_dpus = 0;
+};
+
+std::unique_ptr<PimBackend> make_upmem_backend(uint32_t nr_dpus,
+                                               const std::string &profile) {
+  return std::make_unique<UpmemBackend>(nr_dpus, profile, false);
+}
+
+std::unique_ptr<PimBackend> make_upmem_rank_backend(uint32_t nr_ranks,
+                                                    const std::string &profile) {
+  return std::make_unique<UpmemBackend>(nr_ranks, profile, true);
+}
+
+#else
+
+std::unique_ptr<PimBackend> make_upmem_backend(uint32_t nr_dpus,
+                                               const std::string &profile) {
+  throw std::runtime_error(
+      "PimBackend: built without the UPMEM SDK (RUN_ON_DPU)");
+}
+
+std::unique_ptr<PimBackend> make_upmem_rank_backend(uint32_t nr_ranks,
+                                                    const std::string &profile) {
+  return make_upmem_backend(nr_ranks, profile);
+}
+
+#endif
@@ -0,0 +1,1274 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This file contains google test code that exercises the PIM offload of NativeVector on the host-side DPU emulator
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include "gtest/gtest.h"
+
+#include "math/math-hal.h"
+#include "pim/DpuMemory.h"
+#include "pim/PimBlindRotate.h"
+#include "pim/PimData.h"
+#include "pim/PimPlanner.h"
+#include "pim/PimPool.h"
+#include "utils/utilities-int.h"
+
+using namespace lbcrypto;
+
+namespace {
+
+// The emulator runs the resident DPU kernels on the host, so the tests do not depend on the UPMEM SDK
+PimManager* EmulatedPim() {
+    setenv("PIM_BACKEND", "emulator", 0);
+    return PimManager::getPim(PIM_NR_DPUS);
+}
+
+NativeVector RandomVector(usint size, const NativeInteger& q, uint64_t seed) {
+    NativeVector v(size, q);
+    for (usint i = 0; i < size; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        v[i] = NativeInteger(seed >> 11).Mod(q);
+    }
+    return v;
+}
+
+}  // namespace
+
+TEST(UTPim, pinned_mod_add_sub_match_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    EmulatedPim();
+
+    const usint size = 1024;
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 1);
+    NativeVector b = RandomVector(size, q, 2);
+
+    NativeVector pinned(a);
+    pinned.PinToPim();
+    EXPECT_TRUE(pinned.IsPinned());
+
+    pinned.ModAddEq(b);
+    EXPECT_EQ(a.ModAdd(b), pinned) << "Failure in pinned ModAddEq";
+
+    pinned.ModSubEq(b);
+    EXPECT_EQ(a, pinned) << "Failure in pinned ModSubEq";
+
+    pinned.ModAddEq(NativeInteger(12345));
+    EXPECT_EQ(a.ModAdd(NativeInteger(12345)), pinned) << "Failure in pinned scalar ModAddEq";
+
+    pinned.UnpinFromPim();
+    EXPECT_FALSE(pinned.IsPinned());
+}
+
+TEST(UTPim, pinned_mod_mul_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    EmulatedPim();
+
+    const usint size = 1024;
+    // Barrett and Shoup constants of a 60-bit and of a narrow modulus
+    for (const char* modulus : {"1152921504606846577", "65537"}) {
+        NativeInteger q(modulus);
+        NativeVector a = RandomVector(size, q, 11);
+        NativeVector b = RandomVector(size, q, 12);
+        NativeInteger c(RandomVector(1, q, 13)[0]);
+
+        NativeVector pinned(a);
+        pinned.PinToPim();
+        EXPECT_EQ(a.ModMul(b), pinned.ModMul(b)) << "Failure in pinned ModMul, q = " << q;
+        EXPECT_EQ(a.ModMul(c), pinned.ModMul(c)) << "Failure in pinned scalar ModMul, q = " << q;
+
+        pinned.ModMulEq(b);
+        pinned.ModMulEq(c);
+        EXPECT_EQ(a.ModMul(b).ModMul(c), pinned) << "Failure in pinned ModMulEq, q = " << q;
+    }
+}
+
+TEST(UTPim, pinned_ops_stream_partial_tiles) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    EmulatedPim();
+
+    // Slices that leave a short last tile, and slices of fewer words than tasklets
+    NativeInteger q("1152921504606846577");
+    for (usint size : {200 * PIM_NR_DPUS, 3 * PIM_NR_DPUS}) {
+        NativeVector a = RandomVector(size, q, 21);
+        NativeVector b = RandomVector(size, q, 22);
+
+        NativeVector pinned(a);
+        pinned.PinToPim();
+        EXPECT_EQ(a.ModAdd(b), pinned.ModAdd(b)) << "Failure in pinned ModAdd, size = " << size;
+        EXPECT_EQ(a.ModMul(b), pinned.ModMul(b)) << "Failure in pinned ModMul, size = " << size;
+
+        NativeVector copy(pinned);
+        copy.ModSubEq(b);
+        EXPECT_EQ(a.ModSub(b), copy) << "Failure in pinned ModSubEq, size = " << size;
+        EXPECT_EQ(a, pinned) << "Failure in copy of a pinned vector, size = " << size;
+    }
+}
+
+TEST(UTPim, pinned_vector_stays_on_dpus) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    const usint size = 1024;
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 3);
+    NativeVector b = RandomVector(size, q, 4);
+    a.PinToPim();
+    b.PinToPim();
+
+    // Chained operations on pinned operands only move the result back when it is read
+    pim->reset_counters();
+    a.ModAddEq(b);
+    a.ModAddEq(b);
+    a.ModSubEq(b);
+    EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+    EXPECT_EQ(3U, pim->get_counters().launches);
+
+    NativeVector expected = RandomVector(size, q, 3).ModAdd(RandomVector(size, q, 4));
+    EXPECT_EQ(expected, a);
+    EXPECT_EQ(1U, pim->get_counters().xfers_from_pim);
+}
+
+TEST(UTPim, uneven_lengths_are_padded_on_dpus) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Fewer words than DPUs, and a tail cutting the last slice
+    NativeInteger q("1152921504606846577");
+    for (usint size : {1, PIM_NR_DPUS - 1, 1000 * PIM_NR_DPUS + 3}) {
+        NativeVector a = RandomVector(size, q, 21);
+        NativeVector b = RandomVector(size, q, 22);
+        NativeInteger c(RandomVector(1, q, 23)[0]);
+
+        NativeVector pinned(a);
+        pinned.PinToPim();
+        NativeVector copy(pinned);
+        pinned.ModMulEq(b);
+        pinned.ModAddEq(c);
+        EXPECT_EQ(a.ModMul(b).ModAdd(c), pinned) << "Failure in padded ModMulEq, size = " << size;
+        EXPECT_EQ(a, copy) << "Failure in padded copy, size = " << size;
+
+        std::vector<const NativeVector*> in{&pinned, &copy};
+        NativeVector sum;
+        ASSERT_TRUE(NativeVector::MacOnPim(in, {NativeInteger(3), c}, sum));
+        EXPECT_EQ(pinned.ModMul(3).ModAdd(copy.ModMul(c)), sum) << "Failure in padded MAC, size = " << size;
+    }
+
+    // A pull stops at the end of the buffer, the padding stays on the DPUs
+    const uint32_t size = 2 * PIM_NR_DPUS + 1;
+    auto addr = pim->allocate(size * sizeof(uint64_t));
+    ASSERT_FALSE(addr.empty());
+    std::vector<uint64_t> out(size + 1, 7), in(size);
+    for (uint32_t i = 0; i < size; ++i)
+        in[i] = i + 1;
+    pim->copy_to_pim(in.data(), size, addr[0].second);
+    pim->copy_from_pim(out.data(), size, addr[0].second);
+    pim->deallocate(addr);
+    EXPECT_TRUE(std::equal(in.begin(), in.end(), out.begin()));
+    EXPECT_EQ(7U, out[size]);
+}
+
+TEST(UTPim, copies_of_pinned_vector_stay_on_dpus) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    const usint size = 1024;
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 5);
+    NativeVector b = RandomVector(size, q, 6);
+    NativeVector sum    = a.ModAdd(b);
+    NativeVector diff   = a.ModSub(b);
+    NativeVector parity = a.ModByTwo();
+    a.PinToPim();
+
+    // Copies and out of place results of a pinned vector are made on the DPUs
+    pim->reset_counters();
+    NativeVector copy(a);
+    copy.ModAddEq(b);
+    NativeVector copyDiff = a.ModSub(b);
+    NativeVector assigned;
+    assigned = copy;
+    EXPECT_TRUE(copy.IsPinned());
+    EXPECT_TRUE(copyDiff.IsPinned());
+    EXPECT_TRUE(assigned.IsPinned());
+    EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+
+    EXPECT_EQ(sum, copy) << "Failure in copy of a pinned vector";
+    EXPECT_EQ(diff, copyDiff) << "Failure in pinned ModSub";
+    EXPECT_EQ(sum, assigned) << "Failure in assignment of a pinned vector";
+
+    // Assigning to a vector pinned on another DPU moves it
+    NativeVector other = RandomVector(size, q, 7);
+    other.PinToPim();
+    other = a;
+    EXPECT_TRUE(other.IsPinned());
+    EXPECT_EQ(a, other) << "Failure in assignment across DPUs";
+
+    // Operations without a PIM kernel work on an unpinned host copy
+    NativeVector hostOnly = a.ModByTwo();
+    EXPECT_FALSE(hostOnly.IsPinned());
+    EXPECT_EQ(parity, hostOnly);
+}
+
+TEST(UTPim, pinned_vector_syncs_once_for_concurrent_readers) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    const usint size = 1024;
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 7);
+    NativeVector b = RandomVector(size, q, 8);
+    NativeVector before   = a;
+    NativeVector expected = a.ModAdd(b);
+    a.PinToPim();
+    a.ModAddEq(b);
+
+    // The element accessors do not pull, the readers sync the vector first
+    pim->reset_counters();
+    EXPECT_EQ(before[0], a[0]);
+    EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+
+    std::vector<std::thread> readers;
+    std::vector<int> match(8);
+    for (size_t t = 0; t < match.size(); ++t) {
+        readers.emplace_back([&, t] {
+            a.SyncToHost();
+            int same = 1;
+            for (usint i = t; i < size; i += match.size())
+                same &= a[i] == expected[i];
+            match[t] = same;
+        });
+    }
+    for (auto& r : readers)
+        r.join();
+    EXPECT_EQ(std::vector<int>(match.size(), 1), match);
+    EXPECT_EQ(1U, pim->get_counters().xfers_from_pim);
+}
+
+TEST(UTPim, async_transfers_overlap_launches) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    const uint32_t dpus  = pim->getNumDpus();
+    const uint32_t slice = 512;
+    const uint32_t size  = slice * dpus;
+    const uint32_t bytes = slice * sizeof(uint64_t);
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 61), b = RandomVector(size, q, 62), c = RandomVector(size, q, 63);
+    NativeVector expected(a.ModAdd(b));
+    std::vector<uint64_t> x(size), y(size), z(size), sum(size), gathered(size, 1), back(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        x[i] = a[i].ConvertToInt();
+        y[i] = b[i].ConvertToInt();
+        z[i] = c[i].ConvertToInt();
+    }
+    auto xs = pim->allocate(size_t(size) * sizeof(uint64_t));
+    auto ys = pim->allocate(size_t(size) * sizeof(uint64_t));
+    auto zs = pim->allocate(size_t(size) * sizeof(uint64_t));
+    ASSERT_FALSE(xs.empty() || ys.empty() || zs.empty());
+
+    // The operands go in behind one another, the kernel is queued behind
+    // them and the next transfer behind the kernel, nothing waits in between
+    std::vector<const void*> ySlices(dpus);
+    for (uint32_t d = 0; d < dpus; ++d)
+        ySlices[d] = &y[d * slice];
+    PimEvent xIn = pim->copy_to_pim_async(x.data(), size, xs[0].second);
+    PimEvent yIn = pim->scatter_to_pim_async(ySlices, bytes, ys[0].second);
+
+    struct pim_meta header;
+    struct mod_add_sub_mult& meta = header.args.elem;
+    header.opcode  = OP_ELEM_MOD_ADD;
+    meta.op1.start = xs[0].second;
+    meta.op1.size  = bytes;
+    meta.op2.start = ys[0].second;
+    meta.op2.size  = bytes;
+    meta.res.start = 0;
+    meta.res.size  = 0;
+    meta.mod       = q.ConvertToInt();
+    meta.mu        = 0;
+    meta.precon    = 0;
+    meta.kernel    = VECTOR_EQ;
+    PimEvent added = pim->launch_async(header);
+    PimEvent zIn   = pim->copy_to_pim_async(z.data(), size, zs[0].second);
+
+    // The last DPU is left out of the gather, its share of the buffer is not
+    // written
+    std::vector<void*> sumSlices(dpus, nullptr);
+    for (uint32_t d = 0; d + 1 < dpus; ++d)
+        sumSlices[d] = &gathered[d * slice];
+    PimEvent sumOut  = pim->gather_from_pim_async(sumSlices, bytes, xs[0].second);
+    PimEvent fullOut = pim->copy_from_pim_async(sum.data(), size, xs[0].second);
+    PimEvent zOut    = pim->copy_from_pim_async(back.data(), size, zs[0].second);
+
+    zOut.wait();
+    EXPECT_TRUE(xIn.ready());
+    EXPECT_TRUE(yIn.ready());
+    EXPECT_TRUE(added.ready());
+    EXPECT_TRUE(zIn.ready());
+    EXPECT_TRUE(sumOut.ready());
+    fullOut.wait();
+    for (uint32_t i = 0; i < size; ++i) {
+        EXPECT_EQ(expected[i].ConvertToInt(), sum[i]) << "Failure in the sum read back, word " << i;
+        EXPECT_EQ(i < size - slice ? sum[i] : 1, gathered[i]) << "Failure in the gather, word " << i;
+        EXPECT_EQ(z[i], back[i]) << "Failure in the transfer overlapping the kernel, word " << i;
+    }
+
+    // Nothing to move gives an event which is already complete
+    PimEvent none;
+    EXPECT_TRUE(none.ready());
+    none.wait();
+    PimEvent emptyIn = pim->copy_to_pim_async(x.data(), 0, xs[0].second);
+    EXPECT_TRUE(emptyIn.ready());
+    emptyIn.wait();
+    PimEvent emptyOut = pim->copy_from_pim_async(back.data(), 0, xs[0].second);
+    EXPECT_TRUE(emptyOut.ready());
+    emptyOut.wait();
+
+    pim->deallocate(xs);
+    pim->deallocate(ys);
+    pim->deallocate(zs);
+}
+
+TEST(UTPim, dpu_memory_buddy_allocation) {
+    DpuMemory heap;
+
+    // Blocks are rounded up to a power of two multiple of BLOCK_SIZE
+    int32_t a = heap.allocate(BLOCK_SIZE);
+    int32_t b = heap.allocate(BLOCK_SIZE + 1);
+    int32_t c = heap.allocate(BLOCK_SIZE);
+    EXPECT_EQ(0, a);
+    EXPECT_EQ(2 * BLOCK_SIZE, b);
+    EXPECT_EQ(BLOCK_SIZE, c);
+    EXPECT_EQ(4U * BLOCK_SIZE, heap.bytes_in_use());
+
+    // Freed buddies merge back, the whole heap is available again
+    heap.deallocate(a);
+    heap.deallocate(c);
+    heap.deallocate(b);
+    EXPECT_EQ(0U, heap.bytes_in_use());
+    EXPECT_EQ(0, heap.allocate(CHUNK_SIZE));
+    EXPECT_EQ(-1, heap.allocate(BLOCK_SIZE)) << "Failure to report an exhausted heap";
+}
+
+TEST(UTPim, allocation_is_symmetric_over_dpus) {
+    PimManager* pim = EmulatedPim();
+
+    auto first  = pim->allocate(pim->getNumDpus() * BLOCK_SIZE);
+    auto second = pim->allocate(pim->getNumDpus() * BLOCK_SIZE);
+    ASSERT_EQ(pim->getNumDpus(), first.size());
+    ASSERT_EQ(pim->getNumDpus(), second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(i, first[i].first);
+        EXPECT_EQ(first[0].second, first[i].second);
+        EXPECT_EQ(second[0].second, second[i].second);
+    }
+    EXPECT_NE(first[0].second, second[0].second);
+    pim->deallocate(first);
+    pim->deallocate(second);
+}
+
+TEST(UTPim, allocation_on_one_dpu_shares_blocks) {
+    PimManager* pim = EmulatedPim();
+
+    // The block taken for a DPU leaves a slot of its size to the others
+    int32_t a = pim->allocate_on(0, BLOCK_SIZE);
+    int32_t b = pim->allocate_on(1, BLOCK_SIZE - 8);
+    int32_t c = pim->allocate_on(0, BLOCK_SIZE);
+    ASSERT_NE(-1, a);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(-1, pim->allocate_on(pim->getNumDpus(), BLOCK_SIZE));
+
+    // Only the allocations of a DPU are given back by it
+    EXPECT_TRUE(pim->deallocate_on(0, a));
+    EXPECT_FALSE(pim->deallocate_on(0, a)) << "Failure to report a double release";
+    EXPECT_FALSE(pim->deallocate_on(2, b)) << "Failure to report a slot of another DPU";
+    EXPECT_TRUE(pim->deallocate_on(1, b));
+    EXPECT_TRUE(pim->deallocate_on(0, c));
+    EXPECT_FALSE(pim->deallocate_on(0, c));
+}
+
+TEST(UTPim, leased_partitions_work_concurrently) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+    PimPool& pool   = PimPool::get();
+
+    const usint size = 1024;
+    NativeInteger q("1152921504606846577");
+    NativeVector expected = RandomVector(size, q, 41).ModMul(RandomVector(size, q, 42));
+    std::vector<PimManager*> used(2);
+
+    // Each thread owns a partition, its kernels never reach the default set
+    pim->reset_counters();
+    auto work = [&](size_t t) {
+        PimLease lease = pool.lease(1);
+        PimBinding binding(lease.get());
+        used[t] = lease.get();
+        NativeVector a = RandomVector(size, q, 41);
+        NativeVector b = RandomVector(size, q, 42);
+        a.PinToPim();
+        a.ModMulEq(b);
+        EXPECT_EQ(1U, lease->get_counters().launches);
+        EXPECT_EQ(expected, a) << "Failure in ModMulEq on a leased partition";
+    };
+    std::thread first(work, 0), second(work, 1);
+    first.join();
+    second.join();
+    EXPECT_EQ(0U, pim->get_counters().launches);
+    EXPECT_NE(used[0], used[1]);
+    EXPECT_NE(pim, used[0]);
+    EXPECT_EQ(uint32_t(EMU_RANK_DPUS), used[0]->getNumDpus());
+
+    // Released partitions are handed out again
+    EXPECT_EQ(2U, pool.idle_partitions());
+    PimLease again = pool.lease(1);
+    EXPECT_TRUE(again.get() == used[0] || again.get() == used[1]);
+    EXPECT_EQ(1U, pool.idle_partitions());
+
+    // Operands must live on the same set
+    NativeVector onDefault = RandomVector(size, q, 43);
+    onDefault.PinToPim();
+    PimBinding binding(again.get());
+    NativeVector onLease = RandomVector(size, q, 44);
+    onLease.PinToPim();
+    EXPECT_THROW(onLease.ModAddEq(onDefault), std::invalid_argument);
+}
+
+TEST(UTPim, threads_share_the_default_set) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Each thread has its own modulus, so its NTT launches need their own
+    // tower descriptions on the DPUs
+    const usint n = 1024, m = 2 * n, threads = 4, rounds = 8;
+    std::vector<NativeInteger> q{FirstPrime<NativeInteger>(50, m)};
+    for (usint t = 1; t < threads; ++t)
+        q.push_back(NextPrime<NativeInteger>(q.back(), m));
+    std::vector<NativeVector> expected;
+    for (usint t = 0; t < threads; ++t) {
+        // Also fills the host tables, the threads only read them
+        NativeVector v = RandomVector(n, q[t], 70 + t).ModMul(RandomVector(n, q[t], 80 + t));
+        ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(
+            RootOfUnity<NativeInteger>(m, q[t]), m, &v);
+        expected.push_back(v);
+    }
+
+    pim->reset_counters();
+    auto work = [&](usint t) {
+        NativeInteger root = RootOfUnity<NativeInteger>(m, q[t]);
+        NativeVector b     = RandomVector(n, q[t], 80 + t);
+        for (usint r = 0; r < rounds; ++r) {
+            NativeVector a = RandomVector(n, q[t], 70 + t);
+            a.PinToPim();
+            a.ModMulEq(b);
+            ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(root, m, &a);
+            EXPECT_TRUE(a.IsPinned());
+            EXPECT_EQ(expected[t], a) << "Failure in thread " << t << ", round " << r;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (usint t = 0; t < threads; ++t)
+        workers.emplace_back(work, t);
+    for (auto& w : workers)
+        w.join();
+    EXPECT_EQ(uint64_t(2 * threads * rounds), pim->get_counters().launches);
+}
+
+TEST(UTPim, pinned_ntt_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Towers shorter than a tile of the kernel, and towers spanning several.
+    // Spread ones run the stages crossing the slices on the host.
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (usint n : {8, 1024}) {
+            usint m = 2 * n;
+            NativeInteger q    = FirstPrime<NativeInteger>(50, m);
+            NativeInteger root = RootOfUnity<NativeInteger>(m, q);
+            NativeVector a     = RandomVector(n, q, 7);
+
+            NativeVector expected(a);
+            ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(root, m, &expected);
+
+            NativeVector pinned(a);
+            pinned.PinToPim(layout);
+            pim->reset_counters();
+            ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(root, m, &pinned);
+            EXPECT_EQ(1U, pim->get_counters().launches);
+            // Nothing comes back: a whole tower is transformed by its DPU, the
+            // cross stages of a spread one run on its current host copy
+            EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+            EXPECT_TRUE(pinned.IsPinned());
+            EXPECT_EQ(expected, pinned) << "Failure in pinned forward NTT, n = " << n;
+
+            ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(root, m, &pinned);
+            EXPECT_EQ(a, pinned) << "Failure in pinned inverse NTT, n = " << n;
+        }
+    }
+}
+
+TEST(UTPim, pinned_automorphism_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Towers shorter than a tile of the kernel and towers spanning several,
+    // permuted by their DPU when whole. The slices of a spread tower are
+    // exchanged between the DPUs through the host.
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (usint n : {8, 2048}) {
+            NativeInteger q = FirstPrime<NativeInteger>(50, 2 * n);
+            NativeVector a  = RandomVector(n, q, 5);
+            for (uint32_t k : {1U, 3U, 5U, 2 * n - 1}) {
+                std::vector<uint32_t> precomp(n);
+                PrecomputeAutoMap(n, k, &precomp);
+                NativeVector expected(n, q);
+                for (usint j = 0; j < n; ++j)
+                    expected[j] = a[precomp[j]];
+
+                NativeVector pinned(a);
+                pinned.PinToPim(layout);
+                NativeVector result;
+                pim->reset_counters();
+                EXPECT_TRUE(pinned.AutomorphismOnPim(k, result));
+                EXPECT_EQ(1U, pim->get_counters().launches);
+                if (layout == PimLayout::WHOLE) {
+                    EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+                }
+                EXPECT_TRUE(result.IsPinned());
+                EXPECT_EQ(expected, result) << "Failure in pinned automorphism " << k << ", n = " << n;
+            }
+        }
+    }
+}
+
+TEST(UTPim, pinned_base_conversion_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // The arithmetic of ApproxSwitchCRTBasis, the tables need not come from
+    // actual CRT bases for it
+    const usint sizeQ = 3, sizeP = 2;
+    std::vector<NativeInteger> q, p;
+    PimBaseConvTables tables;
+    uint64_t seed = 11;
+    for (usint i = 0; i < sizeQ + sizeP; ++i) {
+        NativeInteger m = PreviousPrime<NativeInteger>(FirstPrime<NativeInteger>(58 - i, 2048), 2048);
+        (i < sizeQ ? q : p).push_back(m);
+    }
+    for (usint i = 0; i < sizeQ; ++i) {
+        NativeInteger inv = RandomVector(1, q[i], seed + i)[0];
+        tables.q.push_back(q[i].ConvertToInt());
+        tables.q_hat_inv.push_back(inv.ConvertToInt());
+        tables.q_hat_inv_precon.push_back(inv.PrepModMulConst(q[i]).ConvertToInt());
+        for (usint j = 0; j < sizeP; ++j)
+            tables.q_hat_modp.push_back(RandomVector(1, p[j], seed + 7 * i + j)[0].ConvertToInt());
+    }
+    for (usint j = 0; j < sizeP; ++j) {
+        tables.p.push_back(p[j].ConvertToInt());
+        tables.p_mu.push_back(~DoubleNativeInt(0) / p[j].ConvertToInt());
+    }
+
+    // Slices shorter than the tasklets, and slices spanning several tiles, of
+    // towers held whole by one DPU or spread over all of them
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (usint n : {4 * PIM_NR_DPUS, 1000 * PIM_NR_DPUS}) {
+            std::vector<NativeVector> x, y;
+            for (usint i = 0; i < sizeQ; ++i)
+                x.push_back(RandomVector(n, q[i], 3 + i));
+            for (usint j = 0; j < sizeP; ++j)
+                y.push_back(NativeVector(n, p[j]));
+
+            std::vector<NativeVector> expected(y);
+            for (usint ri = 0; ri < n; ++ri) {
+                std::vector<DoubleNativeInt> sum(sizeP);
+                for (usint i = 0; i < sizeQ; ++i) {
+                    NativeInteger xi = x[i][ri].ModMulFastConst(NativeInteger(tables.q_hat_inv[i]), q[i],
+                                                                NativeInteger(tables.q_hat_inv_precon[i]));
+                    for (usint j = 0; j < sizeP; ++j)
+                        sum[j] += Mul128(xi.ConvertToInt(), tables.q_hat_modp[i * sizeP + j]);
+                }
+                for (usint j = 0; j < sizeP; ++j)
+                    expected[j][ri] = BarrettUint128ModUint64(sum[j], tables.p[j], tables.p_mu[j]);
+            }
+
+            std::vector<const NativeVector*> in;
+            std::vector<NativeVector*> out;
+            x[0].PinToPim(layout);
+            for (auto& v : x) {
+                v.PinToPim(x[0]);
+                in.push_back(&v);
+            }
+            for (auto& v : y)
+                out.push_back(&v);
+            pim->reset_counters();
+            ASSERT_TRUE(NativeVector::BaseConvOnPim(in, out, tables));
+            EXPECT_EQ(1U, pim->get_counters().launches);
+            for (usint j = 0; j < sizeP; ++j) {
+                EXPECT_TRUE(y[j].IsPinned());
+                EXPECT_EQ(expected[j], y[j]) << "Failure in pinned base conversion, n = " << n << ", tower " << j;
+            }
+
+            // The tables are already on the DPUs and the towers stay where they
+            // are, only the tower offsets and the header are sent
+            pim->reset_counters();
+            ASSERT_TRUE(NativeVector::BaseConvOnPim(in, out, tables));
+            EXPECT_EQ(2U, pim->get_counters().xfers_to_pim);
+            EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+            EXPECT_EQ(expected[0], y[0]);
+        }
+    }
+
+    // Towers placed differently are left to the host before anything moves,
+    // the outputs keep their values and their mirrors
+    usint n = 16 * PIM_NR_DPUS;
+    std::vector<NativeVector> x, y;
+    for (usint i = 0; i < sizeQ; ++i)
+        x.push_back(RandomVector(n, q[i], 3 + i));
+    for (usint j = 0; j < sizeP; ++j)
+        y.push_back(RandomVector(n, p[j], 9 + j));
+    std::vector<NativeVector> before(y);
+    x[0].PinToPim(PimLayout::WHOLE);
+    x[1].PinToPim(PimLayout::SPREAD);
+    x[2].PinToPim(x[0]);
+    y[0].PinToPim();
+    std::vector<const NativeVector*> in{&x[0], &x[1], &x[2]};
+    std::vector<NativeVector*> out{&y[0], &y[1]};
+    pim->reset_counters();
+    EXPECT_FALSE(NativeVector::BaseConvOnPim(in, out, tables));
+    EXPECT_EQ(0U, pim->get_counters().launches);
+    EXPECT_EQ(0U, pim->get_counters().xfers_to_pim);
+    EXPECT_TRUE(y[0].IsPinned());
+    EXPECT_FALSE(y[1].IsPinned());
+    EXPECT_EQ(before, y);
+}
+
+TEST(UTPim, pinned_mac_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // More terms than a launch takes, the sum is carried over to the next one
+    const usint terms = PIM_MAC_TERMS + 3;
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (const char* modulus : {"1152921504606846577", "65537"}) {
+            NativeInteger q(modulus);
+            for (usint n : {4 * PIM_NR_DPUS, 1000 * PIM_NR_DPUS}) {
+                std::vector<NativeVector> x;
+                std::vector<NativeInteger> w;
+                NativeVector expected(n, q);
+                for (usint i = 0; i < terms; ++i) {
+                    x.push_back(RandomVector(n, q, 50 + i));
+                    w.push_back(i == 0 ? q - 1 : RandomVector(1, q, 70 + i)[0]);
+                    expected.ModAddEq(x[i].ModMul(w[i]));
+                }
+
+                std::vector<const NativeVector*> in;
+                x[0].PinToPim(layout);
+                for (auto& v : x) {
+                    v.PinToPim(x[0]);
+                    in.push_back(&v);
+                }
+                NativeVector sum;
+                pim->reset_counters();
+                ASSERT_TRUE(NativeVector::MacOnPim(in, w, sum));
+                EXPECT_EQ(2U, pim->get_counters().launches);
+                EXPECT_TRUE(sum.IsPinned());
+                EXPECT_EQ(expected, sum) << "Failure in pinned MAC, q = " << q << ", n = " << n;
+            }
+        }
+    }
+
+    // Terms pinned separately are on different DPUs, they are moved next to
+    // the first one and stay there
+    NativeInteger q("65537");
+    NativeVector b = RandomVector(16 * PIM_NR_DPUS, q, 91), c = RandomVector(16 * PIM_NR_DPUS, q, 92), bc;
+    b.PinToPim();
+    c.PinToPim();
+    ASSERT_TRUE(NativeVector::MacOnPim({&b, &c}, {NativeInteger(2), NativeInteger(3)}, bc));
+    EXPECT_EQ(b.ModMul(NativeInteger(2)).ModAdd(c.ModMul(NativeInteger(3))), bc);
+    pim->reset_counters();
+    ASSERT_TRUE(NativeVector::MacOnPim({&b, &c}, {NativeInteger(2), NativeInteger(3)}, bc));
+    EXPECT_EQ(0U, pim->get_counters().xfers_from_pim);
+
+    // Unpinned terms are left to the host
+    NativeVector a = RandomVector(16 * PIM_NR_DPUS, q, 90), sum;
+    EXPECT_FALSE(NativeVector::MacOnPim({&a}, {NativeInteger(3)}, sum));
+}
+
+TEST(UTPim, pinned_rescale_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Wider and narrower moduli than the last one, both branches of the lift
+    NativeInteger ql = FirstPrime<NativeInteger>(55, 64);
+    std::vector<NativeInteger> q{FirstPrime<NativeInteger>(59, 64), NativeInteger("65537"),
+                                 NextPrime<NativeInteger>(ql, 64), FirstPrime<NativeInteger>(50, 64)};
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (usint n : {8, 1000 * PIM_NR_DPUS + 3}) {
+            NativeVector last = RandomVector(n, ql, 31);
+            // RandomVector stays below 2^53, half of the words go above ql / 2
+            for (usint k = 0; k < n; k += 2)
+                last[k] = ql - last[k] - 1;
+            std::vector<NativeVector> x, expected, lifted;
+            std::vector<NativeInteger> scale, qInv;
+            for (usint i = 0; i < q.size(); ++i) {
+                x.push_back(RandomVector(n, q[i], 32 + i));
+                scale.push_back(RandomVector(1, q[i], 40 + i)[0]);
+                qInv.push_back(ql.Mod(q[i]).ModInverse(q[i]));
+                NativeVector y(last);
+                y.SwitchModulus(q[i]);
+                lifted.push_back(y.ModMul(scale[i]));
+                expected.push_back(x[i].ModMul(qInv[i]).ModAdd(lifted[i]));
+            }
+            last.PinToPim(layout);
+
+            // Coefficient form, a single launch
+            std::vector<NativeVector> fused(x);
+            std::vector<NativeVector*> towers;
+            for (auto& v : fused) {
+                v.PinToPim(last);
+                towers.push_back(&v);
+            }
+            pim->reset_counters();
+            ASSERT_TRUE(NativeVector::RescaleOnPim(RESCALE_FUSED, &last, towers, {}, scale, qInv));
+            EXPECT_EQ(1U, pim->get_counters().launches);
+            for (usint i = 0; i < q.size(); ++i) {
+                EXPECT_EQ(expected[i], fused[i]) << "Failure in fused rescale, n = " << n << ", q = " << q[i];
+            }
+
+            // Evaluation form, the lifted towers are left on the DPUs in between
+            std::vector<NativeVector> y(q.size()), split(x);
+            std::vector<NativeVector*> ys;
+            towers.clear();
+            for (usint i = 0; i < q.size(); ++i) {
+                y[i].SetModulus(q[i]);
+                ys.push_back(&y[i]);
+                split[i].PinToPim(last);
+                towers.push_back(&split[i]);
+            }
+            ASSERT_TRUE(NativeVector::RescaleOnPim(RESCALE_SWITCH, &last, {}, ys, scale, qInv));
+            for (usint i = 0; i < q.size(); ++i) {
+                EXPECT_TRUE(y[i].IsPinned());
+            }
+            ASSERT_TRUE(NativeVector::RescaleOnPim(RESCALE_ADD, nullptr, towers, ys, scale, qInv));
+            for (usint i = 0; i < q.size(); ++i) {
+                EXPECT_EQ(lifted[i], y[i]) << "Failure in lifting the last tower, n = " << n << ", q = " << q[i];
+                EXPECT_EQ(expected[i], split[i]) << "Failure in split rescale, n = " << n << ", q = " << q[i];
+            }
+        }
+    }
+
+    // An unpinned last tower is left to the host
+    NativeVector last = RandomVector(8, ql, 31), x = RandomVector(8, q[0], 32);
+    x.PinToPim();
+    std::vector<NativeVector*> towers{&x};
+    EXPECT_FALSE(NativeVector::RescaleOnPim(RESCALE_FUSED, &last, towers, {}, {NativeInteger(1)}, {NativeInteger(1)}));
+
+    // Towers placed differently are left to the host before anything moves,
+    // the towers keep their values and their mirrors
+    usint n = 16 * PIM_NR_DPUS;
+    last = RandomVector(n, ql, 31);
+    x = RandomVector(n, q[0], 32);
+    NativeVector y = RandomVector(n, q[0], 33), before(x);
+    last.PinToPim(PimLayout::WHOLE);
+    x.PinToPim(PimLayout::SPREAD);
+    y.PinToPim(PimLayout::WHOLE);
+    std::vector<NativeVector*> ys{&y};
+    pim->reset_counters();
+    EXPECT_FALSE(NativeVector::RescaleOnPim(RESCALE_FUSED, &last, towers, {}, {NativeInteger(1)}, {NativeInteger(1)}));
+    EXPECT_FALSE(NativeVector::RescaleOnPim(RESCALE_ADD, nullptr, towers, ys, {NativeInteger(1)}, {NativeInteger(1)}));
+    EXPECT_EQ(0U, pim->get_counters().launches);
+    EXPECT_EQ(0U, pim->get_counters().xfers_to_pim);
+    EXPECT_TRUE(x.IsPinned());
+    EXPECT_EQ(before, x);
+}
+
+TEST(UTPim, seeded_uniform_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // RFC 8439, section 2.3.2
+    uint32_t key[8], nonce[3] = {0x09000000, 0x4a000000, 0}, block[16];
+    for (uint32_t i = 0; i < 8; ++i)
+        key[i] = 0x03020100 + 0x04040404 * i;
+    pim_chacha20_block(key, 1, nonce, block);
+    const uint32_t expected[16] = {0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3, 0xc7f4d1c7, 0x0368c033,
+                                   0x9aaa2204, 0x4e6cd4c3, 0x466482d2, 0x09aa9f07, 0x05d7c214, 0xa2028bd9,
+                                   0xd19c12b5, 0xb94e16de, 0xe883d0cb, 0x4e3c50a2};
+    for (uint32_t i = 0; i < 16; ++i) {
+        EXPECT_EQ(expected[i], block[i]) << "Failure in the ChaCha20 block, word " << i;
+    }
+
+    // Moduli just above a power of two reject almost half of the draws
+    PimUniformSeed seed{1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<NativeInteger> q{FirstPrime<NativeInteger>(59, 64), NativeInteger("65537"), NativeInteger(3),
+                                 NativeInteger((uint64_t(1) << 62) + 1)};
+    for (PimLayout layout : {PimLayout::WHOLE, PimLayout::SPREAD}) {
+        for (usint n : {8, 1000 * PIM_NR_DPUS + 3}) {
+            std::vector<NativeVector> dpu, host;
+            std::vector<NativeVector*> out;
+            std::vector<uint64_t> streams;
+            for (usint i = 0; i < q.size(); ++i) {
+                dpu.emplace_back(n, q[i]);
+                host.emplace_back(n, q[i]);
+                host[i].UniformFromSeed(seed, i);
+                streams.push_back(i);
+            }
+            // The first output picks the layout, the others follow it
+            dpu[0].PinToPim(layout);
+            for (auto& v : dpu)
+                out.push_back(&v);
+            pim->reset_counters();
+            ASSERT_TRUE(NativeVector::UniformOnPim(seed, out, streams));
+            EXPECT_EQ(1U, pim->get_counters().launches);
+            for (usint i = 0; i < q.size(); ++i) {
+                EXPECT_TRUE(dpu[i].IsPinned());
+                EXPECT_EQ(host[i], dpu[i]) << "Failure in seeded sampling, n = " << n << ", q = " << q[i];
+                bool reduced = true;
+                for (usint k = 0; k < n; ++k)
+                    reduced = reduced && host[i][k] < q[i];
+                EXPECT_TRUE(reduced) << "Failure in the range of seeded sampling, q = " << q[i];
+            }
+        }
+    }
+
+    // Towers of different lengths are left to the host before anything moves,
+    // the towers keep their values and their mirrors
+    NativeVector pinned = RandomVector(16, q[1], 5), other(8, q[1]);
+    NativeVector before(pinned);
+    pinned.PinToPim();
+    std::vector<NativeVector*> mixed{&pinned, &other};
+    pim->reset_counters();
+    EXPECT_FALSE(NativeVector::UniformOnPim(seed, mixed, {0, 1}));
+    EXPECT_EQ(0U, pim->get_counters().launches);
+    EXPECT_EQ(0U, pim->get_counters().xfers_to_pim);
+    EXPECT_TRUE(pinned.IsPinned());
+    EXPECT_FALSE(other.IsPinned());
+    EXPECT_EQ(before, pinned);
+
+    // Every residue of a small modulus shows up about as often, and another
+    // stream or seed gives another vector
+    usint n = 3 * 4096;
+    NativeVector a(n, NativeInteger(3)), b(n, NativeInteger(3)), c(n, NativeInteger(3));
+    a.UniformFromSeed(seed, 0);
+    b.UniformFromSeed(seed, 1);
+    seed[7]++;
+    c.UniformFromSeed(seed, 0);
+    std::vector<usint> hits(3);
+    for (usint k = 0; k < n; ++k)
+        hits[a[k].ConvertToInt()]++;
+    for (usint r = 0; r < 3; ++r) {
+        EXPECT_TRUE(hits[r] > 3900 && hits[r] < 4300) << "Failure in the distribution, residue " << r;
+    }
+    EXPECT_NE(a, b);
+    EXPECT_NE(a, c);
+}
+
+TEST(UTPim, key_cache_keeps_frequent_keys_resident) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // Keys of 1000 words, the cache holds three of them
+    NativeInteger q = FirstPrime<NativeInteger>(50, 64);
+    const size_t bytes = 1000 * sizeof(uint64_t);
+    std::vector<std::shared_ptr<NativeVector>> keys;
+    for (uint64_t i = 0; i < 5; ++i)
+        keys.push_back(std::make_shared<NativeVector>(RandomVector(1000, q, 50 + i)));
+    PimKeyCache cache(3 * bytes);
+    auto use = [&](usint i, uint32_t index) {
+        std::weak_ptr<NativeVector> owner = keys[i];
+        return cache.acquire(keys[i], "tag", index, bytes, [&keys, i] { keys[i]->PinToPim(); }, [owner] {
+            if (auto key = owner.lock())
+                key->UnpinFromPim();
+        });
+    };
+
+    // Each key crosses the bus on its first use only
+    pim->reset_counters();
+    for (usint round = 0; round < 3; ++round) {
+        for (usint i = 0; i < 3; ++i) {
+            if (i <= round)
+                EXPECT_TRUE(use(i, i).resident());
+        }
+    }
+    EXPECT_EQ(3U, pim->get_counters().xfers_to_pim);
+    PimKeyCacheStats stats = cache.get_stats();
+    EXPECT_EQ(3U, stats.misses);
+    EXPECT_EQ(3U, stats.hits);
+    EXPECT_EQ(3 * bytes, stats.bytes);
+
+    // Key 2 is the least used, it makes room for key 3 unless a switch holds it
+    {
+        auto held = use(2, 2);
+        auto lease = use(3, 3);
+        EXPECT_TRUE(lease.resident());
+        EXPECT_TRUE(keys[2]->IsPinned());
+        EXPECT_FALSE(keys[1]->IsPinned());
+    }
+    use(4, 4);
+    EXPECT_FALSE(keys[3]->IsPinned());
+    EXPECT_TRUE(keys[0]->IsPinned() && keys[2]->IsPinned() && keys[4]->IsPinned());
+    EXPECT_EQ(2U, cache.get_stats().evictions);
+    EXPECT_EQ(3 * bytes, cache.get_stats().bytes);
+
+    // A key too large for the cache is left to the host
+    std::shared_ptr<NativeVector> large = std::make_shared<NativeVector>(RandomVector(8, q, 60));
+    EXPECT_FALSE(cache.acquire(large, "tag", 9, 4 * bytes, [&large] { large->PinToPim(); }, [] {}).resident());
+    EXPECT_FALSE(large->IsPinned());
+
+    // A regenerated key replaces the old one, a freed one is evicted first
+    std::shared_ptr<NativeVector> old = keys[0];
+    keys[0] = std::make_shared<NativeVector>(RandomVector(1000, q, 70));
+    EXPECT_TRUE(use(0, 0).resident());
+    EXPECT_FALSE(old->IsPinned());
+    EXPECT_TRUE(keys[0]->IsPinned());
+    keys[4].reset();
+    EXPECT_TRUE(use(3, 3).resident());
+    EXPECT_TRUE(keys[0]->IsPinned() && keys[2]->IsPinned() && keys[3]->IsPinned());
+
+    cache.clear();
+    EXPECT_EQ(0U, cache.get_stats().entries);
+    EXPECT_FALSE(keys[0]->IsPinned() || keys[2]->IsPinned() || keys[3]->IsPinned());
+}
+
+TEST(UTPim, key_cache_uploads_without_its_lock) {
+    // The upload of key 0 is held: key 1 is served meanwhile, and the other
+    // acquirer of key 0 waits for the upload instead of repeating it
+    PimKeyCache cache(1000);
+    auto owner = std::make_shared<int>(0), other = std::make_shared<int>(1);
+    std::promise<void> started, release;
+    std::shared_future<void> go(release.get_future());
+    std::atomic<usint> pins{0};
+    auto slow = [&] {
+        pins++;
+        started.set_value();
+        go.wait();
+    };
+    auto fast = [&] { pins++; };
+    PimKeyCache::Lease first, same;
+    std::thread uploader([&] { first = cache.acquire(owner, "tag", 0, 100, slow, [] {}); });
+    started.get_future().wait();
+    std::thread waiter([&] { same = cache.acquire(owner, "tag", 0, 100, fast, [] {}); });
+    EXPECT_TRUE(cache.acquire(other, "tag", 1, 100, fast, [] {}).resident());
+    EXPECT_EQ(2U, pins.load());
+    release.set_value();
+    uploader.join();
+    waiter.join();
+    EXPECT_TRUE(first.resident());
+    EXPECT_TRUE(same.resident());
+    EXPECT_EQ(2U, pins.load());
+    PimKeyCacheStats stats = cache.get_stats();
+    EXPECT_EQ(1U, stats.hits);
+    EXPECT_EQ(2U, stats.misses);
+    EXPECT_EQ(2U, stats.entries);
+
+    // A failed upload gives its room back
+    bool unpinned = false;
+    EXPECT_FALSE(cache
+                     .acquire(
+                         other, "tag", 2, 100, [] { throw std::runtime_error("MRAM exhausted"); },
+                         [&unpinned] { unpinned = true; })
+                     .resident());
+    EXPECT_TRUE(unpinned);
+    EXPECT_EQ(2U, cache.get_stats().entries);
+    EXPECT_EQ(200U, cache.get_stats().bytes);
+}
+
+TEST(UTPim, blind_rotation_matches_host) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    // The arithmetic of BootstrapGateCore with RingGSWAccumulatorCGGI and of
+    // the extraction of EvalBinGate; the keys need not encrypt anything for it
+    const usint N = 64, M = 2 * N, n = 5, q = 64, digits = 4, gBits = 9;
+    NativeInteger Q    = FirstPrime<NativeInteger>(27, M);
+    NativeInteger root = RootOfUnity<NativeInteger>(M, Q);
+    auto ntt           = [&](NativeVector v) {
+        ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(root, M, &v);
+        return v;
+    };
+    auto intt = [&](NativeVector v) {
+        ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(root, M, &v);
+        return v;
+    };
+
+    std::vector<NativeVector> monomials;
+    for (usint e = 0; e < M; ++e) {
+        NativeVector x(N, Q);
+        x[0].ModSubFastEq(1, Q);
+        if (e < N)
+            x[e].ModAddFastEq(1, Q);
+        else
+            x[e - N].ModSubFastEq(1, Q);
+        monomials.push_back(ntt(x));
+    }
+    std::vector<NativeVector> ek;  // at ((i * 2 + secret) * digits + d) * 2 + c
+    for (usint r = 0; r < n * 2 * digits * 2; ++r)
+        ek.push_back(RandomVector(N, Q, 100 + r));
+
+    PimBootKey key;
+    key.modulus = Q.ConvertToInt();
+    key.N       = N;
+    key.n       = n;
+    key.digits  = digits;
+    key.g_bits  = gBits;
+    key.ntt     = ChineseRemainderTransformFTT<NativeVector>::PimTables(Q, N);
+    std::map<uint64_t, uint32_t> logs;
+    for (usint e = 0; e < M; ++e) {
+        key.monomials.push_back(monomials[e][0].ConvertToInt());
+        logs[key.monomials.back()] = e;
+    }
+    for (usint j = 0; j < N; ++j)
+        key.exponents.push_back(logs[monomials[1][j].ConvertToInt()]);
+    key.rows = [&](uint32_t i, uint32_t* rows) {
+        for (usint r = 0; r < 2 * digits * 2; ++r)
+            for (usint j = 0; j < N; ++j)
+                rows[r * N + j] = ek[i * 2 * digits * 2 + r][j].ConvertToInt<uint32_t>();
+    };
+
+    // Two gate ranges, one wrapping around q, over more gates than DPUs
+    std::vector<PimGateInput> inputs;
+    for (usint g = 0; g < PIM_NR_DPUS + 2; ++g) {
+        PimGateInput in;
+        in.q   = q;
+        in.q1  = g % 2 ? 3 * q / 8 : 3 * q / 4;
+        in.q2  = (in.q1 + q / 2) % q;
+        in.q2p = Q.ConvertToInt() / 8 + 1;
+        in.b   = RandomVector(1, q, 200 + g)[0].ConvertToInt();
+        NativeVector a = RandomVector(n, q, 300 + g);
+        for (usint i = 0; i < n; ++i)
+            in.index.push_back(NativeInteger(0).ModSubFast(a[i], q).ConvertToInt() * (M / q));
+        inputs.push_back(in);
+    }
+
+    int64_t Qs = Q.ConvertToInt();
+    auto digit = [&](int64_t& x) {
+        int64_t r = int64_t(uint64_t(x) << (64 - gBits)) >> (64 - gBits);
+        x         = (x - r) >> gBits;
+        return r;
+    };
+    std::vector<PimGateOutput> expected;
+    for (const PimGateInput& in : inputs) {
+        NativeVector m(N, Q);
+        for (usint j = 0; j < q / 2; ++j) {
+            uint64_t temp = (in.b + q - j) % q;
+            bool inside   = in.q1 < in.q2 ? temp >= in.q1 && temp < in.q2 : !(temp >= in.q2 && temp < in.q1);
+            m[j * (M / q)] = inside ? Q - in.q2p : in.q2p;
+        }
+        std::vector<NativeVector> acc{NativeVector(N, Q), ntt(m)};
+        for (usint i = 0; i < n; ++i) {
+            std::vector<NativeVector> ct{intt(acc[0]), intt(acc[1])};
+            std::vector<NativeVector> dct(digits, NativeVector(N, Q));
+            for (usint j = 0; j < N; ++j) {
+                for (usint c = 0; c < 2; ++c) {
+                    int64_t t = ct[c][j].ConvertToInt();
+                    int64_t x = t < Qs / 2 ? t : t - Qs;
+                    digit(x);
+                    for (usint d = c; d < digits; d += 2) {
+                        int64_t r = digit(x);
+                        dct[d][j] = r < 0 ? r + Qs : r;
+                    }
+                }
+            }
+            for (auto& v : dct)
+                v = ntt(v);
+            uint32_t pos = in.index[i] % M, neg = (M - in.index[i]) % M;
+            for (usint c = 0; c < 2; ++c) {
+                for (usint secret = 0; secret < 2; ++secret) {
+                    NativeVector sum(N, Q);
+                    for (usint d = 0; d < digits; ++d)
+                        sum.ModAddEq(dct[d].ModMul(ek[((i * 2 + secret) * digits + d) * 2 + c]));
+                    acc[c].ModAddEq(sum.ModMul(monomials[secret ? neg : pos]));
+                }
+            }
+        }
+        // Transposed extraction, a(X^-1) and b + Q/8 + 1
+        NativeVector a = intt(acc[0]);
+        PimGateOutput out;
+        for (usint j = 0; j < N; ++j)
+            out.a.push_back((j == 0 ? a[0] : a[N - j].ModMul(Q - 1, Q)).ConvertToInt());
+        out.b = intt(acc[1])[0].ModAdd((Q >> 3) + 1, Q).ConvertToInt();
+        expected.push_back(out);
+    }
+
+    auto owner = std::make_shared<int>(0);
+    std::vector<PimGateOutput> outputs;
+    pim->reset_counters();
+    ASSERT_TRUE(pim_blind_rotate(*pim, owner, key, inputs, outputs));
+    EXPECT_EQ(2U, pim->get_counters().launches);
+    ASSERT_EQ(inputs.size(), outputs.size());
+    for (usint g = 0; g < inputs.size(); ++g) {
+        EXPECT_EQ(expected[g].a, outputs[g].a) << "Failure in blind rotation " << g;
+        EXPECT_EQ(expected[g].b, outputs[g].b) << "Failure in blind rotation " << g;
+    }
+
+    // The key stays on the DPUs, only the ciphertexts move
+    pim->reset_counters();
+    ASSERT_TRUE(pim_blind_rotate(*pim, owner, key, inputs, outputs));
+    EXPECT_LT(pim->get_counters().bytes_to_pim, uint64_t(n) * key.row_bytes());
+    EXPECT_EQ(expected[0].a, outputs[0].a);
+}
+
+TEST(UTPim, stats_split_transfers_launches_and_cycles) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim = EmulatedPim();
+
+    const usint size = 1024 * PIM_NR_DPUS;
+    NativeInteger q("1152921504606846577");
+    NativeVector a = RandomVector(size, q, 41);
+    NativeVector b = RandomVector(size, q, 42);
+    NativeVector expected(a.ModMul(b));
+
+    pim->set_timing(true);
+    pim->reset_stats();
+    a.PinToPim();
+    a.ModMulEq(b);
+    EXPECT_EQ(expected, a);
+    PimStats stats = pim->get_stats();
+    pim->set_timing(false);
+
+    EXPECT_EQ(1U, stats.kernels[OP_ELEM_MOD_MULT].launches);
+    EXPECT_GT(stats.kernels[OP_ELEM_MOD_MULT].max_cycles, 0U);
+    EXPECT_GT(stats.kernels[OP_ELEM_MOD_MULT].total_cycles, stats.kernels[OP_ELEM_MOD_MULT].max_cycles);
+    EXPECT_EQ(0U, stats.kernels[OP_ELEM_MOD_ADD].launches);
+    EXPECT_EQ(1U, stats.counters.launches);
+    EXPECT_GT(stats.counters.launch_ns, 0U);
+    EXPECT_GT(stats.counters.to_pim_ns, 0U);
+    EXPECT_GT(stats.counters.from_pim_ns, 0U);
+    EXPECT_EQ(uint64_t(size) * sizeof(uint64_t), stats.counters.bytes_from_pim);
+    EXPECT_GT(stats.counters.mram_high_water, 0U);
+    EXPECT_GE(stats.counters.mram_high_water, stats.mram_in_use);
+
+    std::string json = stats.to_json();
+    EXPECT_NE(std::string::npos, json.find("\"mod_mult\": {\"launches\": 1,"));
+    EXPECT_NE(std::string::npos, json.find("\"backend\": \"emulator\""));
+}
+
+TEST(UTPim, offload_planner_routes_by_cost) {
+    if (sizeof(NativeInteger::Integer) != sizeof(uint64_t))
+        GTEST_SKIP() << "PIM offload needs 64-bit native integers";
+    PimManager* pim      = EmulatedPim();
+    PimPlanner& planner = PimPlanner::get();
+    ASSERT_FALSE(planner.enabled()) << "The offload planner must be opt-in";
+
+    // The DPUs only win on large operands that already are on the DPUs
+    PimCalibration c;
+    c.backend                      = pim->get_backend_name();
+    c.nr_dpus                      = pim->getNumDpus();
+    c.host_word_ns[PIM_OP_ADD_SUB] = 1;
+    c.host_word_ns[PIM_OP_MULT]    = 4;
+    c.pim_word_ns[PIM_OP_ADD_SUB]  = 0.5;
+    c.pim_word_ns[PIM_OP_MULT]     = 1;
+    c.launch_ns                    = 20000;
+    c.to_pim_ns = c.from_pim_ns = 10000;
+    c.to_pim_byte_ns = c.from_pim_byte_ns = 0.5;
+    planner.set_calibration(c);
+
+    // A whole vector is computed by one DPU
+    const usint large = 65536;
+    EXPECT_TRUE(planner.offload(PIM_OP_ADD_SUB, large, 1, 0, 0));
+    EXPECT_FALSE(planner.offload(PIM_OP_ADD_SUB, 1024, 1, 0, 0)) << "Failure to keep small operands on the host";
+    EXPECT_FALSE(planner.offload(PIM_OP_ADD_SUB, large, 1, 2, 0)) << "Failure to charge the transfers to the DPUs";
+    EXPECT_FALSE(planner.offload(PIM_OP_ADD_SUB, large, 8, 0, 0)) << "Failure to charge the queued launches";
+    EXPECT_TRUE(planner.offload(PIM_OP_MULT, 1024, 1, 0, 2)) << "Failure to charge the transfers to the host";
+    EXPECT_FALSE(planner.offload(PIM_OP_MULT, 6000, 1, 0, 0)) << "Failure to charge every word to the one DPU";
+    EXPECT_TRUE(planner.offload(PIM_OP_MULT, 8000, 1, 0, 0));
+
+    NativeInteger q("1152921504606846577");
+    NativeVector small = RandomVector(1024, q, 31);
+    NativeVector big   = RandomVector(large, q, 32);
+    NativeVector expectedSmall(small.ModAdd(small));
+    NativeVector expectedBig(big.ModAdd(big));
+    small.PinToPim();
+    big.PinToPim();
+
+    planner.enable(true);
+    pim->reset_counters();
+    NativeVector sumSmall = small.ModAdd(small);
+    EXPECT_EQ(0U, pim->get_counters().launches);
+    NativeVector sumBig = big.ModAdd(big);
+    EXPECT_EQ(1U, pim->get_counters().launches);
+    planner.enable(false);
+
+    EXPECT_FALSE(sumSmall.IsPinned());
+    EXPECT_EQ(expectedSmall, sumSmall) << "Failure in ModAdd routed to the host";
+    EXPECT_EQ(expectedBig, sumBig) << "Failure in ModAdd routed to the DPUs";
+}
+
+TEST(UTPim, offload_planner_calibration_persists) {
+    PimManager* pim  = EmulatedPim();
+    std::string path = testing::TempDir() + "pim-calibration";
+    setenv("PIM_CALIBRATION", path.c_str(), 1);
+
+    PimPlanner::get().calibrate();
+    const PimCalibration& c = PimPlanner::get().get_calibration();
+    EXPECT_EQ(pim->get_backend_name(), c.backend);
+    EXPECT_EQ(pim->getNumDpus(), c.nr_dpus);
+    EXPECT_GT(c.launch_ns, 0);
+    EXPECT_GT(c.host_word_ns[PIM_OP_MULT], 0);
+
+    PimCalibration saved;
+    ASSERT_TRUE(saved.load(path));
+    EXPECT_EQ(c.backend, saved.backend);
+    EXPECT_EQ(c.nr_dpus, saved.nr_dpus);
+    EXPECT_DOUBLE_EQ(c.launch_ns, saved.launch_ns);
+    EXPECT_DOUBLE_EQ(c.pim_word_ns[PIM_OP_MULT], saved.pim_word_ns[PIM_OP_MULT]);
+    EXPECT_DOUBLE_EQ(c.to_pim_byte_ns, saved.to_pim_byte_ns);
+    std::remove(path.c_str());
+    unsetenv("PIM_CALIBRATION");
+}
@@ -34,6 +34,7 @@
  */
 
 #include <iostream>
+#include <thread>
 #include "gtest/gtest.h"
 
 #include "lattice/lat-hal.h"
@@ -378,3 +379,84 @@ void CRT_CHECK_very_big_ring_precomputed(const std::string& msg) {
 TEST(UTTransform, CRT_CHECK_very_big_ring_precomputed) {
     RUN_BIG_BACKENDS(CRT_CHECK_very_big_ring_precomputed, "CRT_CHECK_very_big_ring_precomputed")
 }
+
+// Every path of the NTT of NativeVector computes the transform of the generic
+// butterflies, bit for bit, up to the largest native moduli
+TEST(UTTransform, NTT_simd_paths_match) {
+    using intnat::NttSimdPath;
+    auto selected         = intnat::GetNttSimdPath();
+    const uint32_t bits[] = {29, 45, 60};
+    const usint orders[]  = {16, 32, 128, 2048, 16384};
+    for (usint m : orders) {
+        for (uint32_t b : bits) {
+            usint n = m / 2;
+            // The largest NTT prime below 2^b
+            auto modulus     = PreviousPrime<NativeInteger>(FirstPrime<NativeInteger>(b, m), m);
+            auto rootOfUnity = RootOfUnity<NativeInteger>(m, modulus);
+            NativeVector input(n, modulus);
+            for (usint i = 0; i < n; ++i)
+                input[i] = NativeInteger((uint64_t(i) * 0x9e3779b97f4a7c15ULL) >> 3).Mod(modulus);
+
+            intnat::SetNttSimdPath(NttSimdPath::OFF);
+            NativeVector expected(input);
+            ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(rootOfUnity, m,
+                                                                                             &expected);
+
+            for (auto path : {NttSimdPath::SCALAR, NttSimdPath::AVX2, NttSimdPath::AVX512}) {
+                if (!intnat::NttSimdSupported(path))
+                    continue;
+                std::string msg = intnat::NttSimdPathName(path) + " n " + std::to_string(n) + " q " +
+                                  modulus.ToString();
+                intnat::SetNttSimdPath(path);
+                NativeVector result(input);
+                ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(rootOfUnity, m,
+                                                                                                 &result);
+                EXPECT_EQ(expected, result) << msg;
+                ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(rootOfUnity, m,
+                                                                                                   &result);
+                EXPECT_EQ(input, result) << msg;
+            }
+        }
+    }
+    intnat::SetNttSimdPath(selected);
+}
+
+// Params of a modulus and ring dimension share one plan, built once even when
+// contexts are set up from several threads
+TEST(UTTransform, NTT_plan_shared_per_modulus) {
+    usint m          = 2048;
+    auto modulus     = FirstPrime<NativeInteger>(50, m);
+    auto rootOfUnity = RootOfUnity<NativeInteger>(m, modulus);
+
+    std::vector<std::shared_ptr<const ILNativeParams::NTTPlan>> plans(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < plans.size(); ++i)
+        threads.emplace_back([&, i] { plans[i] = ILNativeParams(m, modulus, rootOfUnity).GetNTTPlan(); });
+    for (auto& t : threads)
+        t.join();
+    for (const auto& plan : plans)
+        EXPECT_EQ(plans[0], plan);
+    ASSERT_TRUE(plans[0] != nullptr);
+    EXPECT_EQ(plans[0]->GetRingDimension(), m / 2);
+    EXPECT_EQ(plans[0]->GetModulus(), modulus);
+
+    auto half = ILNativeParams(m / 2, modulus, rootOfUnity.ModMul(rootOfUnity, modulus)).GetNTTPlan();
+    EXPECT_NE(plans[0], half);
+    EXPECT_EQ(half->GetRingDimension(), m / 4);
+
+    // The plan transforms like the tables looked up by modulus
+    NativeVector input(m / 2, modulus);
+    for (usint i = 0; i < m / 2; ++i)
+        input[i] = NativeInteger(uint64_t(i) * 104729).Mod(modulus);
+    NativeVector byPlan(input), byRoot(input);
+    ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(*plans[0], &byPlan);
+    ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(rootOfUnity, m, &byRoot);
+    EXPECT_EQ(byRoot, byPlan);
+    ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(*plans[0], &byPlan);
+    EXPECT_EQ(input, byPlan);
+
+    // Forgetting the plans does not invalidate the ones held
+    ChineseRemainderTransformFTT<NativeVector>().Reset();
+    EXPECT_EQ(plans[0]->GetRootOfUnityTable().GetLength(), m / 2);
+    EXPECT_NE(plans[0], ILNativeParams(m, modulus, rootOfUnity).GetNTTPlan());
+}
@@ -117,17 +117,9 @@ int main() {
     // std::cout<<"I am about to do addition"<<std::endl;
     // Homomorphic additions
 
-    // std::vector<std::shared_ptr<PimManager>> pim;
-    // size_t sizev = ciphertext1->GetElements()[0].GetAllElements().size();  // Assuming this gets the intended size
-    // for (size_t i = 0; i < sizev; ++i) {
-    //     pim.push_back(std::make_shared<PimManager>(1));
-    // }
-
-    // ciphertext1->SetPim(pim);
-    // std::cout << "Number of DPUS " << pim->GetNumDpus() << std::endl;
-    // std::cout << "The number of DPUs or towers " << sizev << std::endl;
-    // std::shared_ptr<PimManager> pim = std::make_shared<PimManager>(sizev);
-    // ciphertext1->SetPim(pim);
+    // Keep the first ciphertext resident on the DPUs: the addition runs there
+    // and the result only comes back to the host when it is decrypted
+    ciphertext1->PinToPim();
 
     // auto start               = timeNow();
     auto ciphertextAddResult = cryptoContext->EvalAdd(ciphertext1, ciphertext2);
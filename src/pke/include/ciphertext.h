@@ -48,7 +48,6 @@
 #include <utility>
 #include <vector>
 #include <map>
-#include <pim/PimManager.h>
 
 namespace lbcrypto {
 /**
@@ -469,7 +468,6 @@ public:
         cRes->SetScalingFactor(this->GetScalingFactor());
         cRes->SetScalingFactorInt(this->GetScalingFactorInt());
         cRes->SetSlots(this->GetSlots());
-        cRes->SetPim(this->GetPim());
 
         return cRes;
     }
@@ -586,21 +584,39 @@ public:
         return 1;
     }
 
-    void SetPim(std::shared_ptr<PimManager> newPim) {
-        pim = newPim;
+    /**
+   * Keeps the elements of the ciphertext resident in the MRAM of the DPUs.
+   * EvalAdd, EvalSub, the multiplication by a plaintext and the tower-wise
+   * part of ModReduce then run on the DPUs, and the elements are only copied
+   * back when the host reads them (decryption, serialization or an operation
+   * without a PIM kernel). Ciphertexts derived from a pinned one are pinned.
+   * The elements are held by the same DPU.
+   */
+    void PinToPim() {
+        for (size_t i = 0; i < m_elements.size(); ++i) {
+            if (i == 0)
+                m_elements[0].PinToPim();
+            else
+                m_elements[i].PinToPim(m_elements[0]);
+        }
+    }
+
+    /**
+   * Brings the elements back to the host and releases their MRAM.
+   */
+    void UnpinFromPim() {
+        for (auto& element : m_elements)
+            element.UnpinFromPim();
     }
 
-    std::shared_ptr<PimManager> GetPim() const {
-        // std::cout << "Pim is returned" << std::endl;
-        return pim;
+    bool IsPinned() const {
+        return !m_elements.empty() && m_elements[0].IsPinned();
     }
 
 private:
     // vector of ring elements for this Ciphertext
     std::vector<Element> m_elements;
 
-    std::shared_ptr<PimManager> pim;
-
     // the degree of the scaling factor for the encrypted message.
     uint32_t m_noiseScaleDeg = 1;
 
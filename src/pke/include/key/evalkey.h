@@ -228,6 +228,32 @@ public:
         OPENFHE_THROW(not_implemented_error, "ClearKeys operation is not supported");
     }
 
+    /**
+   * Keeps the key elements resident in the MRAM of the DPUs, the key
+   * switches of pinned ciphertexts then read them there (see PimKeyCache).
+   * Throws exception, to be overridden by derived class.
+   */
+    virtual void PinToPim() {
+        OPENFHE_THROW(not_implemented_error, "PinToPim operation is not supported");
+    }
+
+    /**
+   * Pins the key elements on the DPU holding next, e.g. the first element of
+   * the ciphertext switched with the key.
+   * Throws exception, to be overridden by derived class.
+   */
+    virtual void PinToPim(const Element& next) {
+        OPENFHE_THROW(not_implemented_error, "PinToPim operation is not supported");
+    }
+
+    /**
+   * Releases the MRAM of the key elements.
+   * Throws exception, to be overridden by derived class.
+   */
+    virtual void UnpinFromPim() {
+        OPENFHE_THROW(not_implemented_error, "UnpinFromPim operation is not supported");
+    }
+
     friend bool operator==(const EvalKeyImpl& a, const EvalKeyImpl& b) {
         return a.key_compare(b);
     }
@@ -236,6 +236,27 @@ public:
         m_dcrtKeys.clear();
     }
 
+    // The elements are held by the same DPU, the key switching products
+    // then stay there
+    virtual void PinToPim() {
+        if (m_rKey.empty() || m_rKey[0].empty())
+            return;
+        m_rKey[0][0].PinToPim();
+        PinToPim(m_rKey[0][0]);
+    }
+
+    virtual void PinToPim(const Element& next) {
+        for (auto& elements : m_rKey)
+            for (auto& element : elements)
+                element.PinToPim(next);
+    }
+
+    virtual void UnpinFromPim() {
+        for (auto& elements : m_rKey)
+            for (auto& element : elements)
+                element.UnpinFromPim();
+    }
+
     bool key_compare(const EvalKeyImpl<Element>& other) const {
         const auto& oth = static_cast<const EvalKeyRelinImpl<Element>&>(other);
 
@@ -115,6 +115,17 @@ public:
     std::string SerializedObjectName() const {
         return "AdvancedSHECKKSRNS";
     }
+
+private:
+    /**
+   * Weighted sum of pinned ciphertexts of the same level and depth, before
+   * the rescaling, with a fused multiply-accumulate on the DPUs per tower
+   * (see DCRTPolyImpl::LinearWSumOnPim).
+   *
+   * @return nullptr if the ciphertexts cannot be summed there.
+   */
+    Ciphertext<DCRTPoly> EvalLinearWSumOnPim(const std::vector<Ciphertext<DCRTPoly>>& ciphertexts,
+                                             const std::vector<double>& constants) const;
 };
 
 }  // namespace lbcrypto
@@ -41,6 +41,7 @@
 #include "utils/caller_info.h"
 #include "utils/inttypes.h"
 #include "utils/exception.h"
+#include "pim/PimKeyCache.h"
 
 #include <memory>
 #include <vector>
@@ -849,6 +850,23 @@ protected:
     Ciphertext<Element> EvalMultCore(ConstCiphertext<Element> ciphertext, const Element plaintext) const;
 
     void EvalMultCoreInPlace(Ciphertext<Element>& ciphertext, const Element plaintext) const;
+
+    /**
+   * Keeps an evaluation key resident on the DPUs while a pinned ciphertext is
+   * switched with it, through the key cache of the DPU set (see PimKeyCache):
+   * the key is uploaded on its first use, to the DPU holding the ciphertext,
+   * and read from the MRAM by the later key switches until the cache evicts
+   * it. Keys are indexed by their tag and
+   * index: the automorphism keys by their (odd) automorphism index, the
+   * relinearization key of s^j by 2 (j - 2).
+   *
+   * @param ciphertext the ciphertext switched, nothing is done unless it is pinned.
+   * @param evalKey the key switching key.
+   * @param index the index of the key.
+   * @return the lease keeping the key resident, to be held over the key switch.
+   */
+    PimKeyCache::Lease CacheEvalKeyOnPim(ConstCiphertext<Element> ciphertext, const EvalKey<Element>& evalKey,
+                                         uint32_t index) const;
 };
 
 }  // namespace lbcrypto
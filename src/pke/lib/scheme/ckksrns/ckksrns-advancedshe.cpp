@@ -38,6 +38,7 @@ CKKS implementation. See https://eprint.iacr.org/2020/1118 for details.
 #include "cryptocontext.h"
 #include "scheme/ckksrns/ckksrns-cryptoparameters.h"
 #include "scheme/ckksrns/ckksrns-advancedshe.h"
+#include "scheme/ckksrns/ckksrns-leveledshe.h"
 #include "scheme/ckksrns/ckksrns-utils.h"
 
 #include "schemebase/base-scheme.h"
@@ -94,12 +95,16 @@ Ciphertext<DCRTPoly> AdvancedSHECKKSRNS::EvalLinearWSumMutable(std::vector<Ciphe
         }
     }
 
-    Ciphertext<DCRTPoly> weightedSum = cc->EvalMult(ciphertexts[0], constants[0]);
+    Ciphertext<DCRTPoly> weightedSum = EvalLinearWSumOnPim(ciphertexts, constants);
 
-    Ciphertext<DCRTPoly> tmp;
-    for (uint32_t i = 1; i < ciphertexts.size(); i++) {
-        tmp = cc->EvalMult(ciphertexts[i], constants[i]);
-        cc->EvalAddInPlace(weightedSum, tmp);
+    if (!weightedSum) {
+        weightedSum = cc->EvalMult(ciphertexts[0], constants[0]);
+
+        Ciphertext<DCRTPoly> tmp;
+        for (uint32_t i = 1; i < ciphertexts.size(); i++) {
+            tmp = cc->EvalMult(ciphertexts[i], constants[i]);
+            cc->EvalAddInPlace(weightedSum, tmp);
+        }
     }
 
     cc->ModReduceInPlace(weightedSum);
@@ -107,6 +112,48 @@ Ciphertext<DCRTPoly> AdvancedSHECKKSRNS::EvalLinearWSumMutable(std::vector<Ciphe
     return weightedSum;
 }
 
+Ciphertext<DCRTPoly> AdvancedSHECKKSRNS::EvalLinearWSumOnPim(const std::vector<Ciphertext<DCRTPoly>>& ciphertexts,
+                                                             const std::vector<double>& constants) const {
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(ciphertexts[0]->GetCryptoParameters());
+
+    // The sum of the products is the sum EvalMult and EvalAdd would compute
+    // when no term has to be rescaled first and the additions do not adjust
+    // any level
+    const auto& first = ciphertexts[0];
+    size_t numElements{first->GetElements().size()};
+    if (cryptoParams->GetScalingTechnique() != FIXEDMANUAL && first->GetNoiseScaleDeg() != 1)
+        return nullptr;
+    for (const auto& ct : ciphertexts) {
+        if (!ct->IsPinned() || ct->GetLevel() != first->GetLevel() ||
+            ct->GetNoiseScaleDeg() != first->GetNoiseScaleDeg() || ct->GetElements().size() != numElements ||
+            ct->GetElements()[0].GetNumOfElements() != first->GetElements()[0].GetNumOfElements())
+            return nullptr;
+    }
+
+    // The plaintext moduli of the factors only depend on the parameters,
+    // any instance of the leveled scheme computes them
+    LeveledSHECKKSRNS leveled;
+    std::vector<std::vector<DCRTPoly::Integer>> factors(ciphertexts.size());
+    for (size_t i = 0; i < ciphertexts.size(); i++)
+        factors[i] = leveled.GetElementForEvalMult(ciphertexts[i], constants[i]);
+
+    std::vector<DCRTPoly> sum(numElements);
+    std::vector<const DCRTPoly*> terms(ciphertexts.size());
+    for (size_t j = 0; j < numElements; j++) {
+        for (size_t i = 0; i < ciphertexts.size(); i++)
+            terms[i] = &ciphertexts[i]->GetElements()[j];
+        if (!DCRTPoly::LinearWSumOnPim(terms, factors, sum[j]))
+            return nullptr;
+    }
+
+    Ciphertext<DCRTPoly> weightedSum = first->CloneZero();
+    weightedSum->SetElements(std::move(sum));
+    weightedSum->SetNoiseScaleDeg(first->GetNoiseScaleDeg() + 1);
+    weightedSum->SetScalingFactor(first->GetScalingFactor() *
+                                  cryptoParams->GetScalingFactorReal(first->GetLevel()));
+    return weightedSum;
+}
+
 //------------------------------------------------------------------------------
 // EVAL POLYNOMIAL
 //------------------------------------------------------------------------------
@@ -430,6 +430,7 @@ Ciphertext<DCRTPoly> LeveledSHECKKSRNS::EvalFastRotationExt(ConstCiphertext<DCRT
 
     auto algo = cc->GetScheme();
 
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKey, autoIndex);
     std::shared_ptr<std::vector<DCRTPoly>> cTilda = algo->EvalFastKeySwitchCoreExt(digits, evalKey, paramsQl);
 
     if (addFirst) {
@@ -64,6 +64,8 @@ DecryptResult PKECKKSRNS::Decrypt(ConstCiphertext<DCRTPoly> ciphertext, const Pr
     }
 
     *plaintext = b.GetElementAtIndex(0);
+    // The copy of a pinned tower is pinned, the plaintext is decoded on the host
+    plaintext->UnpinFromPim();
 
     return DecryptResult(plaintext->GetLength());
 }
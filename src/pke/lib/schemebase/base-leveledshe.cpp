@@ -205,7 +205,8 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalMult(ConstCiphertext<Element> c
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = ciphertext->GetCryptoContext()->GetScheme();
+    auto algo  = ciphertext->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -226,7 +227,8 @@ void LeveledSHEBase<Element>::EvalMultInPlace(Ciphertext<Element>& ciphertext1,
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = ciphertext1->GetCryptoContext()->GetScheme();
+    auto algo  = ciphertext1->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(ciphertext1, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -246,7 +248,8 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalMultMutable(Ciphertext<Element>
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = ciphertext->GetCryptoContext()->GetScheme();
+    auto algo  = ciphertext->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -267,7 +270,8 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalSquare(ConstCiphertext<Element>
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = csquare->GetCryptoContext()->GetScheme();
+    auto algo  = csquare->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(csquare, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -287,7 +291,8 @@ void LeveledSHEBase<Element>::EvalSquareInPlace(Ciphertext<Element>& ciphertext,
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = ciphertext->GetCryptoContext()->GetScheme();
+    auto algo  = ciphertext->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -306,7 +311,8 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalSquareMutable(Ciphertext<Elemen
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = csquare->GetCryptoContext()->GetScheme();
+    auto algo  = csquare->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(csquare, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -327,7 +333,8 @@ void LeveledSHEBase<Element>::EvalMultMutableInPlace(Ciphertext<Element>& cipher
     for (auto& c : cv)
         c.SetFormat(Format::EVALUATION);
 
-    auto algo = ciphertext1->GetCryptoContext()->GetScheme();
+    auto algo  = ciphertext1->GetCryptoContext()->GetScheme();
+    auto lease = CacheEvalKeyOnPim(ciphertext1, evalKey, 0);
 
     std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[2], evalKey);
 
@@ -364,6 +371,7 @@ void LeveledSHEBase<Element>::RelinearizeInPlace(Ciphertext<Element>& ciphertext
     auto algo = ciphertext->GetCryptoContext()->GetScheme();
 
     for (size_t j = 2; j < cv.size(); j++) {
+        auto lease = CacheEvalKeyOnPim(ciphertext, evalKeyVec[j - 2], 2 * (j - 2));
         std::shared_ptr<std::vector<Element>> ab = algo->KeySwitchCore(cv[j], evalKeyVec[j - 2]);
         cv[0] += (*ab)[0];
         cv[1] += (*ab)[1];
@@ -449,6 +457,7 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalAutomorphism(ConstCiphertext<El
 
     Ciphertext<Element> result = ciphertext->Clone();
 
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKeyIterator->second, i);
     algo->KeySwitchInPlace(result, evalKeyIterator->second);
 
     std::vector<Element>& rcv = result->GetElements();
@@ -492,6 +501,7 @@ Ciphertext<Element> LeveledSHEBase<Element>::EvalFastRotation(
     auto algo                       = cc->GetScheme();
     const std::vector<DCRTPoly>& cv = ciphertext->GetElements();
 
+    auto lease = CacheEvalKeyOnPim(ciphertext, evalKey, autoIndex);
     std::shared_ptr<std::vector<Element>> ba = algo->EvalFastKeySwitchCore(digits, evalKey, cv[0].GetParams());
 
     const auto cryptoParams = ciphertext->GetCryptoParameters();
@@ -608,10 +618,6 @@ void LeveledSHEBase<Element>::EvalAddCoreInPlace(Ciphertext<Element>& ciphertext
     size_t cSmallSize = std::min(c1Size, c2Size);
 
     for (size_t i = 0; i < cSmallSize; i++) {
-        if (ciphertext1->GetPim() != nullptr) {
-            // std::cout << "Pim is available" << std::endl;
-            cv1[i].SetPim(ciphertext1->GetPim());
-        }
         cv1[i] += cv2[i];
     }
 
@@ -795,6 +801,24 @@ void LeveledSHEBase<Element>::EvalMultCoreInPlace(Ciphertext<Element>& ciphertex
 // the code below is from base-leveledshe-impl.cpp
 namespace lbcrypto {
 
+template <class Element>
+PimKeyCache::Lease LeveledSHEBase<Element>::CacheEvalKeyOnPim(ConstCiphertext<Element> ciphertext,
+                                                              const EvalKey<Element>& evalKey, uint32_t index) const {
+    if (!ciphertext->IsPinned())
+        return PimKeyCache::Lease();
+    size_t bytes = 0;
+    for (const auto* elements : {&evalKey->GetAVector(), &evalKey->GetBVector()}) {
+        for (const auto& element : *elements)
+            bytes += element.GetNumOfElements() * element.GetRingDimension() * sizeof(uint64_t);
+    }
+    std::weak_ptr<EvalKeyImpl<Element>> owner = evalKey;
+    return PimManager::current()->key_cache().acquire(
+        evalKey, evalKey->GetKeyTag(), index, bytes, [&] { evalKey->PinToPim(ciphertext->GetElements()[0]); }, [owner] {
+            if (auto key = owner.lock())
+                key->UnpinFromPim();
+        });
+}
+
 // template class LeveledSHEBase<Poly>;
 // template class LeveledSHEBase<NativePoly>;
 template class LeveledSHEBase<DCRTPoly>;
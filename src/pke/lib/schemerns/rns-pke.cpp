@@ -104,6 +104,8 @@ DecryptResult PKERNS::Decrypt(ConstCiphertext<DCRTPoly> ciphertext, const Privat
     }
 
     *plaintext = b.GetElementAtIndex(0);
+    // The copy of a pinned tower is pinned, the plaintext is decoded on the host
+    plaintext->UnpinFromPim();
 
     return DecryptResult(plaintext->GetLength());
 }